@@ -53,6 +53,17 @@ static struct apartment *mta;
 static struct apartment *main_sta; /* the first STA */
 static struct list apts = LIST_INIT(apts);
 
+static int apartment_compare_oxid(const void *key, const struct rb_entry *entry)
+{
+    const struct apartment *apt = RB_ENTRY_VALUE(entry, const struct apartment, oxid_entry);
+    OXID oxid = *(const OXID *)key;
+
+    if (oxid < apt->oxid) return -1;
+    return oxid > apt->oxid;
+}
+
+static struct rb_tree apts_by_oxid = { apartment_compare_oxid };
+
 static CRITICAL_SECTION apt_cs;
 static CRITICAL_SECTION_DEBUG apt_cs_debug =
 {
@@ -372,6 +383,7 @@ static struct apartment *apartment_construct(DWORD model)
 
     list_init(&apt->proxies);
     list_init(&apt->stubmgrs);
+    apartment_init_stubmgr_indexes(apt);
     list_init(&apt->loaded_dlls);
     list_init(&apt->usage_cookies);
     apt->ipidc = 0;
@@ -397,6 +409,8 @@ static struct apartment *apartment_construct(DWORD model)
     TRACE("Created apartment on OXID %s\n", wine_dbgstr_longlong(apt->oxid));
 
     list_add_head(&apts, &apt->entry);
+    if (rb_put(&apts_by_oxid, &apt->oxid, &apt->oxid_entry))
+        WARN("OXID %s is already in use\n", wine_dbgstr_longlong(apt->oxid));
 
     return apt;
 }
@@ -465,6 +479,8 @@ void apartment_release(struct apartment *apt)
         if (apt == mta) mta = NULL;
         else if (apt == main_sta) main_sta = NULL;
         list_remove(&apt->entry);
+        if (rb_get(&apts_by_oxid, &apt->oxid) == &apt->oxid_entry)
+            rb_remove(&apts_by_oxid, &apt->oxid_entry);
     }
 
     LeaveCriticalSection(&apt_cs);
@@ -636,17 +652,14 @@ struct apartment * apartment_get_current_or_mta(void)
 /* The given OXID must be local to this process */
 struct apartment * apartment_findfromoxid(OXID oxid)
 {
-    struct apartment *result = NULL, *apt;
+    struct apartment *result = NULL;
+    struct rb_entry *entry;
 
     EnterCriticalSection(&apt_cs);
-    LIST_FOR_EACH_ENTRY(apt, &apts, struct apartment, entry)
+    if ((entry = rb_get(&apts_by_oxid, &oxid)))
     {
-        if (apt->oxid == oxid)
-        {
-            result = apt;
-            apartment_addref(result);
-            break;
-        }
+        result = RB_ENTRY_VALUE(entry, struct apartment, oxid_entry);
+        apartment_addref(result);
     }
     LeaveCriticalSection(&apt_cs);
 
@@ -658,16 +671,19 @@ struct apartment * apartment_findfromoxid(OXID oxid)
  * is no longer required. */
 struct apartment * apartment_findfromtid(DWORD tid)
 {
+    OXID oxid = ((OXID)GetCurrentProcessId() << 32) | tid;
     struct apartment *result = NULL, *apt;
+    struct rb_entry *entry;
 
     EnterCriticalSection(&apt_cs);
-    LIST_FOR_EACH_ENTRY(apt, &apts, struct apartment, entry)
+    /* the OXID of a single-threaded apartment is made of its thread ID */
+    if ((entry = rb_get(&apts_by_oxid, &oxid)))
     {
+        apt = RB_ENTRY_VALUE(entry, struct apartment, oxid_entry);
         if (apt != mta && apt->tid == tid)
         {
             result = apt;
             apartment_addref(result);
-            break;
         }
     }
 
@@ -717,13 +733,12 @@ static BOOL get_object_dll_path(const struct class_reg_data *regdata, WCHAR *dst
 
     if (regdata->origin == CLASS_REG_REGISTRY)
     {
-        DWORD keytype;
         WCHAR src[MAX_PATH];
-        DWORD dwLength = dstlen * sizeof(WCHAR);
 
-        if ((ret = RegQueryValueExW(regdata->u.hkey, NULL, NULL, &keytype, (BYTE*)src, &dwLength)) == ERROR_SUCCESS)
+        if ((ret = regdata->u.registry.path_status) == ERROR_SUCCESS)
         {
-            if (keytype == REG_EXPAND_SZ)
+            memcpy(src, regdata->u.registry.path, sizeof(src));
+            if (regdata->u.registry.path_type == REG_EXPAND_SZ)
             {
                 if (dstlen <= ExpandEnvironmentStringsW(src, dst, dstlen)) ret = ERROR_MORE_DATA;
             }
@@ -1009,14 +1024,7 @@ static enum comclass_threadingmodel get_threading_model(const struct class_reg_d
 {
     if (data->origin == CLASS_REG_REGISTRY)
     {
-        WCHAR threading_model[10 /* lstrlenW(L"apartment")+1 */];
-        DWORD dwLength = sizeof(threading_model);
-        DWORD keytype;
-        DWORD ret;
-
-        ret = RegQueryValueExW(data->u.hkey, L"ThreadingModel", NULL, &keytype, (BYTE*)threading_model, &dwLength);
-        if ((ret != ERROR_SUCCESS) || (keytype != REG_SZ))
-            threading_model[0] = '\0';
+        const WCHAR *threading_model = data->u.registry.threading_model;
 
         if (!wcsicmp(threading_model, L"Apartment")) return ThreadingModel_Apartment;
         if (!wcsicmp(threading_model, L"Free")) return ThreadingModel_Free;
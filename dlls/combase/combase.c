@@ -32,6 +32,7 @@
 #include "combase_private.h"
 
 #include "wine/debug.h"
+#include "wine/rbtree.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(ole);
 
@@ -335,6 +336,174 @@ HRESULT open_key_for_clsid(REFCLSID clsid, const WCHAR *keyname, REGSAM access,
     return S_OK;
 }
 
+/* Cache of the in-process server registrations read from HKCR\\CLSID. Every
+ * change under that key signals class_reg_event, which flushes the cache on
+ * the next lookup. */
+struct class_reg_entry
+{
+    struct rb_entry entry;
+    CLSID clsid;
+    const WCHAR *keyname;
+    HRESULT hr;
+    struct class_reg_data data;
+};
+
+struct class_reg_key
+{
+    const CLSID *clsid;
+    const WCHAR *keyname;
+};
+
+static int class_reg_compare(const void *key, const struct rb_entry *entry)
+{
+    const struct class_reg_entry *reg = RB_ENTRY_VALUE(entry, const struct class_reg_entry, entry);
+    const struct class_reg_key *k = key;
+    int ret;
+
+    if ((ret = memcmp(k->clsid, &reg->clsid, sizeof(CLSID)))) return ret;
+    return wcscmp(k->keyname, reg->keyname);
+}
+
+static struct rb_tree class_reg_cache = { class_reg_compare };
+static unsigned int class_reg_count;
+static HKEY class_reg_hkey;
+static HANDLE class_reg_event;
+static BOOL class_reg_disabled;
+
+#define CLASS_REG_CACHE_MAX 1024
+
+static CRITICAL_SECTION class_reg_cs;
+static CRITICAL_SECTION_DEBUG class_reg_cs_debug =
+{
+    0, 0, &class_reg_cs,
+    { &class_reg_cs_debug.ProcessLocksList, &class_reg_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": class_reg_cs") }
+};
+static CRITICAL_SECTION class_reg_cs = { &class_reg_cs_debug, -1, 0, 0, 0, 0 };
+
+static void class_reg_free_entry(struct rb_entry *entry, void *context)
+{
+    free(RB_ENTRY_VALUE(entry, struct class_reg_entry, entry));
+}
+
+static void class_reg_flush(void)
+{
+    rb_destroy(&class_reg_cache, class_reg_free_entry, NULL);
+    class_reg_count = 0;
+}
+
+static BOOL class_reg_watch(void)
+{
+    return !RegNotifyChangeKeyValue(class_reg_hkey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET |
+            REG_NOTIFY_THREAD_AGNOSTIC, class_reg_event, TRUE);
+}
+
+/* flushes the cache if the registry changed, must be called inside class_reg_cs */
+static BOOL class_reg_cache_valid(void)
+{
+    if (class_reg_disabled) return FALSE;
+
+    if (!class_reg_event)
+    {
+        if (open_classes_key(HKEY_CLASSES_ROOT, L"CLSID", KEY_NOTIFY, &class_reg_hkey) ||
+                !(class_reg_event = CreateEventW(NULL, FALSE, FALSE, NULL)) || !class_reg_watch())
+        {
+            WARN("can't watch the CLSID key, class registrations are not cached\n");
+            class_reg_disabled = TRUE;
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    if (WaitForSingleObject(class_reg_event, 0) == WAIT_OBJECT_0)
+    {
+        TRACE("CLSID key changed, flushing %u entries\n", class_reg_count);
+        class_reg_flush();
+        if (!class_reg_watch())
+        {
+            class_reg_disabled = TRUE;
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static void class_reg_cache_cleanup(void)
+{
+    class_reg_flush();
+    if (class_reg_event) CloseHandle(class_reg_event);
+    if (class_reg_hkey) RegCloseKey(class_reg_hkey);
+    DeleteCriticalSection(&class_reg_cs);
+}
+
+static HRESULT read_class_reg_data(REFCLSID clsid, const WCHAR *keyname, struct class_reg_data *regdata)
+{
+    DWORD size, type;
+    HKEY hkey;
+    HRESULT hr;
+
+    memset(regdata, 0, sizeof(*regdata));
+    regdata->origin = CLASS_REG_REGISTRY;
+
+    if (FAILED(hr = open_key_for_clsid(clsid, keyname, KEY_READ, &hkey)))
+        return hr;
+
+    size = sizeof(regdata->u.registry.path) - sizeof(WCHAR);
+    regdata->u.registry.path_status = RegQueryValueExW(hkey, NULL, NULL, &regdata->u.registry.path_type,
+            (BYTE *)regdata->u.registry.path, &size);
+    if (!regdata->u.registry.path_status)
+        regdata->u.registry.path[size / sizeof(WCHAR)] = 0;
+
+    size = sizeof(regdata->u.registry.threading_model);
+    if (RegQueryValueExW(hkey, L"ThreadingModel", NULL, &type, (BYTE *)regdata->u.registry.threading_model, &size)
+            || type != REG_SZ)
+        regdata->u.registry.threading_model[0] = 0;
+
+    RegCloseKey(hkey);
+    return S_OK;
+}
+
+/* reads the InprocServer32 or InprocHandler32 registration of a class */
+static HRESULT get_class_reg_data(REFCLSID clsid, const WCHAR *keyname, struct class_reg_data *regdata)
+{
+    struct class_reg_key key = { clsid, keyname };
+    struct class_reg_entry *reg;
+    struct rb_entry *entry;
+    HRESULT hr;
+
+    EnterCriticalSection(&class_reg_cs);
+
+    if (!class_reg_cache_valid())
+    {
+        LeaveCriticalSection(&class_reg_cs);
+        return read_class_reg_data(clsid, keyname, regdata);
+    }
+
+    if ((entry = rb_get(&class_reg_cache, &key)))
+    {
+        reg = RB_ENTRY_VALUE(entry, struct class_reg_entry, entry);
+        *regdata = reg->data;
+        hr = reg->hr;
+        LeaveCriticalSection(&class_reg_cs);
+        return hr;
+    }
+
+    hr = read_class_reg_data(clsid, keyname, regdata);
+    if ((hr == S_OK || hr == REGDB_E_CLASSNOTREG || hr == REGDB_E_KEYMISSING) && (reg = malloc(sizeof(*reg))))
+    {
+        if (class_reg_count >= CLASS_REG_CACHE_MAX) class_reg_flush();
+        reg->clsid = *clsid;
+        reg->keyname = keyname;
+        reg->hr = hr;
+        reg->data = *regdata;
+        rb_put(&class_reg_cache, &key, &reg->entry);
+        class_reg_count++;
+    }
+
+    LeaveCriticalSection(&class_reg_cs);
+    return hr;
+}
+
 /* open HKCR\\AppId\\{string form of appid clsid} key */
 HRESULT open_appidkey_from_clsid(REFCLSID clsid, REGSAM access, HKEY *subkey)
 {
@@ -1770,9 +1939,7 @@ static HRESULT com_get_class_object(REFCLSID rclsid, DWORD clscontext,
     /* First try in-process server */
     if (clscontext & CLSCTX_INPROC_SERVER)
     {
-        HKEY hkey;
-
-        hr = open_key_for_clsid(rclsid, L"InprocServer32", KEY_READ, &hkey);
+        hr = get_class_reg_data(rclsid, L"InprocServer32", &clsreg);
         if (FAILED(hr))
         {
             if (hr == REGDB_E_CLASSNOTREG)
@@ -1785,13 +1952,7 @@ static HRESULT com_get_class_object(REFCLSID rclsid, DWORD clscontext,
         }
 
         if (SUCCEEDED(hr))
-        {
-            clsreg.u.hkey = hkey;
-            clsreg.origin = CLASS_REG_REGISTRY;
-
             hr = apartment_get_inproc_class_object(apt, &clsreg, rclsid, riid, clscontext, obj);
-            RegCloseKey(hkey);
-        }
 
         /* return if we got a class, otherwise fall through to one of the
          * other types */
@@ -1805,9 +1966,7 @@ static HRESULT com_get_class_object(REFCLSID rclsid, DWORD clscontext,
     /* Next try in-process handler */
     if (clscontext & CLSCTX_INPROC_HANDLER)
     {
-        HKEY hkey;
-
-        hr = open_key_for_clsid(rclsid, L"InprocHandler32", KEY_READ, &hkey);
+        hr = get_class_reg_data(rclsid, L"InprocHandler32", &clsreg);
         if (FAILED(hr))
         {
             if (hr == REGDB_E_CLASSNOTREG)
@@ -1820,13 +1979,7 @@ static HRESULT com_get_class_object(REFCLSID rclsid, DWORD clscontext,
         }
 
         if (SUCCEEDED(hr))
-        {
-            clsreg.u.hkey = hkey;
-            clsreg.origin = CLASS_REG_REGISTRY;
-
             hr = apartment_get_inproc_class_object(apt, &clsreg, rclsid, riid, clscontext, obj);
-            RegCloseKey(hkey);
-        }
 
         /* return if we got a class, otherwise fall through to one of the
          * other types */
@@ -3375,6 +3528,7 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD reason, LPVOID reserved)
         com_revoke_local_servers();
         if (reserved) break;
         apartment_global_cleanup();
+        class_reg_cache_cleanup();
         DeleteCriticalSection(&registered_classes_cs);
         rpc_unregister_channel_hooks();
         break;
@@ -18,12 +18,14 @@
 #include "wine/orpc.h"
 
 #include "wine/list.h"
+#include "wine/rbtree.h"
 
 extern HINSTANCE hProxyDll;
 
 struct apartment
 {
     struct list entry;
+    struct rb_entry oxid_entry; /* entry in the global apartment index keyed by OXID (LOCK) */
 
     LONG  refs;              /* refcount of the apartment (LOCK) */
     BOOL multi_threaded;     /* multi-threaded or single-threaded apartment? (RO) */
@@ -33,6 +35,9 @@ struct apartment
     CRITICAL_SECTION cs;     /* thread safety */
     struct list proxies;     /* imported objects (CS cs) */
     struct list stubmgrs;    /* stub managers for exported objects (CS cs) */
+    struct rb_tree stubmgrs_by_oid;    /* stub managers keyed by OID (CS cs) */
+    struct rb_tree stubmgrs_by_object; /* stub managers keyed by IUnknown pointer (CS cs) */
+    struct rb_tree ifstubs;  /* interface stubs of exported objects keyed by IPID (CS cs) */
     BOOL remunk_exported;    /* has the IRemUnknown interface for this apartment been created yet? (CS cs) */
     LONG remoting_started;   /* has the RPC system been started for this apartment? (LOCK) */
     struct list loaded_dlls; /* list of dlls loaded by this apartment (CS cs) */
@@ -151,7 +156,13 @@ struct class_reg_data
             DWORD threading_model;
             HANDLE hactctx;
         } actctx;
-        HKEY hkey;
+        struct
+        {
+            LSTATUS path_status;        /* result of reading the default value */
+            DWORD path_type;
+            WCHAR path[MAX_PATH];
+            WCHAR threading_model[10];  /* empty if missing or not REG_SZ */
+        } registry;
     } u;
 };
 
@@ -205,6 +216,8 @@ typedef enum ifstub_state
 struct ifstub
 {
     struct list       entry;      /* entry in stub_manager->ifstubs list (CS stub_manager->lock) */
+    struct rb_entry   ipid_entry; /* entry in apartment->ifstubs index (CS apt->cs) */
+    struct stub_manager *manager; /* owning stub manager (RO) */
     IRpcStubBuffer   *stubbuffer; /* RO */
     IID               iid;        /* RO */
     IPID              ipid;       /* RO */
@@ -217,6 +230,8 @@ struct ifstub
 struct stub_manager
 {
     struct list       entry;      /* entry in apartment stubmgr list (CS apt->cs) */
+    struct rb_entry   oid_entry;  /* entry in apartment stubmgrs_by_oid index (CS apt->cs) */
+    struct rb_entry   object_entry; /* entry in apartment stubmgrs_by_object index (CS apt->cs) */
     struct list       ifstubs;    /* list of active ifstubs for the object (CS lock) */
     CRITICAL_SECTION  lock;
     struct apartment *apt;        /* owning apt (RO) */
@@ -247,6 +262,7 @@ void stub_manager_disconnect(struct stub_manager *m) DECLSPEC_HIDDEN;
 ULONG stub_manager_ext_addref(struct stub_manager *m, ULONG refs, BOOL tableweak) DECLSPEC_HIDDEN;
 ULONG stub_manager_ext_release(struct stub_manager *m, ULONG refs, BOOL tableweak, BOOL last_unlock_releases) DECLSPEC_HIDDEN;
 struct stub_manager * get_stub_manager(struct apartment *apt, OID oid) DECLSPEC_HIDDEN;
+void apartment_init_stubmgr_indexes(struct apartment *apt) DECLSPEC_HIDDEN;
 void stub_manager_release_marshal_data(struct stub_manager *m, ULONG refs, const IPID *ipid, BOOL tableweak) DECLSPEC_HIDDEN;
 BOOL stub_manager_is_table_marshaled(struct stub_manager *m, const IPID *ipid) DECLSPEC_HIDDEN;
 BOOL stub_manager_notify_unmarshal(struct stub_manager *m, const IPID *ipid) DECLSPEC_HIDDEN;
@@ -67,6 +67,38 @@ static inline HRESULT generate_ipid(struct stub_manager *m, IPID *ipid)
     return S_OK;
 }
 
+static int stub_manager_compare_oid(const void *key, const struct rb_entry *entry)
+{
+    const struct stub_manager *m = RB_ENTRY_VALUE(entry, const struct stub_manager, oid_entry);
+    OID oid = *(const OID *)key;
+
+    if (oid < m->oid) return -1;
+    return oid > m->oid;
+}
+
+static int stub_manager_compare_object(const void *key, const struct rb_entry *entry)
+{
+    const struct stub_manager *m = RB_ENTRY_VALUE(entry, const struct stub_manager, object_entry);
+    ULONG_PTR object = (ULONG_PTR)key;
+
+    if (object < (ULONG_PTR)m->object) return -1;
+    return object > (ULONG_PTR)m->object;
+}
+
+static int ifstub_compare_ipid(const void *key, const struct rb_entry *entry)
+{
+    const struct ifstub *ifstub = RB_ENTRY_VALUE(entry, const struct ifstub, ipid_entry);
+    return memcmp(key, &ifstub->ipid, sizeof(IPID));
+}
+
+/* sets up the lookup indexes of the exported objects of an apartment */
+void apartment_init_stubmgr_indexes(struct apartment *apt)
+{
+    rb_init(&apt->stubmgrs_by_oid, stub_manager_compare_oid);
+    rb_init(&apt->stubmgrs_by_object, stub_manager_compare_object);
+    rb_init(&apt->ifstubs, ifstub_compare_ipid);
+}
+
 /* registers a new interface stub COM object with the stub manager and returns registration record */
 struct ifstub * stub_manager_new_ifstub(struct stub_manager *m, IRpcStubBuffer *sb, REFIID iid, DWORD dest_context,
     void *dest_context_data, MSHLFLAGS flags)
@@ -98,6 +130,7 @@ struct ifstub * stub_manager_new_ifstub(struct stub_manager *m, IRpcStubBuffer *
     stub->stubbuffer = sb;
     if (sb) IRpcStubBuffer_AddRef(sb);
 
+    stub->manager = m;
     stub->flags = flags;
     stub->iid = *iid;
 
@@ -108,17 +141,39 @@ struct ifstub * stub_manager_new_ifstub(struct stub_manager *m, IRpcStubBuffer *
     else
         generate_ipid(m, &stub->ipid);
 
+    EnterCriticalSection(&m->apt->cs);
     EnterCriticalSection(&m->lock);
     list_add_head(&m->ifstubs, &stub->entry);
+    if (rb_put(&m->apt->ifstubs, &stub->ipid, &stub->ipid_entry))
+        WARN("ipid %s is already exported in this apartment\n", debugstr_guid(&stub->ipid));
     /* every normal marshal is counted so we don't allow more than we should */
     if (flags & MSHLFLAGS_NORMAL) m->norm_refs++;
     LeaveCriticalSection(&m->lock);
+    LeaveCriticalSection(&m->apt->cs);
 
     TRACE("ifstub %p created with ipid %s\n", stub, debugstr_guid(&stub->ipid));
 
     return stub;
 }
 
+/* removes the ifstubs of a stub manager from the apartment index, must be called inside apt->cs */
+static void stub_manager_unindex(struct stub_manager *m)
+{
+    struct apartment *apt = m->apt;
+    struct ifstub *ifstub;
+
+    rb_remove(&apt->stubmgrs_by_oid, &m->oid_entry);
+    rb_remove(&apt->stubmgrs_by_object, &m->object_entry);
+
+    EnterCriticalSection(&m->lock);
+    LIST_FOR_EACH_ENTRY(ifstub, &m->ifstubs, struct ifstub, entry)
+    {
+        if (rb_get(&apt->ifstubs, &ifstub->ipid) == &ifstub->ipid_entry)
+            rb_remove(&apt->ifstubs, &ifstub->ipid_entry);
+    }
+    LeaveCriticalSection(&m->lock);
+}
+
 static void stub_manager_delete_ifstub(struct stub_manager *m, struct ifstub *ifstub)
 {
     TRACE("m=%p, m->oid=%s, ipid=%s\n", m, wine_dbgstr_longlong(m->oid), debugstr_guid(&ifstub->ipid));
@@ -172,12 +227,15 @@ struct ifstub * stub_manager_find_ifstub(struct stub_manager *m, REFIID iid, MSH
     return result;
 }
 
+static void stub_manager_delete(struct stub_manager *m);
+
 /* creates a new stub manager and adds it into the apartment. caller must
  * release stub manager when it is no longer required. the apartment and
  * external refs together take one implicit ref */
 static struct stub_manager *new_stub_manager(struct apartment *apt, IUnknown *object)
 {
-    struct stub_manager *sm;
+    struct stub_manager *sm, *existing = NULL;
+    struct rb_entry *entry;
     HRESULT hres;
 
     assert(apt);
@@ -230,10 +288,29 @@ static struct stub_manager *new_stub_manager(struct apartment *apt, IUnknown *ob
         sm->extern_conn = NULL;
 
     EnterCriticalSection(&apt->cs);
-    sm->oid = apt->oidc++;
-    list_add_head(&apt->stubmgrs, &sm->entry);
+    /* another thread may have raced us to create a stub manager for the
+     * same object, in which case we use that one instead */
+    if ((entry = rb_get(&apt->stubmgrs_by_object, object)))
+    {
+        existing = RB_ENTRY_VALUE(entry, struct stub_manager, object_entry);
+        existing->refs++;
+    }
+    else
+    {
+        sm->oid = apt->oidc++;
+        list_add_head(&apt->stubmgrs, &sm->entry);
+        rb_put(&apt->stubmgrs_by_oid, &sm->oid, &sm->oid_entry);
+        rb_put(&apt->stubmgrs_by_object, object, &sm->object_entry);
+    }
     LeaveCriticalSection(&apt->cs);
 
+    if (existing)
+    {
+        TRACE("lost race, using existing stub manager %p for object with IUnknown %p\n", existing, object);
+        stub_manager_delete(sm);
+        return existing;
+    }
+
     TRACE("Created new stub manager (oid=%s) at %p for object with IUnknown %p\n", wine_dbgstr_longlong(sm->oid), sm, object);
     
     return sm;
@@ -318,7 +395,10 @@ ULONG stub_manager_int_release(struct stub_manager *m)
 
     /* remove from apartment so no other thread can access it... */
     if (!refs)
+    {
         list_remove(&m->entry);
+        stub_manager_unindex(m);
+    }
 
     LeaveCriticalSection(&apt->cs);
 
@@ -334,7 +414,8 @@ ULONG stub_manager_int_release(struct stub_manager *m)
  * it must also call release on the stub manager when it is no longer needed */
 struct stub_manager * get_stub_manager_from_object(struct apartment *apt, IUnknown *obj, BOOL alloc)
 {
-    struct stub_manager *result = NULL, *m;
+    struct stub_manager *result = NULL;
+    struct rb_entry *entry;
     IUnknown *object;
     HRESULT hres;
 
@@ -346,14 +427,10 @@ struct stub_manager * get_stub_manager_from_object(struct apartment *apt, IUnkno
     }
 
     EnterCriticalSection(&apt->cs);
-    LIST_FOR_EACH_ENTRY(m, &apt->stubmgrs, struct stub_manager, entry)
+    if ((entry = rb_get(&apt->stubmgrs_by_object, object)))
     {
-        if (m->object == object)
-        {
-            result = m;
-            stub_manager_int_addref(result);
-            break;
-        }
+        result = RB_ENTRY_VALUE(entry, struct stub_manager, object_entry);
+        stub_manager_int_addref(result);
     }
     LeaveCriticalSection(&apt->cs);
 
@@ -380,17 +457,14 @@ struct stub_manager * get_stub_manager_from_object(struct apartment *apt, IUnkno
  * it must also call release on the stub manager when it is no longer needed */
 struct stub_manager * get_stub_manager(struct apartment *apt, OID oid)
 {
-    struct stub_manager *result = NULL, *m;
+    struct stub_manager *result = NULL;
+    struct rb_entry *entry;
 
     EnterCriticalSection(&apt->cs);
-    LIST_FOR_EACH_ENTRY(m, &apt->stubmgrs, struct stub_manager, entry)
+    if ((entry = rb_get(&apt->stubmgrs_by_oid, &oid)))
     {
-        if (m->oid == oid)
-        {
-            result = m;
-            stub_manager_int_addref(result);
-            break;
-        }
+        result = RB_ENTRY_VALUE(entry, struct stub_manager, oid_entry);
+        stub_manager_int_addref(result);
     }
     LeaveCriticalSection(&apt->cs);
 
@@ -471,17 +545,16 @@ ULONG stub_manager_ext_release(struct stub_manager *m, ULONG refs, BOOL tablewea
  * it must also call release on the stub manager when it is no longer needed */
 static struct stub_manager *get_stub_manager_from_ipid(struct apartment *apt, const IPID *ipid, struct ifstub **ifstub)
 {
-    struct stub_manager *result = NULL, *m;
+    struct stub_manager *result = NULL;
+    struct rb_entry *entry;
 
+    *ifstub = NULL;
     EnterCriticalSection(&apt->cs);
-    LIST_FOR_EACH_ENTRY(m, &apt->stubmgrs, struct stub_manager, entry)
+    if ((entry = rb_get(&apt->ifstubs, ipid)))
     {
-        if ((*ifstub = stub_manager_ipid_to_ifstub(m, ipid)))
-        {
-            result = m;
-            stub_manager_int_addref(result);
-            break;
-        }
+        *ifstub = RB_ENTRY_VALUE(entry, struct ifstub, ipid_entry);
+        result = (*ifstub)->manager;
+        stub_manager_int_addref(result);
     }
     LeaveCriticalSection(&apt->cs);
 
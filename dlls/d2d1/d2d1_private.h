@@ -479,6 +479,39 @@ struct d2d_curve_outline_vertex
     D2D1_POINT_2F prev, next;
 };
 
+enum d2d_geometry_buffer
+{
+    D2D_GEOMETRY_BUFFER_FILL_FACES,
+    D2D_GEOMETRY_BUFFER_FILL_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS,
+    D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_ARCS,
+    D2D_GEOMETRY_BUFFER_COUNT,
+};
+
+/* Device buffers created from the tessellation of a geometry, for one
+ * Direct3D device. The device is only used as a key; the buffers themselves
+ * keep it alive. */
+struct d2d_geometry_buffers
+{
+    struct list entry;
+    ID3D11Device1 *device;
+    ID3D11Buffer *buffers[D2D_GEOMETRY_BUFFER_COUNT];
+};
+
+struct d2d_geometry_buffer_cache
+{
+    struct list entry;
+    SRWLOCK lock;
+    struct list buffers;
+    size_t count;
+};
+
 struct d2d_geometry
 {
     ID2D1Geometry ID2D1Geometry_iface;
@@ -488,6 +521,8 @@ struct d2d_geometry
 
     D2D_MATRIX_3X2_F transform;
 
+    struct d2d_geometry_buffer_cache *buffer_cache;
+
     struct
     {
         D2D1_POINT_2F *vertices;
@@ -587,6 +622,9 @@ void d2d_transformed_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *
 HRESULT d2d_geometry_group_init(struct d2d_geometry *geometry, ID2D1Factory *factory,
         D2D1_FILL_MODE fill_mode, ID2D1Geometry **src_geometries, unsigned int geometry_count) DECLSPEC_HIDDEN;
 struct d2d_geometry *unsafe_impl_from_ID2D1Geometry(ID2D1Geometry *iface) DECLSPEC_HIDDEN;
+void d2d_geometry_release_device_buffers(ID3D11Device1 *device) DECLSPEC_HIDDEN;
+ID3D11Buffer *d2d_geometry_get_buffer(const struct d2d_geometry *geometry, ID3D11Device1 *device,
+        enum d2d_geometry_buffer idx) DECLSPEC_HIDDEN;
 
 struct d2d_device
 {
@@ -291,6 +291,10 @@ static ULONG STDMETHODCALLTYPE d2d_device_context_inner_Release(IUnknown *iface)
             ID3DDeviceContextState_Release(context->d3d_state);
         if (context->target.object)
             IUnknown_Release(context->target.object);
+        /* Geometry buffers would otherwise keep the device alive for as long
+         * as the geometries exist. Other contexts on the same device simply
+         * recreate them. */
+        d2d_geometry_release_device_buffers(context->d3d_device);
         ID3D11Device1_Release(context->d3d_device);
         ID2D1Factory_Release(context->factory);
         ID2D1Device_Release(context->device);
@@ -820,8 +824,6 @@ static HRESULT d2d_device_context_update_vs_cb(struct d2d_device_context *contex
 static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
         const struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
 {
-    D3D11_SUBRESOURCE_DATA buffer_data;
-    D3D11_BUFFER_DESC buffer_desc;
     ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
@@ -837,32 +839,17 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
         return;
     }
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
     if (geometry->outline.face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.face_count * sizeof(*geometry->outline.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (!(ib = d2d_geometry_get_buffer(geometry, render_target->d3d_device, D2D_GEOMETRY_BUFFER_OUTLINE_FACES)))
         {
-            WARN("Failed to create index buffer, hr %#lx.\n", hr);
+            WARN("Failed to get index buffer.\n");
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (!(vb = d2d_geometry_get_buffer(geometry, render_target->d3d_device, D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES)))
         {
-            ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
+            ERR("Failed to get vertex buffer.\n");
             ID3D11Buffer_Release(ib);
             return;
         }
@@ -876,23 +863,16 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 
     if (geometry->outline.bezier_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.bezier_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (!(ib = d2d_geometry_get_buffer(geometry, render_target->d3d_device,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES)))
         {
-            WARN("Failed to create curves index buffer, hr %#lx.\n", hr);
+            WARN("Failed to get curves index buffer.\n");
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.beziers;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (!(vb = d2d_geometry_get_buffer(geometry, render_target->d3d_device, D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS)))
         {
-            ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
+            ERR("Failed to get curves vertex buffer.\n");
             ID3D11Buffer_Release(ib);
             return;
         }
@@ -907,23 +887,16 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 
     if (geometry->outline.arc_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arc_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (!(ib = d2d_geometry_get_buffer(geometry, render_target->d3d_device,
+                D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES)))
         {
-            WARN("Failed to create arcs index buffer, hr %#lx.\n", hr);
+            WARN("Failed to get arcs index buffer.\n");
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.arc_count * sizeof(*geometry->outline.arcs);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arcs;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (!(vb = d2d_geometry_get_buffer(geometry, render_target->d3d_device, D2D_GEOMETRY_BUFFER_OUTLINE_ARCS)))
         {
-            ERR("Failed to create arcs vertex buffer, hr %#lx.\n", hr);
+            ERR("Failed to get arcs vertex buffer.\n");
             ID3D11Buffer_Release(ib);
             return;
         }
@@ -964,18 +937,9 @@ static void STDMETHODCALLTYPE d2d_device_context_DrawGeometry(ID2D1DeviceContext
 static void d2d_device_context_fill_geometry(struct d2d_device_context *render_target,
         const struct d2d_geometry *geometry, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
 {
-    D3D11_SUBRESOURCE_DATA buffer_data;
-    D3D11_BUFFER_DESC buffer_desc;
     ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
     if (FAILED(hr = d2d_device_context_update_vs_cb(render_target, &geometry->transform, 0.0f)))
     {
         WARN("Failed to update vs constant buffer, hr %#lx.\n", hr);
@@ -990,23 +954,15 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.face_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.face_count * sizeof(*geometry->fill.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (!(ib = d2d_geometry_get_buffer(geometry, render_target->d3d_device, D2D_GEOMETRY_BUFFER_FILL_FACES)))
         {
-            WARN("Failed to create index buffer, hr %#lx.\n", hr);
+            WARN("Failed to get index buffer.\n");
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (!(vb = d2d_geometry_get_buffer(geometry, render_target->d3d_device, D2D_GEOMETRY_BUFFER_FILL_VERTICES)))
         {
-            ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
+            ERR("Failed to get vertex buffer.\n");
             ID3D11Buffer_Release(ib);
             return;
         }
@@ -1020,13 +976,10 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.bezier_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.bezier_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (!(vb = d2d_geometry_get_buffer(geometry, render_target->d3d_device,
+                D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES)))
         {
-            ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
+            ERR("Failed to get curves vertex buffer.\n");
             return;
         }
 
@@ -1038,13 +991,10 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.arc_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.arc_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (!(vb = d2d_geometry_get_buffer(geometry, render_target->d3d_device,
+                D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES)))
         {
-            ERR("Failed to create arc vertex buffer, hr %#lx.\n", hr);
+            ERR("Failed to get arc vertex buffer.\n");
             return;
         }
 
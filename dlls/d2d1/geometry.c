@@ -1818,13 +1818,63 @@ static BOOL d2d_cdt_insert_segment(struct d2d_cdt *cdt, struct d2d_geometry *geo
     }
 }
 
+static BOOL d2d_cdt_find_origin_edge(const struct d2d_cdt *cdt, struct d2d_cdt_edge_ref *vertex_edges,
+        size_t vertex, struct d2d_cdt_edge_ref *edge)
+{
+    size_t k;
+
+    /* The map may be stale after earlier segment insertions, so validate
+     * the hint before falling back to a full scan. */
+    *edge = vertex_edges[vertex];
+    if (edge->idx < cdt->edge_count && !(cdt->edges[edge->idx].flags & D2D_CDT_EDGE_FLAG_FREED)
+            && d2d_cdt_edge_origin(cdt, edge) == vertex)
+        return TRUE;
+
+    for (k = 0; k < cdt->edge_count; ++k)
+    {
+        if (cdt->edges[k].flags & D2D_CDT_EDGE_FLAG_FREED)
+            continue;
+
+        edge->idx = k;
+        edge->r = 0;
+
+        if (d2d_cdt_edge_origin(cdt, edge) == vertex)
+            break;
+        d2d_cdt_edge_sym(edge, edge);
+        if (d2d_cdt_edge_origin(cdt, edge) == vertex)
+            break;
+    }
+
+    if (k == cdt->edge_count)
+        return FALSE;
+
+    vertex_edges[vertex] = *edge;
+    return TRUE;
+}
+
 static BOOL d2d_cdt_insert_segments(struct d2d_cdt *cdt, struct d2d_geometry *geometry)
 {
+    struct d2d_cdt_edge_ref edge, new_edge, *vertex_edges;
     size_t start_vertex, end_vertex, i, j, k;
-    struct d2d_cdt_edge_ref edge, new_edge;
     const struct d2d_figure *figure;
     const D2D1_POINT_2F *p;
-    BOOL found;
+    BOOL ret = FALSE;
+
+    /* Map each vertex to an edge originating from it, instead of scanning
+     * every edge for each figure. */
+    if (!(vertex_edges = calloc(geometry->fill.vertex_count, sizeof(*vertex_edges))))
+        return FALSE;
+    for (k = 0; k < cdt->edge_count; ++k)
+    {
+        if (cdt->edges[k].flags & D2D_CDT_EDGE_FLAG_FREED)
+            continue;
+
+        edge.idx = k;
+        edge.r = 0;
+        vertex_edges[d2d_cdt_edge_origin(cdt, &edge)] = edge;
+        d2d_cdt_edge_sym(&edge, &edge);
+        vertex_edges[d2d_cdt_edge_origin(cdt, &edge)] = edge;
+    }
 
     for (i = 0; i < geometry->u.path.figure_count; ++i)
     {
@@ -1841,31 +1891,10 @@ static BOOL d2d_cdt_insert_segments(struct d2d_cdt *cdt, struct d2d_geometry *ge
                 geometry->fill.vertex_count, sizeof(*p), d2d_cdt_compare_vertices);
         start_vertex = p - cdt->vertices;
 
-        for (k = 0, found = FALSE; k < cdt->edge_count; ++k)
-        {
-            if (cdt->edges[k].flags & D2D_CDT_EDGE_FLAG_FREED)
-                continue;
-
-            edge.idx = k;
-            edge.r = 0;
-
-            if (d2d_cdt_edge_origin(cdt, &edge) == start_vertex)
-            {
-                found = TRUE;
-                break;
-            }
-            d2d_cdt_edge_sym(&edge, &edge);
-            if (d2d_cdt_edge_origin(cdt, &edge) == start_vertex)
-            {
-                found = TRUE;
-                break;
-            }
-        }
-
-        if (!found)
+        if (!d2d_cdt_find_origin_edge(cdt, vertex_edges, start_vertex, &edge))
         {
             ERR("Edge not found.\n");
-            return FALSE;
+            goto done;
         }
 
         for (j = 0; j < figure->vertex_count; start_vertex = end_vertex, ++j)
@@ -1878,12 +1907,16 @@ static BOOL d2d_cdt_insert_segments(struct d2d_cdt *cdt, struct d2d_geometry *ge
                 continue;
 
             if (!d2d_cdt_insert_segment(cdt, geometry, &edge, &new_edge, end_vertex))
-                return FALSE;
+                goto done;
             edge = new_edge;
         }
     }
 
-    return TRUE;
+    ret = TRUE;
+
+done:
+    free(vertex_edges);
+    return ret;
 }
 
 static BOOL d2d_geometry_intersections_add(struct d2d_geometry_intersections *i,
@@ -2317,15 +2350,15 @@ static HRESULT d2d_path_geometry_triangulate(struct d2d_geometry *geometry)
 
     /* Sort vertices, eliminate duplicates. */
     qsort(vertices, vertex_count, sizeof(*vertices), d2d_cdt_compare_vertices);
-    for (i = 1; i < vertex_count; ++i)
+    for (i = 1, j = 1; i < vertex_count; ++i)
     {
-        if (!memcmp(&vertices[i - 1], &vertices[i], sizeof(*vertices)))
-        {
-            --vertex_count;
-            memmove(&vertices[i], &vertices[i + 1], (vertex_count - i) * sizeof(*vertices));
-            --i;
-        }
+        if (!memcmp(&vertices[j - 1], &vertices[i], sizeof(*vertices)))
+            continue;
+        if (j != i)
+            vertices[j] = vertices[i];
+        ++j;
     }
+    vertex_count = j;
 
     if (vertex_count < 3)
     {
@@ -2704,8 +2737,66 @@ static BOOL d2d_geometry_fill_add_arc_triangle(struct d2d_geometry *geometry,
     return TRUE;
 }
 
+/* All geometry buffer caches, so that buffers can be dropped when a device
+ * goes away. Lock order is d2d_geometry_buffer_caches_lock, then the cache
+ * lock. */
+static struct list d2d_geometry_buffer_caches = LIST_INIT(d2d_geometry_buffer_caches);
+static SRWLOCK d2d_geometry_buffer_caches_lock = SRWLOCK_INIT;
+
+static void d2d_geometry_buffers_destroy(struct d2d_geometry_buffers *buffers)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(buffers->buffers); ++i)
+    {
+        if (buffers->buffers[i])
+            ID3D11Buffer_Release(buffers->buffers[i]);
+    }
+    free(buffers);
+}
+
+static void d2d_geometry_buffer_cache_destroy(struct d2d_geometry_buffer_cache *cache)
+{
+    struct d2d_geometry_buffers *buffers, *next;
+
+    AcquireSRWLockExclusive(&d2d_geometry_buffer_caches_lock);
+    list_remove(&cache->entry);
+    ReleaseSRWLockExclusive(&d2d_geometry_buffer_caches_lock);
+
+    LIST_FOR_EACH_ENTRY_SAFE(buffers, next, &cache->buffers, struct d2d_geometry_buffers, entry)
+    {
+        d2d_geometry_buffers_destroy(buffers);
+    }
+    free(cache);
+}
+
+/* Drop the buffers of every geometry for "device". */
+void d2d_geometry_release_device_buffers(ID3D11Device1 *device)
+{
+    struct d2d_geometry_buffers *buffers, *next;
+    struct d2d_geometry_buffer_cache *cache;
+
+    AcquireSRWLockExclusive(&d2d_geometry_buffer_caches_lock);
+    LIST_FOR_EACH_ENTRY(cache, &d2d_geometry_buffer_caches, struct d2d_geometry_buffer_cache, entry)
+    {
+        AcquireSRWLockExclusive(&cache->lock);
+        LIST_FOR_EACH_ENTRY_SAFE(buffers, next, &cache->buffers, struct d2d_geometry_buffers, entry)
+        {
+            if (buffers->device != device)
+                continue;
+            list_remove(&buffers->entry);
+            d2d_geometry_buffers_destroy(buffers);
+            --cache->count;
+        }
+        ReleaseSRWLockExclusive(&cache->lock);
+    }
+    ReleaseSRWLockExclusive(&d2d_geometry_buffer_caches_lock);
+}
+
 static void d2d_geometry_cleanup(struct d2d_geometry *geometry)
 {
+    if (geometry->buffer_cache)
+        d2d_geometry_buffer_cache_destroy(geometry->buffer_cache);
     free(geometry->outline.arc_faces);
     free(geometry->outline.arcs);
     free(geometry->outline.bezier_faces);
@@ -5516,3 +5607,182 @@ struct d2d_geometry *unsafe_impl_from_ID2D1Geometry(ID2D1Geometry *iface)
             || iface->lpVtbl == (const ID2D1GeometryVtbl *)&d2d_geometry_group_vtbl);
     return CONTAINING_RECORD(iface, struct d2d_geometry, ID2D1Geometry_iface);
 }
+
+/* Number of devices per geometry for which buffers are kept around. */
+#define D2D_GEOMETRY_MAX_CACHED_DEVICES 4
+
+static BOOL d2d_geometry_get_buffer_data(const struct d2d_geometry *geometry, enum d2d_geometry_buffer idx,
+        D3D11_BUFFER_DESC *desc, D3D11_SUBRESOURCE_DATA *data)
+{
+    size_t size;
+
+    switch (idx)
+    {
+        case D2D_GEOMETRY_BUFFER_FILL_FACES:
+            size = geometry->fill.face_count * sizeof(*geometry->fill.faces);
+            data->pSysMem = geometry->fill.faces;
+            break;
+        case D2D_GEOMETRY_BUFFER_FILL_VERTICES:
+            size = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
+            data->pSysMem = geometry->fill.vertices;
+            break;
+        case D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES:
+            size = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
+            data->pSysMem = geometry->fill.bezier_vertices;
+            break;
+        case D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES:
+            size = geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices);
+            data->pSysMem = geometry->fill.arc_vertices;
+            break;
+        case D2D_GEOMETRY_BUFFER_OUTLINE_FACES:
+            size = geometry->outline.face_count * sizeof(*geometry->outline.faces);
+            data->pSysMem = geometry->outline.faces;
+            break;
+        case D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES:
+            size = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
+            data->pSysMem = geometry->outline.vertices;
+            break;
+        case D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES:
+            size = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
+            data->pSysMem = geometry->outline.bezier_faces;
+            break;
+        case D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS:
+            size = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
+            data->pSysMem = geometry->outline.beziers;
+            break;
+        case D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES:
+            size = geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces);
+            data->pSysMem = geometry->outline.arc_faces;
+            break;
+        case D2D_GEOMETRY_BUFFER_OUTLINE_ARCS:
+            size = geometry->outline.arc_count * sizeof(*geometry->outline.arcs);
+            data->pSysMem = geometry->outline.arcs;
+            break;
+        default:
+            return FALSE;
+    }
+
+    if (!size || size > UINT_MAX)
+        return FALSE;
+
+    desc->ByteWidth = size;
+    desc->Usage = D3D11_USAGE_IMMUTABLE;
+    switch (idx)
+    {
+        case D2D_GEOMETRY_BUFFER_FILL_FACES:
+        case D2D_GEOMETRY_BUFFER_OUTLINE_FACES:
+        case D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES:
+        case D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES:
+            desc->BindFlags = D3D11_BIND_INDEX_BUFFER;
+            break;
+        default:
+            desc->BindFlags = D3D11_BIND_VERTEX_BUFFER;
+            break;
+    }
+    desc->CPUAccessFlags = 0;
+    desc->MiscFlags = 0;
+    desc->StructureByteStride = 0;
+
+    data->SysMemPitch = 0;
+    data->SysMemSlicePitch = 0;
+
+    return TRUE;
+}
+
+/* The tessellation of a geometry never changes once it has been created, so
+ * the device buffers built from it can be reused by every render target on
+ * the same device. Transformed geometries share the tessellation, and hence
+ * the buffers, of their source geometry. Returns a new reference. */
+ID3D11Buffer *d2d_geometry_get_buffer(const struct d2d_geometry *geometry, ID3D11Device1 *device,
+        enum d2d_geometry_buffer idx)
+{
+    struct d2d_geometry_buffer_cache *cache, *new_cache;
+    struct d2d_geometry_buffers *buffers;
+    D3D11_SUBRESOURCE_DATA buffer_data;
+    D3D11_BUFFER_DESC buffer_desc;
+    struct d2d_geometry *owner;
+    ID3D11Buffer *buffer;
+    BOOL found = FALSE;
+    HRESULT hr;
+
+    if (!d2d_geometry_get_buffer_data(geometry, idx, &buffer_desc, &buffer_data))
+        return NULL;
+
+    owner = (struct d2d_geometry *)geometry;
+    while (owner->ID2D1Geometry_iface.lpVtbl == (const ID2D1GeometryVtbl *)&d2d_transformed_geometry_vtbl)
+        owner = unsafe_impl_from_ID2D1Geometry(owner->u.transformed.src_geometry);
+
+    if (!(cache = owner->buffer_cache))
+    {
+        if (!(new_cache = calloc(1, sizeof(*new_cache))))
+            return NULL;
+        InitializeSRWLock(&new_cache->lock);
+        list_init(&new_cache->buffers);
+        AcquireSRWLockExclusive(&d2d_geometry_buffer_caches_lock);
+        if ((cache = InterlockedCompareExchangePointer((void **)&owner->buffer_cache, new_cache, NULL)))
+        {
+            free(new_cache);
+        }
+        else
+        {
+            list_add_tail(&d2d_geometry_buffer_caches, &new_cache->entry);
+            cache = new_cache;
+        }
+        ReleaseSRWLockExclusive(&d2d_geometry_buffer_caches_lock);
+    }
+
+    AcquireSRWLockExclusive(&cache->lock);
+
+    LIST_FOR_EACH_ENTRY(buffers, &cache->buffers, struct d2d_geometry_buffers, entry)
+    {
+        if (buffers->device == device)
+        {
+            found = TRUE;
+            break;
+        }
+    }
+
+    if (found)
+    {
+        /* Keep the most recently used device first. */
+        list_remove(&buffers->entry);
+        list_add_head(&cache->buffers, &buffers->entry);
+    }
+    else
+    {
+        if (cache->count == D2D_GEOMETRY_MAX_CACHED_DEVICES)
+        {
+            struct d2d_geometry_buffers *oldest;
+
+            oldest = LIST_ENTRY(list_tail(&cache->buffers), struct d2d_geometry_buffers, entry);
+            list_remove(&oldest->entry);
+            d2d_geometry_buffers_destroy(oldest);
+            --cache->count;
+        }
+
+        if (!(buffers = calloc(1, sizeof(*buffers))))
+        {
+            ReleaseSRWLockExclusive(&cache->lock);
+            return NULL;
+        }
+        buffers->device = device;
+        list_add_head(&cache->buffers, &buffers->entry);
+        ++cache->count;
+    }
+
+    if (!(buffer = buffers->buffers[idx]))
+    {
+        if (FAILED(hr = ID3D11Device1_CreateBuffer(device, &buffer_desc, &buffer_data, &buffer)))
+        {
+            WARN("Failed to create buffer %u, hr %#lx.\n", idx, hr);
+            ReleaseSRWLockExclusive(&cache->lock);
+            return NULL;
+        }
+        buffers->buffers[idx] = buffer;
+    }
+    ID3D11Buffer_AddRef(buffer);
+
+    ReleaseSRWLockExclusive(&cache->lock);
+
+    return buffer;
+}
@@ -8487,6 +8487,168 @@ static void test_fill_geometry(BOOL d3d11)
     release_test_context(&ctx);
 }
 
+static ULONG get_device_refcount(IDXGIDevice *device)
+{
+    IDXGIDevice_AddRef(device);
+    return IDXGIDevice_Release(device);
+}
+
+static void fill_cached_geometry(ID2D1RenderTarget *rt, ID2D1Geometry **geometries,
+        unsigned int count, ID2D1Brush *brush)
+{
+    D2D1_COLOR_F color;
+    D2D1_RECT_F rect;
+    unsigned int i;
+    HRESULT hr;
+
+    ID2D1RenderTarget_BeginDraw(rt);
+    set_color(&color, 0.0f, 0.0f, 1.0f, 1.0f);
+    ID2D1RenderTarget_Clear(rt, &color);
+    for (i = 0; i < count; ++i)
+        ID2D1RenderTarget_FillGeometry(rt, geometries[i], brush, NULL);
+    /* Always finish with the same draw, so that the buffers left bound to the
+     * render target's device state don't depend on "geometries". */
+    set_rect(&rect, 0.0f, 0.0f, 1.0f, 1.0f);
+    ID2D1RenderTarget_FillRectangle(rt, &rect, brush);
+    hr = ID2D1RenderTarget_EndDraw(rt, NULL, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+}
+
+#define check_cached_geometry(a) check_cached_geometry_(__LINE__, a)
+static void check_cached_geometry_(unsigned int line, struct d2d1_test_context *ctx)
+{
+    static const struct
+    {
+        unsigned int x, y;
+        DWORD colour;
+    }
+    tests[] =
+    {
+        { 30,  30, 0xffff0000},
+        {130,  30, 0xffff0000},
+        { 80,  30, 0xff0000ff},
+        { 30,  80, 0xff0000ff},
+    };
+    struct resource_readback rb;
+    unsigned int i;
+    DWORD colour;
+
+    get_surface_readback(ctx, &rb);
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        colour = get_readback_colour(&rb, tests[i].x, tests[i].y);
+        ok_(__FILE__, line)(compare_colour(colour, tests[i].colour, 1),
+                "Got unexpected colour 0x%08lx at {%u, %u}.\n", colour, tests[i].x, tests[i].y);
+    }
+    release_resource_readback(&rb);
+}
+
+static void test_geometry_buffer_cache(BOOL d3d11)
+{
+    ID2D1TransformedGeometry *transformed_geometry;
+    D2D1_RENDER_TARGET_PROPERTIES desc;
+    ID2D1SolidColorBrush *brush, *brush2;
+    ID2D1RectangleGeometry *rect_geometry;
+    ULONG refcount, cached_refcount;
+    ID2D1Geometry *geometries[2];
+    struct d2d1_test_context ctx;
+    D2D1_MATRIX_3X2_F matrix;
+    ID2D1RenderTarget *rt;
+    D2D1_COLOR_F color;
+    D2D1_RECT_F rect;
+    BOOL is_wine;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    /* Device references are an implementation detail; only check them where
+     * they are known to come from the buffers. */
+    is_wine = !strcmp(winetest_platform, "wine");
+
+    ID2D1RenderTarget_SetAntialiasMode(ctx.rt, D2D1_ANTIALIAS_MODE_ALIASED);
+    set_color(&color, 1.0f, 0.0f, 0.0f, 1.0f);
+    hr = ID2D1RenderTarget_CreateSolidColorBrush(ctx.rt, &color, NULL, &brush);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    set_rect(&rect, 10.0f, 10.0f, 50.0f, 50.0f);
+    hr = ID2D1Factory_CreateRectangleGeometry(ctx.factory, &rect, &rect_geometry);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    set_matrix_identity(&matrix);
+    translate_matrix(&matrix, 100.0f, 0.0f);
+    hr = ID2D1Factory_CreateTransformedGeometry(ctx.factory, (ID2D1Geometry *)rect_geometry,
+            &matrix, &transformed_geometry);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    geometries[0] = (ID2D1Geometry *)rect_geometry;
+    geometries[1] = (ID2D1Geometry *)transformed_geometry;
+
+    /* Create any per-context device objects first. */
+    fill_cached_geometry(ctx.rt, geometries, 0, (ID2D1Brush *)brush);
+    refcount = get_device_refcount(ctx.device);
+
+    fill_cached_geometry(ctx.rt, geometries, ARRAY_SIZE(geometries), (ID2D1Brush *)brush);
+    check_cached_geometry(&ctx);
+    cached_refcount = get_device_refcount(ctx.device);
+    if (is_wine)
+        ok(cached_refcount > refcount, "Got unexpected refcount %lu, expected > %lu.\n", cached_refcount, refcount);
+
+    /* The transformed geometry shares the buffers of its source, and drawing
+     * again reuses them. */
+    fill_cached_geometry(ctx.rt, geometries, ARRAY_SIZE(geometries), (ID2D1Brush *)brush);
+    check_cached_geometry(&ctx);
+    if (is_wine)
+    {
+        ULONG new_refcount = get_device_refcount(ctx.device);
+        ok(new_refcount == cached_refcount, "Got unexpected refcount %lu, expected %lu.\n",
+                new_refcount, cached_refcount);
+    }
+
+    /* A second render target on the same device uses the same buffers.
+     * Destroying it drops them, and the first render target recreates them. */
+    desc.type = D2D1_RENDER_TARGET_TYPE_DEFAULT;
+    desc.pixelFormat.format = DXGI_FORMAT_UNKNOWN;
+    desc.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
+    desc.dpiX = 0.0f;
+    desc.dpiY = 0.0f;
+    desc.usage = D2D1_RENDER_TARGET_USAGE_NONE;
+    desc.minLevel = D2D1_FEATURE_LEVEL_DEFAULT;
+    hr = ID2D1Factory_CreateDxgiSurfaceRenderTarget(ctx.factory, ctx.surface, &desc, &rt);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1RenderTarget_SetAntialiasMode(rt, D2D1_ANTIALIAS_MODE_ALIASED);
+    hr = ID2D1RenderTarget_CreateSolidColorBrush(rt, &color, NULL, &brush2);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    fill_cached_geometry(rt, geometries, ARRAY_SIZE(geometries), (ID2D1Brush *)brush2);
+    check_cached_geometry(&ctx);
+    ID2D1SolidColorBrush_Release(brush2);
+    ID2D1RenderTarget_Release(rt);
+    if (is_wine)
+    {
+        ULONG new_refcount = get_device_refcount(ctx.device);
+        ok(new_refcount == refcount, "Got unexpected refcount %lu, expected %lu.\n", new_refcount, refcount);
+    }
+
+    fill_cached_geometry(ctx.rt, geometries, ARRAY_SIZE(geometries), (ID2D1Brush *)brush);
+    check_cached_geometry(&ctx);
+    if (is_wine)
+    {
+        ULONG new_refcount = get_device_refcount(ctx.device);
+        ok(new_refcount == cached_refcount, "Got unexpected refcount %lu, expected %lu.\n",
+                new_refcount, cached_refcount);
+    }
+
+    /* Destroying the geometry releases its buffers. */
+    ID2D1TransformedGeometry_Release(transformed_geometry);
+    ID2D1RectangleGeometry_Release(rect_geometry);
+    if (is_wine)
+    {
+        ULONG new_refcount = get_device_refcount(ctx.device);
+        ok(new_refcount == refcount, "Got unexpected refcount %lu, expected %lu.\n", new_refcount, refcount);
+    }
+
+    ID2D1SolidColorBrush_Release(brush);
+    release_test_context(&ctx);
+}
+
 static void test_gdi_interop(BOOL d3d11)
 {
     ID2D1GdiInteropRenderTarget *interop;
@@ -13407,6 +13569,7 @@ START_TEST(d2d1)
     queue_test(test_gradient);
     queue_test(test_draw_geometry);
     queue_test(test_fill_geometry);
+    queue_test(test_geometry_buffer_cache);
     queue_test(test_gdi_interop);
     queue_test(test_layer);
     queue_test(test_bezier_intersect);
@@ -252,6 +252,7 @@ struct dwrite_fontface
         size_t max_size;
         size_t size;
     } cache;
+    struct glyph_cache_font *glyph_cache_font;
     CRITICAL_SECTION cs;
 
     USHORT simulations;
@@ -312,6 +313,7 @@ extern IDWriteTextAnalyzer2 *get_text_analyzer(void) DECLSPEC_HIDDEN;
 extern HRESULT create_font_file(IDWriteFontFileLoader *loader, const void *reference_key, UINT32 key_size, IDWriteFontFile **font_file) DECLSPEC_HIDDEN;
 extern void    init_local_fontfile_loader(void) DECLSPEC_HIDDEN;
 extern IDWriteFontFileLoader *get_local_fontfile_loader(void) DECLSPEC_HIDDEN;
+extern void release_glyph_cache(void) DECLSPEC_HIDDEN;
 extern HRESULT create_fontface(const struct fontface_desc *desc, struct list *cached_list,
         IDWriteFontFace5 **fontface) DECLSPEC_HIDDEN;
 extern HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerator *enumerator, BOOL is_system,
@@ -60,23 +60,17 @@ struct cache_entry
     struct cache_key key;
     int advance;
     RECT bbox;
-    BYTE *bitmap;
-    unsigned int bitmap_size;
-    unsigned int is_1bpp : 1;
     unsigned int has_contours : 1;
     unsigned int has_advance : 1;
     unsigned int has_bbox : 1;
-    unsigned int has_bitmap : 1;
 };
 
 static void fontface_release_cache_entry(struct cache_entry *entry)
 {
-    free(entry->bitmap);
     free(entry);
 }
 
-static struct cache_entry * fontface_get_cache_entry(struct dwrite_fontface *fontface, size_t size,
-        const struct cache_key *key)
+static struct cache_entry * fontface_get_cache_entry(struct dwrite_fontface *fontface, const struct cache_key *key)
 {
     struct cache_entry *entry, *old_entry;
     struct wine_rb_entry *e;
@@ -87,12 +81,10 @@ static struct cache_entry * fontface_get_cache_entry(struct dwrite_fontface *fon
         entry->key = *key;
         list_init(&entry->mru);
 
-        size += sizeof(*entry);
-
-        if ((fontface->cache.size + size > fontface->cache.max_size) && !list_empty(&fontface->cache.mru))
+        if ((fontface->cache.size + sizeof(*entry) > fontface->cache.max_size) && !list_empty(&fontface->cache.mru))
         {
             old_entry = LIST_ENTRY(list_tail(&fontface->cache.mru), struct cache_entry, mru);
-            fontface->cache.size -= (old_entry->bitmap_size + sizeof(*old_entry));
+            fontface->cache.size -= sizeof(*old_entry);
             wine_rb_remove(&fontface->cache.tree, &old_entry->entry);
             list_remove(&old_entry->mru);
             fontface_release_cache_entry(old_entry);
@@ -105,7 +97,7 @@ static struct cache_entry * fontface_get_cache_entry(struct dwrite_fontface *fon
             return NULL;
         }
 
-        fontface->cache.size += size;
+        fontface->cache.size += sizeof(*entry);
     }
     else
         entry = WINE_RB_ENTRY_VALUE(e, struct cache_entry, entry);
@@ -124,7 +116,7 @@ static int fontface_get_glyph_advance(struct dwrite_fontface *fontface, float fo
     struct cache_entry *entry;
     unsigned int value;
 
-    if (!(entry = fontface_get_cache_entry(fontface, 0, &key)))
+    if (!(entry = fontface_get_cache_entry(fontface, &key)))
         return 0;
 
     if (!entry->has_advance)
@@ -166,7 +158,7 @@ void dwrite_fontface_get_glyph_bbox(IDWriteFontFace *iface, struct dwrite_glyphb
         params.bbox = &bitmap->bbox;
         UNIX_CALL(get_glyph_bbox, &params);
     }
-    else if ((entry = fontface_get_cache_entry(fontface, 0, &key)))
+    else if ((entry = fontface_get_cache_entry(fontface, &key)))
     {
         if (!entry->has_bbox)
         {
@@ -184,60 +176,331 @@ static unsigned int get_glyph_bitmap_pitch(DWRITE_RENDERING_MODE1 rendering_mode
     return rendering_mode == DWRITE_RENDERING_MODE1_ALIASED ? ((width + 31) >> 5) << 2 : (width + 3) / 4 * 4;
 }
 
+/* Glyph bitmaps are kept in a process-wide cache, shared by all font faces
+   created for the same font file, face index and simulations, whatever factory
+   they were created from. Bitmaps are packed together with their cache entries
+   into fixed size pages, and the oldest page is recycled as a whole once the
+   budget is exhausted. */
+
+#define GLYPH_CACHE_PAGE_SIZE 0x10000
+#define GLYPH_CACHE_MAX_PAGES 64
+#define GLYPH_CACHE_MAX_BITMAP_SIZE (GLYPH_CACHE_PAGE_SIZE / 4)
+
+struct glyph_cache_font
+{
+    struct list entry;
+    LONG refcount;
+    IDWriteFontFileLoader *loader;
+    UINT32 index;
+    USHORT simulations;
+    struct wine_rb_tree tree;
+    size_t glyph_count;
+    UINT32 key_size;
+    BYTE key[1];
+};
+
+struct glyph_cache_key
+{
+    float emsize;
+    DWRITE_MATRIX m;
+    UINT16 glyph;
+    UINT16 mode;
+};
+
+struct glyph_cache_entry
+{
+    struct wine_rb_entry entry;
+    struct glyph_cache_font *font;
+    struct glyph_cache_key key;
+    unsigned int alloc_size;
+    unsigned int bitmap_size;
+    unsigned int is_1bpp;
+    BYTE bitmap[1];
+};
+
+struct glyph_cache_page
+{
+    struct list entry;
+    size_t used;
+    BYTE data[GLYPH_CACHE_PAGE_SIZE];
+};
+
+static struct glyph_cache
+{
+    SRWLOCK lock;
+    struct list fonts;
+    struct list pages;
+    unsigned int page_count;
+    LONG hits;
+    LONG misses;
+} glyph_cache =
+{
+    SRWLOCK_INIT,
+    LIST_INIT(glyph_cache.fonts),
+    LIST_INIT(glyph_cache.pages),
+};
+
+static int glyph_cache_compare(const void *k, const struct wine_rb_entry *e)
+{
+    const struct glyph_cache_entry *entry = WINE_RB_ENTRY_VALUE(e, const struct glyph_cache_entry, entry);
+
+    return memcmp(k, &entry->key, sizeof(entry->key));
+}
+
+static void glyph_cache_free_font(struct glyph_cache_font *font)
+{
+    list_remove(&font->entry);
+    free(font);
+}
+
+/* Entries are left in their pages, they are skipped once detached from the font. */
+static void glyph_cache_detach_entry(struct wine_rb_entry *e, void *context)
+{
+    struct glyph_cache_entry *entry = WINE_RB_ENTRY_VALUE(e, struct glyph_cache_entry, entry);
+
+    entry->font = NULL;
+}
+
+static struct glyph_cache_font *glyph_cache_get_font(struct dwrite_fontface *fontface)
+{
+    struct glyph_cache_font *font;
+    IDWriteFontFileLoader *loader;
+    UINT32 key_size;
+    const void *key;
+
+    if (fontface->glyph_cache_font)
+        return fontface->glyph_cache_font;
+
+    if (FAILED(IDWriteFontFile_GetReferenceKey(fontface->file, &key, &key_size)))
+        return NULL;
+    if (FAILED(IDWriteFontFile_GetLoader(fontface->file, &loader)))
+        return NULL;
+    /* Loader reference is not kept, see glyph_cache_release_font(). */
+    IDWriteFontFileLoader_Release(loader);
+
+    AcquireSRWLockExclusive(&glyph_cache.lock);
+
+    LIST_FOR_EACH_ENTRY(font, &glyph_cache.fonts, struct glyph_cache_font, entry)
+    {
+        if (font->loader == loader && font->index == fontface->index && font->simulations == fontface->simulations
+                && font->key_size == key_size && !memcmp(font->key, key, key_size))
+        {
+            ++font->refcount;
+            goto done;
+        }
+    }
+
+    if ((font = calloc(1, FIELD_OFFSET(struct glyph_cache_font, key[key_size]))))
+    {
+        font->refcount = 1;
+        font->loader = loader;
+        font->index = fontface->index;
+        font->simulations = fontface->simulations;
+        wine_rb_init(&font->tree, glyph_cache_compare);
+        font->key_size = key_size;
+        memcpy(font->key, key, key_size);
+        list_add_head(&glyph_cache.fonts, &font->entry);
+    }
+
+done:
+    if (font && InterlockedCompareExchangePointer((void **)&fontface->glyph_cache_font, font, NULL))
+    {
+        /* Lost the race to another thread, which holds its own reference. */
+        if (!--font->refcount)
+            glyph_cache_free_font(font);
+        font = fontface->glyph_cache_font;
+    }
+
+    ReleaseSRWLockExclusive(&glyph_cache.lock);
+
+    return font;
+}
+
+static void glyph_cache_release_font(struct glyph_cache_font *font)
+{
+    if (!font)
+        return;
+
+    AcquireSRWLockExclusive(&glyph_cache.lock);
+
+    if (!--font->refcount)
+    {
+        /* Only the system loader is known to outlive its font faces, bitmaps
+           for other loaders can't be safely matched once the loader could be
+           gone. */
+        if (font->loader != get_local_fontfile_loader())
+        {
+            wine_rb_destroy(&font->tree, glyph_cache_detach_entry, NULL);
+            font->glyph_count = 0;
+        }
+        if (!font->glyph_count)
+            glyph_cache_free_font(font);
+    }
+
+    ReleaseSRWLockExclusive(&glyph_cache.lock);
+}
+
+static void glyph_cache_recycle_page(struct glyph_cache_page *page)
+{
+    struct glyph_cache_entry *entry;
+    size_t offset;
+
+    for (offset = 0; offset < page->used; offset += entry->alloc_size)
+    {
+        entry = (struct glyph_cache_entry *)(page->data + offset);
+        if (!entry->font)
+            continue;
+
+        wine_rb_remove(&entry->font->tree, &entry->entry);
+        if (!--entry->font->glyph_count && !entry->font->refcount)
+            glyph_cache_free_font(entry->font);
+    }
+    page->used = 0;
+
+    TRACE("Recycled glyph cache page, hits %lu, misses %lu.\n", glyph_cache.hits, glyph_cache.misses);
+}
+
+static struct glyph_cache_entry *glyph_cache_alloc_entry(unsigned int size)
+{
+    struct glyph_cache_page *page = NULL;
+    struct glyph_cache_entry *entry;
+
+    size = (FIELD_OFFSET(struct glyph_cache_entry, bitmap[size]) + 7) & ~7;
+
+    if (!list_empty(&glyph_cache.pages))
+        page = LIST_ENTRY(list_head(&glyph_cache.pages), struct glyph_cache_page, entry);
+
+    if (!page || page->used + size > sizeof(page->data))
+    {
+        if (glyph_cache.page_count < GLYPH_CACHE_MAX_PAGES && (page = malloc(sizeof(*page))))
+        {
+            ++glyph_cache.page_count;
+            page->used = 0;
+        }
+        else
+        {
+            if (list_empty(&glyph_cache.pages))
+                return NULL;
+            page = LIST_ENTRY(list_tail(&glyph_cache.pages), struct glyph_cache_page, entry);
+            list_remove(&page->entry);
+            glyph_cache_recycle_page(page);
+        }
+        list_add_head(&glyph_cache.pages, &page->entry);
+    }
+
+    entry = (struct glyph_cache_entry *)(page->data + page->used);
+    entry->alloc_size = size;
+    entry->font = NULL;
+    page->used += size;
+
+    return entry;
+}
+
+static BOOL glyph_cache_get_bitmap(struct glyph_cache_font *font, const struct glyph_cache_key *key,
+        BYTE *bitmap, unsigned int bitmap_size, unsigned int *is_1bpp)
+{
+    struct glyph_cache_entry *entry;
+    struct wine_rb_entry *e;
+    BOOL ret = FALSE;
+
+    AcquireSRWLockShared(&glyph_cache.lock);
+    if ((e = wine_rb_get(&font->tree, key)))
+    {
+        entry = WINE_RB_ENTRY_VALUE(e, struct glyph_cache_entry, entry);
+        if (entry->bitmap_size == bitmap_size)
+        {
+            memcpy(bitmap, entry->bitmap, bitmap_size);
+            *is_1bpp = entry->is_1bpp;
+            ret = TRUE;
+        }
+    }
+    ReleaseSRWLockShared(&glyph_cache.lock);
+
+    InterlockedIncrement(ret ? &glyph_cache.hits : &glyph_cache.misses);
+
+    return ret;
+}
+
+static void glyph_cache_put_bitmap(struct glyph_cache_font *font, const struct glyph_cache_key *key,
+        const BYTE *bitmap, unsigned int bitmap_size, unsigned int is_1bpp)
+{
+    struct glyph_cache_entry *entry;
+
+    AcquireSRWLockExclusive(&glyph_cache.lock);
+    if (!wine_rb_get(&font->tree, key) && (entry = glyph_cache_alloc_entry(bitmap_size)))
+    {
+        entry->font = font;
+        entry->key = *key;
+        entry->bitmap_size = bitmap_size;
+        entry->is_1bpp = is_1bpp;
+        memcpy(entry->bitmap, bitmap, bitmap_size);
+        wine_rb_put(&font->tree, key, &entry->entry);
+        ++font->glyph_count;
+    }
+    ReleaseSRWLockExclusive(&glyph_cache.lock);
+}
+
+void release_glyph_cache(void)
+{
+    struct glyph_cache_font *font, *font2;
+    struct glyph_cache_page *page, *page2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(page, page2, &glyph_cache.pages, struct glyph_cache_page, entry)
+    {
+        list_remove(&page->entry);
+        free(page);
+    }
+    glyph_cache.page_count = 0;
+
+    LIST_FOR_EACH_ENTRY_SAFE(font, font2, &glyph_cache.fonts, struct glyph_cache_font, entry)
+        glyph_cache_free_font(font);
+
+    TRACE("Glyph cache hits %lu, misses %lu.\n", glyph_cache.hits, glyph_cache.misses);
+}
+
 static HRESULT dwrite_fontface_get_glyph_bitmap(struct dwrite_fontface *fontface, DWRITE_RENDERING_MODE rendering_mode,
         unsigned int *is_1bpp, struct dwrite_glyphbitmap *bitmap)
 {
-    struct cache_key key = { .size = bitmap->emsize, .glyph = bitmap->glyph, .mode = DWRITE_MEASURING_MODE_NATURAL };
     struct get_glyph_bitmap_params params;
     const RECT *bbox = &bitmap->bbox;
-    unsigned int bitmap_size, _1bpp;
-    struct cache_entry *entry;
-    HRESULT hr = S_OK;
+    struct glyph_cache_font *font = NULL;
+    struct glyph_cache_key key;
+    unsigned int bitmap_size;
 
     bitmap_size = get_glyph_bitmap_pitch(rendering_mode, bbox->right - bbox->left) *
             (bbox->bottom - bbox->top);
 
+    memset(&key, 0, sizeof(key));
+    key.emsize = bitmap->emsize;
+    key.m = bitmap->m ? *bitmap->m : identity;
+    key.glyph = bitmap->glyph;
+    key.mode = rendering_mode;
+
+    if (bitmap_size <= GLYPH_CACHE_MAX_BITMAP_SIZE && (font = glyph_cache_get_font(fontface)))
+    {
+        if (glyph_cache_get_bitmap(font, &key, bitmap->buf, bitmap_size, is_1bpp))
+            return S_OK;
+    }
+
     params.object = fontface->get_font_object(fontface);
     params.simulations = fontface->simulations;
     params.glyph = bitmap->glyph;
     params.mode = rendering_mode;
     params.emsize = bitmap->emsize;
-    params.m = bitmap->m ? *bitmap->m : identity;
+    params.m = key.m;
     params.bbox = bitmap->bbox;
     params.pitch = bitmap->pitch;
     params.bitmap = bitmap->buf;
     params.is_1bpp = is_1bpp;
 
     EnterCriticalSection(&fontface->cs);
-    /* For now bypass cache for transformed cases. */
-    if (memcmp(&params.m, &identity, sizeof(params.m)))
-    {
-        UNIX_CALL(get_glyph_bitmap, &params);
-    }
-    else if ((entry = fontface_get_cache_entry(fontface, bitmap_size, &key)))
-    {
-        if (entry->has_bitmap)
-        {
-            memcpy(bitmap->buf, entry->bitmap, entry->bitmap_size);
-        }
-        else
-        {
-            params.is_1bpp = &_1bpp;
-            UNIX_CALL(get_glyph_bitmap, &params);
-
-            entry->bitmap_size = bitmap_size;
-            if ((entry->bitmap = malloc(entry->bitmap_size)))
-                memcpy(entry->bitmap, bitmap->buf, entry->bitmap_size);
-            entry->is_1bpp = !!_1bpp;
-            entry->has_bitmap = 1;
-        }
-        *is_1bpp = entry->is_1bpp;
-    }
-    else
-        hr = E_FAIL;
+    UNIX_CALL(get_glyph_bitmap, &params);
     LeaveCriticalSection(&fontface->cs);
 
-    return hr;
+    if (font)
+        glyph_cache_put_bitmap(font, &key, bitmap->buf, bitmap_size, !!*is_1bpp);
+
+    return S_OK;
 }
 
 static int fontface_cache_compare(const void *k, const struct wine_rb_entry *e)
@@ -880,6 +1143,7 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
             IDWriteFontFileStream_Release(fontface->stream);
         }
         fontface_cache_clear(fontface);
+        glyph_cache_release_font(fontface->glyph_cache_font);
 
         dwrite_cmap_release(&fontface->cmap);
         IDWriteFactory7_Release(fontface->factory);
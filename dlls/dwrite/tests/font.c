@@ -7309,14 +7309,14 @@ static void test_GetAlphaBlendParams(void)
 
 static void test_CreateAlphaTexture(void)
 {
+    IDWriteFontFace *fontface, *fontface2;
+    IDWriteFactory *factory, *factory2;
     IDWriteGlyphRunAnalysis *analysis;
     DWRITE_GLYPH_METRICS metrics;
     DWRITE_GLYPH_OFFSET offset;
-    IDWriteFontFace *fontface;
-    IDWriteFactory *factory;
+    BYTE buff[1024], buff2[1024];
     DWRITE_GLYPH_RUN run;
     UINT32 ch, size;
-    BYTE buff[1024];
     RECT bounds, r;
     FLOAT advance;
     UINT16 glyph;
@@ -7444,7 +7444,35 @@ static void test_CreateAlphaTexture(void)
     ok(hr == DWRITE_E_UNSUPPORTEDOPERATION || broken(hr == S_OK), "Unexpected hr %#lx.\n", hr);
     ok(buff[0] == 0xcf || broken(buff[0] == 0), "got %1x\n", buff[0]);
 
+    /* Same run rendered through a face from another factory. */
+    memset(buff, 0xcf, sizeof(buff));
+    hr = IDWriteGlyphRunAnalysis_CreateAlphaTexture(analysis, DWRITE_TEXTURE_ALIASED_1x1, &bounds, buff, size);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    IDWriteGlyphRunAnalysis_Release(analysis);
+
+    factory2 = create_factory();
+    run.fontFace = fontface2 = create_fontface(factory2);
+
+    hr = IDWriteFactory_CreateGlyphRunAnalysis(factory2, &run, 1.0, NULL,
+        DWRITE_RENDERING_MODE_ALIASED, DWRITE_MEASURING_MODE_GDI_CLASSIC,
+        0.0, 0.0, &analysis);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    SetRectEmpty(&r);
+    hr = IDWriteGlyphRunAnalysis_GetAlphaTextureBounds(analysis, DWRITE_TEXTURE_ALIASED_1x1, &r);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(EqualRect(&r, &bounds), "Unexpected bounds %s.\n", wine_dbgstr_rect(&r));
+
+    memset(buff2, 0xcf, sizeof(buff2));
+    hr = IDWriteGlyphRunAnalysis_CreateAlphaTexture(analysis, DWRITE_TEXTURE_ALIASED_1x1, &bounds, buff2, size);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(!memcmp(buff, buff2, size), "Unexpected texture data.\n");
+
     IDWriteGlyphRunAnalysis_Release(analysis);
+    IDWriteFontFace_Release(fontface2);
+    ref = IDWriteFactory_Release(factory2);
+    ok(ref == 0, "factory not released, %lu\n", ref);
+
     IDWriteFontFace_Release(fontface);
     ref = IDWriteFactory_Release(factory);
     ok(ref == 0, "factory not released, %lu\n", ref);
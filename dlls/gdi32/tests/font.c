@@ -7719,6 +7719,82 @@ static void test_select_object(void)
     DeleteObject(hfont);
 }
 
+static INT CALLBACK font_index_enum_proc(const LOGFONTW *lf, const TEXTMETRICW *tm, DWORD type, LPARAM lparam)
+{
+    const ENUMLOGFONTEXW *elf = (const ENUMLOGFONTEXW *)lf;
+    const NEWTEXTMETRICEXW *ntm = (const NEWTEXTMETRICEXW *)tm;
+    DWORD hash = 0x811c9dc5, *sum = (DWORD *)lparam;
+    const BYTE *ptr;
+    unsigned int i;
+
+#define HASH_DATA(data, size) for (i = 0, ptr = (const BYTE *)(data); i < (size); i++) hash = (hash ^ ptr[i]) * 0x01000193
+    HASH_DATA(elf->elfLogFont.lfFaceName, lstrlenW(elf->elfLogFont.lfFaceName) * sizeof(WCHAR));
+    HASH_DATA(elf->elfFullName, lstrlenW(elf->elfFullName) * sizeof(WCHAR));
+    HASH_DATA(elf->elfStyle, lstrlenW(elf->elfStyle) * sizeof(WCHAR));
+    HASH_DATA(&elf->elfLogFont.lfCharSet, sizeof(elf->elfLogFont.lfCharSet));
+    HASH_DATA(&ntm->ntmTm.ntmFlags, sizeof(ntm->ntmTm.ntmFlags));
+    HASH_DATA(&ntm->ntmFontSig, sizeof(ntm->ntmFontSig));
+    HASH_DATA(&type, sizeof(type));
+#undef HASH_DATA
+
+    /* the order of the fonts doesn't matter */
+    *sum += hash;
+    return 1;
+}
+
+static DWORD get_font_list_hash(void)
+{
+    LOGFONTW lf;
+    DWORD sum = 0;
+    HDC hdc;
+
+    memset(&lf, 0, sizeof(lf));
+    lf.lfCharSet = DEFAULT_CHARSET;
+    hdc = GetDC(0);
+    EnumFontFamiliesExW(hdc, &lf, font_index_enum_proc, (LPARAM)&sum, 0);
+    ReleaseDC(0, hdc);
+    return sum;
+}
+
+static DWORD run_font_list_child(const char *argv0)
+{
+    char cmdline[MAX_PATH + 32];
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    DWORD code = 0;
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    sprintf(cmdline, "%s font font_list_hash", argv0);
+    ok(CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info),
+       "CreateProcess failed.\n");
+    wait_child_process(info.hProcess);
+    GetExitCodeProcess(info.hProcess, &code);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+    return code;
+}
+
+/* Wine keeps the properties of the system fonts in an index file, check that
+ * fonts loaded from it look the same as the ones parsed from the font files. */
+static void test_font_index(void)
+{
+    char path[MAX_PATH], **argv;
+    DWORD parsed, indexed;
+
+    winetest_get_mainargs(&argv);
+    GetSystemDirectoryA(path, ARRAY_SIZE(path));
+    strcat(path, "\\wine_fntcache.dat");
+
+    DeleteFileA(path);
+    parsed = run_font_list_child(argv[0]);
+    if (!strcmp(winetest_platform, "wine"))
+        ok(GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES, "font index wasn't written\n");
+
+    indexed = run_font_list_child(argv[0]);
+    ok(indexed == parsed, "got font list hash %#lx with the index, %#lx without\n", indexed, parsed);
+}
+
 static void test_GetOutlineTextMetrics_subst(void)
 {
     OUTLINETEXTMETRICA *otm;
@@ -7782,6 +7858,8 @@ START_TEST(font)
     {
         if (!strcmp(argv[2], "AddFontMemResource"))
             test_AddFontMemResource();
+        else if (!strcmp(argv[2], "font_list_hash"))
+            ExitProcess(get_font_list_hash());
         return;
     }
 
@@ -7853,6 +7931,7 @@ START_TEST(font)
     test_lang_names();
     test_char_width();
     test_select_object();
+    test_font_index();
 
     /* These tests should be last test until RemoveFontResource
      * is properly implemented.
@@ -449,7 +449,7 @@ static HRESULT compile_member_expression(compiler_ctx_t *ctx, member_expression_
     if(FAILED(hres))
         return hres;
 
-    return push_instr_bstr(ctx, OP_member, expr->identifier);
+    return push_instr_bstr_uint(ctx, OP_member, expr->identifier, ~0);
 }
 
 #define LABEL_FLAG 0x80000000
@@ -588,6 +588,7 @@ static void pop_compiler_statement_ctx(compiler_ctx_t *ctx, statement_ctx_t *sta
 
 static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *expr, unsigned flags)
 {
+    unsigned instr;
     HRESULT hres;
 
     if(expr->type == EXPR_IDENT) {
@@ -599,7 +600,13 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
     if(FAILED(hres))
         return hres;
 
-    return push_instr_uint(ctx, OP_memberid, flags);
+    instr = push_instr(ctx, OP_memberid);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].uint = flags;
+    instr_ptr(ctx, instr)->u.arg[1].uint = ~0;
+    return S_OK;
 }
 
 static HRESULT compile_increment_expression(compiler_ctx_t *ctx, unary_expression_t *expr, jsop_t op, int n)
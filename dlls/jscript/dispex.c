@@ -24,6 +24,7 @@
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(jscript);
+WINE_DECLARE_DEBUG_CHANNEL(jscript_gc);
 
 static const GUID GUID_JScriptTypeInfo = {0xc59c6b12,0xf6c1,0x11cf,{0x88,0x35,0x00,0xa0,0xc9,0x11,0xe8,0xb2}};
 
@@ -724,6 +725,13 @@ static void unlink_props(jsdisp_t *jsdisp)
  * This collection process has to be done periodically, but can be pretty expensive so there
  * has to be a balance between reclaiming dangling objects and performance.
  *
+ * To keep the cost down, objects are split into two generations. New objects are put in the
+ * nursery (young_objects), and once enough of them were allocated, only the nursery is collected.
+ * The passes above are then restricted to the marked (young) objects: links from old objects are
+ * never speculatively removed, so they simply count as "external refs" and keep the young objects
+ * they point to alive. This is conservative and needs no write barriers. Survivors are promoted
+ * to the old generation, which is only collected by a full pass over both generations.
+ *
  */
 struct gc_stack_chunk {
     jsdisp_t *objects[1020];
@@ -769,7 +777,9 @@ static jsdisp_t *gc_stack_pop(struct gc_ctx *gc_ctx)
     return obj;
 }
 
-HRESULT gc_run(script_ctx_t *ctx)
+#define GC_NURSERY_SIZE 4096
+
+static HRESULT gc_collect(script_ctx_t *ctx, struct list *objects)
 {
     /* Save original refcounts in a linked list of chunks */
     struct chunk
@@ -780,21 +790,18 @@ HRESULT gc_run(script_ctx_t *ctx)
     jsdisp_t *obj, *obj2, *link, *link2;
     dispex_prop_t *prop, *props_end;
     struct gc_ctx gc_ctx = { 0 };
-    unsigned chunk_idx = 0;
+    unsigned chunk_idx = 0, scanned = 0, collected = 0;
+    DWORD start = GetTickCount();
     HRESULT hres = S_OK;
     struct list *iter;
 
-    /* Prevent recursive calls from side-effects during unlinking (e.g. CollectGarbage from host object's Release) */
-    if(ctx->gc_is_unlinking)
-        return S_OK;
-
     if(!(head = malloc(sizeof(*head))))
         return E_OUTOFMEMORY;
     head->next = NULL;
     chunk = head;
 
     /* 1. Save actual refcounts and decrease them speculatively as-if we unlinked the objects */
-    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+    LIST_FOR_EACH_ENTRY(obj, objects, jsdisp_t, entry) {
         if(chunk_idx == ARRAY_SIZE(chunk->ref)) {
             if(!(chunk->next = malloc(sizeof(*chunk)))) {
                 do {
@@ -809,17 +816,22 @@ HRESULT gc_run(script_ctx_t *ctx)
         }
         chunk->ref[chunk_idx++] = obj->ref;
     }
-    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+    LIST_FOR_EACH_ENTRY(obj, objects, jsdisp_t, entry) {
+        obj->gc_marked = TRUE;
+        scanned++;
+    }
+    LIST_FOR_EACH_ENTRY(obj, objects, jsdisp_t, entry) {
         for(prop = obj->props, props_end = prop + obj->prop_cnt; prop < props_end; prop++) {
             switch(prop->type) {
             case PROP_JSVAL:
-                if(is_object_instance(prop->u.val) && (link = to_jsdisp(get_object(prop->u.val))) && link->ctx == ctx)
+                if(is_object_instance(prop->u.val) && (link = to_jsdisp(get_object(prop->u.val))) && link->ctx == ctx
+                   && link->gc_marked)
                     link->ref--;
                 break;
             case PROP_ACCESSOR:
-                if(prop->u.accessor.getter && prop->u.accessor.getter->ctx == ctx)
+                if(prop->u.accessor.getter && prop->u.accessor.getter->ctx == ctx && prop->u.accessor.getter->gc_marked)
                     prop->u.accessor.getter->ref--;
-                if(prop->u.accessor.setter && prop->u.accessor.setter->ctx == ctx)
+                if(prop->u.accessor.setter && prop->u.accessor.setter->ctx == ctx && prop->u.accessor.setter->gc_marked)
                     prop->u.accessor.setter->ref--;
                 break;
             default:
@@ -827,15 +839,14 @@ HRESULT gc_run(script_ctx_t *ctx)
             }
         }
 
-        if(obj->prototype && obj->prototype->ctx == ctx)
+        if(obj->prototype && obj->prototype->ctx == ctx && obj->prototype->gc_marked)
             obj->prototype->ref--;
         if(obj->builtin_info->gc_traverse)
             obj->builtin_info->gc_traverse(&gc_ctx, GC_TRAVERSE_SPECULATIVELY, obj);
-        obj->gc_marked = TRUE;
     }
 
     /* 2. Clear mark on objects with non-zero "external refcount" and all objects accessible from them */
-    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+    LIST_FOR_EACH_ENTRY(obj, objects, jsdisp_t, entry) {
         if(!obj->ref || !obj->gc_marked)
             continue;
 
@@ -902,8 +913,10 @@ HRESULT gc_run(script_ctx_t *ctx)
 
     /* Restore */
     chunk = head, chunk_idx = 0;
-    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+    LIST_FOR_EACH_ENTRY(obj, objects, jsdisp_t, entry) {
         obj->ref = chunk->ref[chunk_idx++];
+        if(FAILED(hres))
+            obj->gc_marked = FALSE;
         if(chunk_idx == ARRAY_SIZE(chunk->ref)) {
             struct chunk *next = chunk->next;
             free(chunk);
@@ -918,13 +931,14 @@ HRESULT gc_run(script_ctx_t *ctx)
     /* 3. Remove all the links from the marked objects, since they are dangling */
     ctx->gc_is_unlinking = TRUE;
 
-    iter = list_head(&ctx->objects);
+    iter = list_head(objects);
     while(iter) {
         obj = LIST_ENTRY(iter, jsdisp_t, entry);
         if(!obj->gc_marked) {
-            iter = list_next(&ctx->objects, iter);
+            iter = list_next(objects, iter);
             continue;
         }
+        collected++;
 
         /* Grab it since it gets removed when unlinked */
         jsdisp_addref(obj);
@@ -940,15 +954,49 @@ HRESULT gc_run(script_ctx_t *ctx)
 
         /* Releasing unlinked object should not delete any other object,
            so we can safely obtain the next pointer now */
-        iter = list_next(&ctx->objects, iter);
+        obj->gc_marked = FALSE;
+        iter = list_next(objects, iter);
         jsdisp_release(obj);
     }
 
     ctx->gc_is_unlinking = FALSE;
-    ctx->gc_last_tick = GetTickCount();
+
+    TRACE_(jscript_gc)("%s: scanned %u, collected %u, %u old objects, pause %lu ms\n",
+                       objects == &ctx->young_objects ? "nursery" : "full", scanned, collected,
+                       list_count(&ctx->objects), GetTickCount() - start);
     return S_OK;
 }
 
+/* Collects only the objects allocated since the last collection and promotes the survivors. */
+static HRESULT gc_run_nursery(script_ctx_t *ctx)
+{
+    HRESULT hres;
+
+    if(ctx->gc_is_unlinking)
+        return S_OK;
+
+    ctx->gc_young_cnt = 0;
+    hres = gc_collect(ctx, &ctx->young_objects);
+    list_move_tail(&ctx->objects, &ctx->young_objects);
+    return hres;
+}
+
+HRESULT gc_run(script_ctx_t *ctx)
+{
+    HRESULT hres;
+
+    /* Prevent recursive calls from side-effects during unlinking (e.g. CollectGarbage from host object's Release) */
+    if(ctx->gc_is_unlinking)
+        return S_OK;
+
+    ctx->gc_young_cnt = 0;
+    list_move_tail(&ctx->objects, &ctx->young_objects);
+    hres = gc_collect(ctx, &ctx->objects);
+    if(SUCCEEDED(hres))
+        ctx->gc_last_tick = GetTickCount();
+    return hres;
+}
+
 HRESULT gc_process_linked_obj(struct gc_ctx *gc_ctx, enum gc_traverse_op op, jsdisp_t *obj, jsdisp_t *link, void **unlink_ref)
 {
     if(op == GC_TRAVERSE_UNLINK) {
@@ -957,11 +1005,11 @@ HRESULT gc_process_linked_obj(struct gc_ctx *gc_ctx, enum gc_traverse_op op, jsd
         return S_OK;
     }
 
-    if(link->ctx != obj->ctx)
+    if(link->ctx != obj->ctx || !link->gc_marked)
         return S_OK;
     if(op == GC_TRAVERSE_SPECULATIVELY)
         link->ref--;
-    else if(link->gc_marked)
+    else
         return gc_stack_push(gc_ctx, link);
     return S_OK;
 }
@@ -977,11 +1025,12 @@ HRESULT gc_process_linked_val(struct gc_ctx *gc_ctx, enum gc_traverse_op op, jsd
         return S_OK;
     }
 
-    if(!is_object_instance(*link) || !(jsdisp = to_jsdisp(get_object(*link))) || jsdisp->ctx != obj->ctx)
+    if(!is_object_instance(*link) || !(jsdisp = to_jsdisp(get_object(*link))) || jsdisp->ctx != obj->ctx
+       || !jsdisp->gc_marked)
         return S_OK;
     if(op == GC_TRAVERSE_SPECULATIVELY)
         jsdisp->ref--;
-    else if(jsdisp->gc_marked)
+    else
         return gc_stack_push(gc_ctx, jsdisp);
     return S_OK;
 }
@@ -2160,6 +2209,8 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
     /* FIXME: Use better heuristics to decide when to run the GC */
     if(GetTickCount() - ctx->gc_last_tick > 30000)
         gc_run(ctx);
+    else if(ctx->gc_young_cnt >= GC_NURSERY_SIZE)
+        gc_run_nursery(ctx);
 
     TRACE("%p (%p)\n", dispex, prototype);
 
@@ -2167,6 +2218,7 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
     dispex->ref = 1;
     dispex->builtin_info = builtin_info;
     dispex->extensible = TRUE;
+    dispex->gc_marked = FALSE;
     dispex->prop_cnt = 0;
 
     dispex->props = calloc(1, sizeof(dispex_prop_t)*(dispex->buf_size=4));
@@ -2185,7 +2237,8 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
     script_addref(ctx);
     dispex->ctx = ctx;
 
-    list_add_tail(&ctx->objects, &dispex->entry);
+    list_add_tail(&ctx->young_objects, &dispex->entry);
+    ctx->gc_young_cnt++;
     return S_OK;
 }
 
@@ -2333,6 +2386,35 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/*
+ * Like jsdisp_get_id, but first tries the property index remembered in *cache.
+ * Objects created by the same code tend to get their properties in the same
+ * order, so an index found on one object is a good guess for the next one.
+ * The guess is verified against the name, so the cache never needs to be
+ * invalidated; a wrong guess just falls back to the hash lookup.
+ */
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, unsigned *cache, DISPID *id)
+{
+    dispex_prop_t *prop;
+    HRESULT hres;
+
+    if(*cache < jsdisp->prop_cnt && !(flags & fdexNameCaseInsensitive)) {
+        prop = &jsdisp->props[*cache];
+        if(prop->type != PROP_DELETED && !wcscmp(prop->name, name)) {
+            fix_protref_prop(jsdisp, prop);
+            if(prop->type != PROP_DELETED) {
+                *id = prop_to_id(jsdisp, prop);
+                return S_OK;
+            }
+        }
+    }
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(SUCCEEDED(hres))
+        *cache = *id - 1;
+    return hres;
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, jsval_t vthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
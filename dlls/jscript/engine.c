@@ -543,6 +543,22 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
     return hres;
 }
 
+/* Member lookup for an instruction with a property index cache slot. */
+static HRESULT disp_get_member_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr,
+        DWORD flags, unsigned *cache, DISPID *id)
+{
+    jsdisp_t *jsdisp;
+    HRESULT hres;
+
+    jsdisp = iface_to_jsdisp(disp);
+    if(!jsdisp)
+        return disp_get_id(ctx, disp, name, name_bstr, flags, id);
+
+    hres = jsdisp_get_id_cached(jsdisp, name, flags, cache, id);
+    jsdisp_release(jsdisp);
+    return hres;
+}
+
 static HRESULT disp_cmp(IDispatch *disp1, IDispatch *disp2, BOOL *ret)
 {
     IObjectIdentity *identity;
@@ -847,6 +863,12 @@ static inline unsigned get_op_uint(script_ctx_t *ctx, int i)
     return frame->bytecode->instrs[frame->ip].u.arg[i].uint;
 }
 
+static inline unsigned *get_op_cache(script_ctx_t *ctx, int i)
+{
+    call_frame_t *frame = ctx->call_ctx;
+    return &frame->bytecode->instrs[frame->ip].u.arg[i].uint;
+}
+
 static inline unsigned get_op_int(script_ctx_t *ctx, int i)
 {
     call_frame_t *frame = ctx->call_ctx;
@@ -1321,7 +1343,7 @@ static HRESULT interp_member(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, arg, arg, 0, &id);
+    hres = disp_get_member_id(ctx, obj, arg, arg, 0, get_op_cache(ctx, 1), &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -1363,7 +1385,7 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
+    hres = disp_get_member_id(ctx, obj, name, NULL, arg, get_op_cache(ctx, 1), &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         ref.type = EXPRVAL_IDREF;
@@ -55,8 +55,8 @@
     X(lshift,     1, 0,0)                  \
     X(lt,         1, 0,0)                  \
     X(lteq,       1, 0,0)                  \
-    X(member,     1, ARG_BSTR,   0)        \
-    X(memberid,   1, ARG_UINT,   0)        \
+    X(member,     1, ARG_BSTR,   ARG_UINT) \
+    X(memberid,   1, ARG_UINT,   ARG_UINT) \
     X(minus,      1, 0,0)                  \
     X(mod,        1, 0,0)                  \
     X(mul,        1, 0,0)                  \
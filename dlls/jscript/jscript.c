@@ -748,6 +748,7 @@ static HRESULT WINAPI JScript_SetScriptSite(IActiveScript *iface,
         ctx->acc = jsval_undefined();
         list_init(&ctx->named_items);
         list_init(&ctx->objects);
+        list_init(&ctx->young_objects);
         heap_pool_init(&ctx->tmp_heap);
 
         hres = create_jscaller(ctx);
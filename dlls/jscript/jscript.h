@@ -254,6 +254,7 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_id_cached(jsdisp_t*,const WCHAR*,DWORD,unsigned*,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -369,6 +370,7 @@ struct _script_ctx_t {
     struct _call_frame_t *call_ctx;
     struct list named_items;
     struct list objects;
+    struct list young_objects;
     IActiveScriptSite *site;
     IInternetHostSecurityManager *secmgr;
     DWORD safeopt;
@@ -383,6 +385,7 @@ struct _script_ctx_t {
 
     BOOL gc_is_unlinking;
     DWORD gc_last_tick;
+    unsigned gc_young_cnt;
 
     jsval_t *stack;
     unsigned stack_top;
@@ -2017,6 +2017,65 @@ ok(tmp, "tmp = " + tmp);
     ok(x === undefined, "x = " + x);
 })();
 
+(function() {
+    /* the same member access sites used on objects with different layouts */
+    function Proto() {}
+    Proto.prototype.p = "proto";
+
+    var objs = [ {a: 1, b: 2}, {b: 3, a: 4}, {x: 0, a: 5}, new Proto(), {a: 6, p: "own"} ], i, r = "";
+
+    function get_a(o) { return o.a; }
+    function get_p(o) { return o.p; }
+    function set_b(o, v) { o.b = v; }
+
+    for(i = 0; i < objs.length; i++)
+        r += get_a(objs[i]) + ",";
+    ok(r === "1,4,5,undefined,6,", "r = " + r);
+
+    ok(get_p(objs[3]) === "proto", "get_p(objs[3]) = " + get_p(objs[3]));
+    ok(get_p(objs[4]) === "own", "get_p(objs[4]) = " + get_p(objs[4]));
+    Proto.prototype.p = "changed";
+    ok(get_p(objs[3]) === "changed", "get_p(objs[3]) = " + get_p(objs[3]));
+    delete Proto.prototype.p;
+    ok(get_p(objs[3]) === undefined, "get_p(objs[3]) = " + get_p(objs[3]));
+
+    delete objs[0].a;
+    ok(get_a(objs[0]) === undefined, "get_a(objs[0]) = " + get_a(objs[0]));
+    objs[0].a = 7;
+    ok(get_a(objs[0]) === 7, "get_a(objs[0]) = " + get_a(objs[0]));
+
+    for(i = 0; i < objs.length; i++)
+        set_b(objs[i], i);
+    r = "";
+    for(i = 0; i < objs.length; i++)
+        r += objs[i].b + ",";
+    ok(r === "0,1,2,3,4,", "r = " + r);
+})();
+
+(function() {
+    /* objects reachable from older objects survive collections triggered by allocations */
+    var holder = { x: { y: 1 } }, i, tmp;
+
+    holder.x.back = holder;
+    function alloc_cycles(n) {
+        for(i = 0; i < n; i++) {
+            tmp = { i: i };
+            tmp.self = tmp;
+        }
+    }
+
+    alloc_cycles(20000);
+    holder.child = { v: 2 };
+    holder.child.parent = holder;
+    alloc_cycles(20000);
+
+    ok(holder.x.y === 1, "holder.x.y = " + holder.x.y);
+    ok(holder.x.back === holder, "holder.x.back !== holder");
+    ok(holder.child.v === 2, "holder.child.v = " + holder.child.v);
+    ok(holder.child.parent === holder, "holder.child.parent !== holder");
+    ok(tmp.self === tmp, "tmp.self !== tmp");
+})();
+
 var get, set;
 
 /* NoNewline rule parser tests */
@@ -1311,6 +1311,57 @@ static void test_dbcs_to_widechar(void)
     }
 }
 
+static void test_utf8_ascii_runs(void)
+{
+    static const char utf8[] = "abcdefghijklmnopqrstuvwxyz0123456789\xc3\xa9" "ABCDEFGHIJKLMNOP"
+                               "\xe2\x82\xac" "qrstuvwxyz\xf0\x9f\x98\x80" "abcdefghijklmnopqrstuvwxyz";
+    char buffer[sizeof(utf8) + 8], out[sizeof(utf8) + 8];
+    WCHAR wbuf[sizeof(utf8) + 8], expect[sizeof(utf8)];
+    int i, len, wlen, expect_len, ret;
+
+    expect_len = MultiByteToWideChar(CP_UTF8, 0, utf8, -1, expect, ARRAY_SIZE(expect));
+    ok(expect_len == 93, "got %d\n", expect_len);
+    ok(expect[36] == 0xe9, "got %#x\n", expect[36]);
+    ok(expect[53] == 0x20ac, "got %#x\n", expect[53]);
+    ok(expect[64] == 0xd83d && expect[65] == 0xde00, "got %#x %#x\n", expect[64], expect[65]);
+
+    /* conversions should not depend on the alignment of the buffers */
+    for (i = 0; i < 8; i++)
+    {
+        memcpy(buffer + i, utf8, sizeof(utf8));
+        wlen = MultiByteToWideChar(CP_UTF8, 0, buffer + i, -1, NULL, 0);
+        ok(wlen == expect_len, "%d: got %d\n", i, wlen);
+        memset(wbuf, 0xcc, sizeof(wbuf));
+        wlen = MultiByteToWideChar(CP_UTF8, 0, buffer + i, -1, wbuf + i % 4, ARRAY_SIZE(wbuf) - 4);
+        ok(wlen == expect_len, "%d: got %d\n", i, wlen);
+        ok(!memcmp(wbuf + i % 4, expect, expect_len * sizeof(WCHAR)), "%d: got %s\n", i,
+           wine_dbgstr_wn(wbuf + i % 4, wlen));
+
+        len = WideCharToMultiByte(CP_UTF8, 0, wbuf + i % 4, -1, NULL, 0, NULL, NULL);
+        ok(len == sizeof(utf8), "%d: got %d\n", i, len);
+        memset(out, 0xcc, sizeof(out));
+        len = WideCharToMultiByte(CP_UTF8, 0, wbuf + i % 4, -1, out + i, sizeof(out) - 8, NULL, NULL);
+        ok(len == sizeof(utf8), "%d: got %d\n", i, len);
+        ok(!memcmp(out + i, utf8, sizeof(utf8)), "%d: got %s\n", i, debugstr_an(out + i, len));
+
+        /* invalid byte in the middle of an ASCII run */
+        buffer[i + 8] = 0x80;
+        wlen = MultiByteToWideChar(CP_UTF8, 0, buffer + i, -1, wbuf, ARRAY_SIZE(wbuf));
+        ok(wlen == expect_len, "%d: got %d\n", i, wlen);
+        ok(wbuf[7] == 'h' && wbuf[8] == 0xfffd && wbuf[9] == 'j', "%d: got %s\n", i, wine_dbgstr_wn(wbuf, wlen));
+
+        /* destination too small */
+        SetLastError(0xdeadbeef);
+        ret = MultiByteToWideChar(CP_UTF8, 0, buffer + i, -1, wbuf, 20);
+        ok(!ret, "%d: got %d\n", i, ret);
+        ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "%d: got error %lu\n", i, GetLastError());
+        SetLastError(0xdeadbeef);
+        ret = WideCharToMultiByte(CP_UTF8, 0, expect, -1, out, 30, NULL, NULL);
+        ok(!ret, "%d: got %d\n", i, ret);
+        ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "%d: got error %lu\n", i, GetLastError());
+    }
+}
+
 START_TEST(codepage)
 {
     BOOL bUsedDefaultChar;
@@ -1333,4 +1384,5 @@ START_TEST(codepage)
     test_threadcp();
 
     test_dbcs_to_widechar();
+    test_utf8_ascii_runs();
 }
@@ -3839,6 +3839,57 @@ static void test_unicode_sorting(void)
     ok(ret1 == ret2, "Got ret1=%d, ret2=%d\n", ret1, ret2);
 }
 
+static void test_CompareStringEx_prefix(void)
+{
+    static const WCHAR chars[] = L"aAbBcheE\x00e9\x0301\x0300-' 1.";
+    static const DWORD flags[] = { 0, NORM_IGNORECASE, NORM_IGNORENONSPACE, NORM_IGNORESYMBOLS, SORT_STRINGSORT };
+    static const WCHAR *locales[] = { L"en-US", L"fr-FR", L"cs-CZ", L"sv-SE" };
+    BYTE key1[256], key2[256];
+    WCHAR str1[16], str2[16];
+    unsigned int seed = 0x1234;
+    int i, j, len1, len2, prefix, ret, expect, keylen1, keylen2;
+
+    if (!pLCMapStringEx || !pCompareStringEx)
+    {
+        win_skip("LCMapStringEx or CompareStringEx not available\n");
+        return;
+    }
+
+    /* CompareStringEx must give the same result as comparing sort keys, also when
+     * the strings share a common prefix */
+    for (i = 0; i < 4000; i++)
+    {
+        const WCHAR *locale = locales[i % ARRAY_SIZE(locales)];
+        DWORD flag = flags[(i / ARRAY_SIZE(locales)) % ARRAY_SIZE(flags)];
+
+        seed = seed * 1103515245 + 12345;
+        len1 = (seed >> 16) % 10;
+        prefix = len1 ? (seed >> 8) % (len1 + 1) : 0;
+        len2 = prefix + (seed >> 4) % 4;
+        for (j = 0; j < len1; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            str1[j] = chars[(seed >> 16) % (ARRAY_SIZE(chars) - 1)];
+        }
+        memcpy(str2, str1, prefix * sizeof(WCHAR));
+        for (j = prefix; j < len2; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            str2[j] = chars[(seed >> 16) % (ARRAY_SIZE(chars) - 1)];
+        }
+
+        keylen1 = pLCMapStringEx(locale, LCMAP_SORTKEY | flag, str1, len1, (WCHAR *)key1, sizeof(key1), NULL, NULL, 0);
+        keylen2 = pLCMapStringEx(locale, LCMAP_SORTKEY | flag, str2, len2, (WCHAR *)key2, sizeof(key2), NULL, NULL, 0);
+        ret = memcmp(key1, key2, min(keylen1, keylen2));
+        if (!ret) ret = keylen1 - keylen2;
+        expect = ret < 0 ? CSTR_LESS_THAN : ret > 0 ? CSTR_GREATER_THAN : CSTR_EQUAL;
+
+        ret = pCompareStringEx(locale, flag, str1, len1, str2, len2, NULL, NULL, 0);
+        ok(ret == expect, "%s %#lx: %s vs %s: got %d, expected %d\n", wine_dbgstr_w(locale), flag,
+           wine_dbgstr_wn(str1, len1), wine_dbgstr_wn(str2, len2), ret, expect);
+    }
+}
+
 static void test_FoldStringA(void)
 {
   int ret, i, j;
@@ -8469,6 +8520,7 @@ START_TEST(locale)
   test_geo_name();
   test_sorting();
   test_unicode_sorting();
+  test_CompareStringEx_prefix();
   test_EnumCalendarInfoA();
   test_EnumCalendarInfoW();
   test_EnumCalendarInfoExA();
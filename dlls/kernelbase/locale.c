@@ -3817,6 +3817,27 @@ static int get_sortkey( const struct sortguid *sortid, DWORD flags,
 }
 
 
+/* get the length of the common prefix that can be skipped when comparing strings */
+/* only chars with plain 2-byte primary weights that don't interact with their neighbours are skipped */
+static int get_common_prefix( const struct sortguid *sortid, DWORD flags, UINT except,
+                              const WCHAR *src1, int srclen1, const WCHAR *src2, int srclen2 )
+{
+    union char_weights weights;
+    int i, len = min( srclen1, srclen2 );
+
+    if (sortid->flags & FLAG_REVERSEDIACRITICS) return 0;
+
+    for (i = 0; i < len && src1[i] == src2[i]; i++)
+    {
+        weights = get_char_weights( src1[i], except );
+        if (weights._case & CASE_COMPR_6) break;
+        if (weights.script < SCRIPT_DIGIT || weights.script >= SCRIPT_PUA_FIRST) break;
+        if (weights.script == SCRIPT_DIGIT && (flags & SORT_DIGITSASNUMBERS)) break;
+    }
+    /* keep the last char, a following nonspace mark changes its diacritic weight */
+    return max( i - 1, 0 );
+}
+
 /* implementation of CompareStringEx */
 static int compare_string( const struct sortguid *sortid, DWORD flags,
                            const WCHAR *src1, int srclen1, const WCHAR *src2, int srclen2 )
@@ -3825,7 +3846,7 @@ static int compare_string( const struct sortguid *sortid, DWORD flags,
     struct sortkey_state s2;
     BYTE primary1[32];
     BYTE primary2[32];
-    int i, ret, len, pos1 = 0, pos2 = 0;
+    int i, ret, len, prefix, pos1, pos2;
     BOOL have_extra1, have_extra2;
     BYTE case_mask = 0x3f;
     UINT except = sortid->except;
@@ -3837,9 +3858,16 @@ static int compare_string( const struct sortguid *sortid, DWORD flags,
     if (flags & NORM_IGNOREKANATYPE) case_mask &= ~CASE_KATAKANA;
     if ((flags & NORM_LINGUISTIC_CASING) && except && sortid->ling_except) except = sortid->ling_except;
 
+    if (srclen1 == srclen2 && !memcmp( src1, src2, srclen1 * sizeof(WCHAR) )) return 0;
+
     init_sortkey_state( &s1, flags, srclen1, primary1, sizeof(primary1) );
     init_sortkey_state( &s2, flags, srclen2, primary2, sizeof(primary2) );
 
+    /* the skipped chars would add the same weights to both strings */
+    prefix = get_common_prefix( sortid, flags, except, src1, srclen1, src2, srclen2 );
+    pos1 = pos2 = prefix;
+    s1.primary_pos = s2.primary_pos = prefix * 2;
+
     while (pos1 < srclen1 || pos2 < srclen2)
     {
         while (pos1 < srclen1 && !s1.key_primary.len)
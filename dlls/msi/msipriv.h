@@ -226,7 +226,7 @@ typedef struct _column_info
     struct _column_info *next;
 } column_info;
 
-typedef const struct tagMSICOLUMNHASHENTRY *MSIITERHANDLE;
+typedef const struct column_hash_entry *MSIITERHANDLE;
 
 typedef struct tagMSIVIEWOPS
 {
@@ -347,6 +347,18 @@ typedef struct tagMSIVIEWOPS
      * drop - drops the table from the database
      */
     UINT (*drop)( struct tagMSIVIEW *view );
+
+    /*
+     * find_matching_rows - iterates through rows that match a value
+     *
+     * If the value is found then ERROR_SUCCESS is returned and the row
+     *  is stored in *row. *handle must be NULL on the first call and is
+     *  updated so that subsequent calls return the following matches.
+     *  The rows are returned in ascending order.
+     * If the value isn't found (or no more rows match) then
+     *  ERROR_NO_MORE_ITEMS is returned.
+     */
+    UINT (*find_matching_rows)( struct tagMSIVIEW *view, UINT col, UINT val, UINT *row, MSIITERHANDLE *handle );
 } MSIVIEWOPS;
 
 struct tagMSIVIEW
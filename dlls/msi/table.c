@@ -39,12 +39,22 @@
 WINE_DEFAULT_DEBUG_CHANNEL(msidb);
 
 #define MSITABLE_HASH_TABLE_SIZE 37
+#define NO_HASH_ROW (~0u)
 
 struct column_hash_entry
 {
-    struct column_hash_entry *next;
+    UINT next; /* next row in the same bucket */
     UINT value;
-    UINT row;
+};
+
+/* index of a column, entries are indexed by row */
+struct column_hash
+{
+    UINT size;
+    UINT count;
+    UINT capacity;
+    UINT *buckets;
+    struct column_hash_entry *entries;
 };
 
 struct column_info
@@ -54,7 +64,7 @@ struct column_info
     LPCWSTR colname;
     UINT    type;
     UINT    offset;
-    struct column_hash_entry **hash_table;
+    struct column_hash *hash_table;
 };
 
 struct tagMSITABLE
@@ -355,10 +365,102 @@ end:
     return ret;
 }
 
+static void free_column_hash( struct column_hash *hash )
+{
+    if (!hash) return;
+    free( hash->buckets );
+    free( hash->entries );
+    free( hash );
+}
+
+/* chains are kept in row order so that matches are returned in table order */
+static void column_hash_link( struct column_hash *hash, UINT row )
+{
+    UINT *ptr = &hash->buckets[hash->entries[row].value % hash->size];
+
+    while (*ptr != NO_HASH_ROW && *ptr < row) ptr = &hash->entries[*ptr].next;
+    hash->entries[row].next = *ptr;
+    *ptr = row;
+}
+
+static void column_hash_unlink( struct column_hash *hash, UINT row )
+{
+    UINT *ptr = &hash->buckets[hash->entries[row].value % hash->size];
+
+    while (*ptr != row) ptr = &hash->entries[*ptr].next;
+    *ptr = hash->entries[row].next;
+}
+
+static BOOL column_hash_resize( struct column_hash *hash, UINT size )
+{
+    UINT i, *buckets;
+
+    if (!(buckets = malloc( size * sizeof(*buckets) ))) return FALSE;
+    for (i = 0; i < size; i++) buckets[i] = NO_HASH_ROW;
+
+    free( hash->buckets );
+    hash->buckets = buckets;
+    hash->size = size;
+
+    /* linking back to front only ever prepends to the chains */
+    for (i = hash->count; i > 0; i--) column_hash_link( hash, i - 1 );
+    return TRUE;
+}
+
+/* renumber the rows from the given one on after a row has been inserted or removed */
+static void column_hash_shift( struct column_hash *hash, UINT row, int delta )
+{
+    UINT i;
+
+    for (i = 0; i < hash->size; i++)
+        if (hash->buckets[i] != NO_HASH_ROW && hash->buckets[i] >= row) hash->buckets[i] += delta;
+    for (i = 0; i < hash->count; i++)
+        if (hash->entries[i].next != NO_HASH_ROW && hash->entries[i].next >= row) hash->entries[i].next += delta;
+}
+
+static BOOL column_hash_insert( struct column_hash *hash, UINT row, UINT value )
+{
+    struct column_hash_entry *entries;
+
+    if (row > hash->count) return FALSE;
+    if (hash->count == hash->capacity)
+    {
+        if (!(entries = realloc( hash->entries, hash->capacity * 2 * sizeof(*entries) ))) return FALSE;
+        hash->entries = entries;
+        hash->capacity *= 2;
+    }
+
+    column_hash_shift( hash, row, 1 );
+    memmove( &hash->entries[row + 1], &hash->entries[row], (hash->count - row) * sizeof(*hash->entries) );
+    hash->count++;
+    hash->entries[row].value = value;
+    column_hash_link( hash, row );
+
+    /* keep the chains short, the old buckets stay valid if this fails */
+    if (hash->count > hash->size * 2) column_hash_resize( hash, hash->size * 2 + 1 );
+    return TRUE;
+}
+
+static void column_hash_remove( struct column_hash *hash, UINT row )
+{
+    column_hash_unlink( hash, row );
+    memmove( &hash->entries[row], &hash->entries[row + 1], (hash->count - row - 1) * sizeof(*hash->entries) );
+    hash->count--;
+    column_hash_shift( hash, row + 1, -1 );
+}
+
+static void column_hash_set( struct column_hash *hash, UINT row, UINT value )
+{
+    if (hash->entries[row].value == value) return;
+    column_hash_unlink( hash, row );
+    hash->entries[row].value = value;
+    column_hash_link( hash, row );
+}
+
 static void free_colinfo( struct column_info *colinfo, UINT count )
 {
     UINT i;
-    for (i = 0; i < count; i++) free( colinfo[i].hash_table );
+    for (i = 0; i < count; i++) free_column_hash( colinfo[i].hash_table );
 }
 
 static void free_table( MSITABLE *table )
@@ -1155,9 +1257,18 @@ static UINT TABLE_fetch_stream( struct tagMSIVIEW *view, UINT row, UINT col, ISt
     return r;
 }
 
+/* Indexes live on the table, so every view of it shares them. Columns
+ * that a transform view adds to its private column array have none. */
+static struct column_hash **get_column_hash( struct table_view *tv, UINT col )
+{
+    if (!tv->table || !col || col > tv->table->col_count) return NULL;
+    return &tv->table->colinfo[col - 1].hash_table;
+}
+
 /* Set a table value, i.e. preadjusted integer or string ID. */
 static UINT table_set_bytes( struct table_view *tv, UINT row, UINT col, UINT val )
 {
+    struct column_hash **hash;
     UINT offset, n, i;
 
     if( !tv->table )
@@ -1176,9 +1287,6 @@ static UINT table_set_bytes( struct table_view *tv, UINT row, UINT col, UINT val
         return ERROR_FUNCTION_FAILED;
     }
 
-    free( tv->columns[col-1].hash_table );
-    tv->columns[col-1].hash_table = NULL;
-
     n = bytes_per_column( tv->db, &tv->columns[col - 1], LONG_STR_BYTES );
     if ( n != 2 && n != 3 && n != 4 )
     {
@@ -1190,6 +1298,17 @@ static UINT table_set_bytes( struct table_view *tv, UINT row, UINT col, UINT val
     for ( i = 0; i < n; i++ )
         tv->table->data[row][offset + i] = (val >> i * 8) & 0xff;
 
+    if ((hash = get_column_hash( tv, col )) && *hash)
+    {
+        if (row < (*hash)->count)
+            column_hash_set( *hash, row, read_table_int( tv->table->data, row, offset, n ) );
+        else
+        {
+            free_column_hash( *hash );
+            *hash = NULL;
+        }
+    }
+
     return ERROR_SUCCESS;
 }
 
@@ -1472,6 +1591,43 @@ static UINT TABLE_set_row( struct tagMSIVIEW *view, UINT row, MSIRECORD *rec, UI
     return r;
 }
 
+/* add the row that was just inserted to the indexes */
+static void insert_hash_row( struct table_view *tv, UINT row )
+{
+    struct column_hash **hash;
+    UINT i, val;
+
+    for (i = 1; i <= tv->num_cols; i++)
+    {
+        if (!(hash = get_column_hash( tv, i )) || !*hash) continue;
+
+        if (TABLE_fetch_int( &tv->view, row, i, &val ) || !column_hash_insert( *hash, row, val ))
+        {
+            free_column_hash( *hash );
+            *hash = NULL;
+        }
+    }
+}
+
+static void delete_hash_row( struct table_view *tv, UINT row )
+{
+    struct column_hash **hash;
+    UINT i;
+
+    for (i = 1; i <= tv->num_cols; i++)
+    {
+        if (!(hash = get_column_hash( tv, i )) || !*hash) continue;
+
+        if (row < (*hash)->count)
+            column_hash_remove( *hash, row );
+        else
+        {
+            free_column_hash( *hash );
+            *hash = NULL;
+        }
+    }
+}
+
 static UINT table_create_new_row( struct tagMSIVIEW *view, UINT *num, BOOL temporary )
 {
     struct table_view *tv = (struct table_view *)view;
@@ -1735,6 +1891,8 @@ static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row,
 
     /* Re-set the persistence flag */
     tv->table->data_persistent[row] = !temporary;
+
+    insert_hash_row( tv, row );
     return TABLE_set_row( view, row, rec, (1<<tv->num_cols) - 1 );
 }
 
@@ -1758,12 +1916,7 @@ static UINT TABLE_delete_row( struct tagMSIVIEW *view, UINT row )
     num_rows = tv->table->row_count;
     tv->table->row_count--;
 
-    /* reset the hash tables */
-    for (i = 0; i < tv->num_cols; i++)
-    {
-        free(tv->columns[i].hash_table);
-        tv->columns[i].hash_table = NULL;
-    }
+    delete_hash_row( tv, row );
 
     for (i = row + 1; i < num_rows; i++)
     {
@@ -1947,6 +2100,7 @@ static UINT TABLE_remove_column(struct tagMSIVIEW *view, UINT number)
     if (tv->table->colinfo[number-1].type & MSITYPE_TEMPORARY)
     {
         UINT size = tv->table->colinfo[number-1].offset;
+        free_column_hash( tv->table->colinfo[number-1].hash_table );
         tv->table->col_count--;
         tv->table->colinfo = realloc(tv->table->colinfo, sizeof(*tv->table->colinfo) * tv->table->col_count);
 
@@ -2165,6 +2319,78 @@ done:
     return r;
 }
 
+static UINT build_hash_table( struct table_view *tv, UINT col, struct column_hash **ret )
+{
+    struct column_hash *hash;
+    UINT i, r, size = MSITABLE_HASH_TABLE_SIZE, num_rows = tv->table->row_count;
+
+    if (!(hash = calloc( 1, sizeof(*hash) )))
+        return ERROR_OUTOFMEMORY;
+
+    hash->capacity = max( num_rows, 16 );
+    if (!(hash->entries = malloc( hash->capacity * sizeof(*hash->entries) )))
+    {
+        free( hash );
+        return ERROR_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < num_rows; i++)
+    {
+        if ((r = TABLE_fetch_int( &tv->view, i, col, &hash->entries[i].value )))
+        {
+            free_column_hash( hash );
+            return r;
+        }
+    }
+    hash->count = num_rows;
+
+    while (size < num_rows) size = size * 2 + 1;
+    if (!column_hash_resize( hash, size ))
+    {
+        free_column_hash( hash );
+        return ERROR_OUTOFMEMORY;
+    }
+
+    *ret = hash;
+    return ERROR_SUCCESS;
+}
+
+static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col, UINT val, UINT *row,
+                                      MSIITERHANDLE *handle )
+{
+    struct table_view *tv = (struct table_view *)view;
+    struct column_hash **slot;
+    const struct column_hash *hash;
+    UINT r, next;
+
+    TRACE("%p, %u, %u, %p\n", view, col, val, *handle);
+
+    if (!col || col > tv->num_cols || !(slot = get_column_hash( tv, col )))
+        return ERROR_INVALID_PARAMETER;
+
+    if (!*slot && (r = build_hash_table( tv, col, slot )))
+        return r;
+    hash = *slot;
+
+    if (!*handle)
+        next = hash->buckets[val % hash->size];
+    else
+        next = (*handle)->next;
+
+    while (next != NO_HASH_ROW && hash->entries[next].value != val)
+        next = hash->entries[next].next;
+
+    if (next == NO_HASH_ROW)
+    {
+        *handle = NULL;
+        return ERROR_NO_MORE_ITEMS;
+    }
+
+    *handle = &hash->entries[next];
+    *row = next;
+    return ERROR_SUCCESS;
+}
+
 static const MSIVIEWOPS table_ops =
 {
     TABLE_fetch_int,
@@ -2186,6 +2412,7 @@ static const MSIVIEWOPS table_ops =
     TABLE_add_column,
     NULL,
     TABLE_drop,
+    TABLE_find_matching_rows,
 };
 
 UINT TABLE_CreateView( MSIDATABASE *db, LPCWSTR name, MSIVIEW **view )
@@ -2771,7 +2998,7 @@ UINT TransformView_Create( MSIDATABASE *db, string_table *st, LPCWSTR name, MSIV
     static const WCHAR query_sfx[] = L"' AND `Row` IS NULL AND `Current` IS NOT NULL AND `new` = 1";
 
     WCHAR buf[256], *query = buf;
-    UINT r, len, name_len, size, add_col;
+    UINT r, len, name_len, size, add_col, i;
     struct column_info *colinfo;
     struct table_view *tv;
     MSIRECORD *rec;
@@ -2881,6 +3108,8 @@ UINT TransformView_Create( MSIDATABASE *db, string_table *st, LPCWSTR name, MSIV
     msiobj_release( &q->hdr );
 
     memcpy( colinfo, tv->columns, tv->num_cols * sizeof(*colinfo) );
+    /* the indexes stay with the table */
+    for (i = 0; i < tv->num_cols; i++) colinfo[i].hash_table = NULL;
     tv->columns = colinfo;
     tv->num_cols += add_col;
     return ERROR_SUCCESS;
@@ -3151,11 +3380,35 @@ static UINT row_matches( struct table_view *tv, UINT row, const UINT *data, UINT
 
 static UINT table_find_row( struct table_view *tv, MSIRECORD *rec, UINT *row, UINT *column )
 {
-    UINT i, r = ERROR_FUNCTION_FAILED, *data;
+    MSIITERHANDLE handle = NULL;
+    UINT i, key, ret, r = ERROR_FUNCTION_FAILED, *data;
 
     data = record_to_row( tv, rec );
     if( !data )
         return r;
+
+    /* only rows sharing the first key value can match */
+    for (key = 0; key < tv->num_cols; key++)
+        if (tv->columns[key].type & MSITYPE_KEY) break;
+
+    if (key < tv->num_cols)
+    {
+        while (!(ret = TABLE_find_matching_rows( &tv->view, key + 1, data[key], &i, &handle )))
+        {
+            r = row_matches( tv, i, data, column );
+            if (r == ERROR_SUCCESS)
+            {
+                *row = i;
+                break;
+            }
+        }
+        if (ret == ERROR_SUCCESS || ret == ERROR_NO_MORE_ITEMS)
+        {
+            free( data );
+            return r;
+        }
+    }
+
     for( i = 0; i < tv->table->row_count; i++ )
     {
         r = row_matches( tv, i, data, column );
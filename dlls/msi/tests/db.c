@@ -9376,6 +9376,124 @@ static void test_viewfetch_wraparound(void)
     DeleteFileA(msifile);
 }
 
+static void test_indexed_lookup(void)
+{
+    MSIHANDLE hdb, hview, hrec;
+    char query[MAX_PATH];
+    UINT r, i;
+
+    hdb = create_db();
+    ok(hdb, "failed to create db\n");
+
+    r = run_query(hdb, 0, "CREATE TABLE `Indexed` (`Name` CHAR(72) NOT NULL, `Num` SHORT NOT NULL, "
+                          "`Value` LONG PRIMARY KEY `Name`, `Num`)");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    r = run_query(hdb, 0, "CREATE TABLE `Ref` (`Id` SHORT NOT NULL, `Name_` CHAR(72) PRIMARY KEY `Id`)");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    for (i = 0; i < 100; i++)
+    {
+        sprintf(query, "INSERT INTO `Indexed` (`Name`, `Num`, `Value`) VALUES ('k%u', %u, %u)", i / 2, i % 2, i);
+        r = run_query(hdb, 0, query);
+        ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    }
+    for (i = 0; i < 10; i++)
+    {
+        sprintf(query, "INSERT INTO `Ref` (`Id`, `Name_`) VALUES (%u, 'k%u')", i, i * 3);
+        r = run_query(hdb, 0, query);
+        ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    }
+
+    /* duplicate keys are rejected, rows sharing part of the key are not */
+    r = run_query(hdb, 0, "INSERT INTO `Indexed` (`Name`, `Num`, `Value`) VALUES ('k3', 1, 500)");
+    ok(r == ERROR_FUNCTION_FAILED, "Expected ERROR_FUNCTION_FAILED, got %u\n", r);
+
+    r = run_query(hdb, 0, "INSERT INTO `Indexed` (`Name`, `Num`, `Value`) VALUES ('k3', 2, 501)");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Value` FROM `Indexed` WHERE `Name` = 'k10' AND `Num` = 1", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    ok(MsiRecordGetInteger(hrec, 1) == 21, "got %d\n", MsiRecordGetInteger(hrec, 1));
+    MsiCloseHandle(hrec);
+
+    r = do_query(hdb, "SELECT `Value` FROM `Indexed` WHERE `Name` = 'missing'", &hrec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Name`, `Num` FROM `Indexed` WHERE `Value` = 42", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    check_record(hrec, 2, "k21", "0");
+    MsiCloseHandle(hrec);
+
+    /* deleting rows moves the remaining ones */
+    r = run_query(hdb, 0, "DELETE FROM `Indexed` WHERE `Name` = 'k10'");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Value` FROM `Indexed` WHERE `Name` = 'k10'", &hrec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Value` FROM `Indexed` WHERE `Name` = 'k11' AND `Num` = 0", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    ok(MsiRecordGetInteger(hrec, 1) == 22, "got %d\n", MsiRecordGetInteger(hrec, 1));
+    MsiCloseHandle(hrec);
+
+    /* rows inserted in the middle of the table are found */
+    r = run_query(hdb, 0, "INSERT INTO `Indexed` (`Name`, `Num`, `Value`) VALUES ('k10', 1, 600)");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Value` FROM `Indexed` WHERE `Name` = 'k10'", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    ok(MsiRecordGetInteger(hrec, 1) == 600, "got %d\n", MsiRecordGetInteger(hrec, 1));
+    MsiCloseHandle(hrec);
+
+    r = do_query(hdb, "SELECT `Name`, `Num` FROM `Indexed` WHERE `Value` = 23", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    check_record(hrec, 2, "k11", "1");
+    MsiCloseHandle(hrec);
+
+    r = run_query(hdb, 0, "DELETE FROM `Indexed` WHERE `Name` = 'k10'");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    r = run_query(hdb, 0, "UPDATE `Indexed` SET `Value` = 1000 WHERE `Name` = 'k20' AND `Num` = 0");
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Name`, `Num` FROM `Indexed` WHERE `Value` = 1000", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    check_record(hrec, 2, "k20", "0");
+    MsiCloseHandle(hrec);
+
+    r = do_query(hdb, "SELECT `Name` FROM `Indexed` WHERE `Value` = 40", &hrec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %u\n", r);
+
+    r = do_query(hdb, "SELECT `Value` FROM `Indexed`, `Ref` WHERE `Indexed`.`Name` = `Ref`.`Name_` "
+                      "AND `Num` = 1 AND `Id` = 4", &hrec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    ok(MsiRecordGetInteger(hrec, 1) == 25, "got %d\n", MsiRecordGetInteger(hrec, 1));
+    MsiCloseHandle(hrec);
+
+    r = MsiDatabaseOpenViewA(hdb, "SELECT `Id`, `Value` FROM `Ref`, `Indexed` "
+                                  "WHERE `Ref`.`Name_` = `Indexed`.`Name` ORDER BY `Value`", &hview);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    r = MsiViewExecute(hview, 0);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+
+    i = 0;
+    while ((r = MsiViewFetch(hview, &hrec)) == ERROR_SUCCESS)
+    {
+        if (i < 20)
+            ok(MsiRecordGetInteger(hrec, 2) == (i / 2) * 6 + i % 2, "%u: got %d\n", i, MsiRecordGetInteger(hrec, 2));
+        i++;
+        MsiCloseHandle(hrec);
+    }
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %u\n", r);
+    ok(i == 21, "Expected 21 rows, got %u\n", i);
+
+    MsiViewClose(hview);
+    MsiCloseHandle(hview);
+    MsiCloseHandle(hdb);
+    DeleteFileA(msifile);
+}
+
 START_TEST(db)
 {
     test_msidatabase();
@@ -9436,4 +9554,5 @@ START_TEST(db)
     test_viewmodify_insert();
     test_view_get_error();
     test_viewfetch_wraparound();
+    test_indexed_lookup();
 }
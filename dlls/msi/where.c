@@ -647,15 +647,129 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+static BOOL is_table_column( const struct expr *expr, const struct join_table *table )
+{
+    return (expr->type == EXPR_COL_NUMBER || expr->type == EXPR_COL_NUMBER32 ||
+            expr->type == EXPR_COL_NUMBER_STRING) && expr->u.column.parsed.table == table;
+}
+
+/*
+ * Looks for an equality between a column of the table and either a constant
+ * or a column of a table whose row is already fixed, that must hold for the
+ * whole condition to be true.  Returns ERROR_SUCCESS and the stored column
+ * value to look up, ERROR_NO_MORE_ITEMS if no row can satisfy the equality,
+ * or ERROR_FUNCTION_FAILED if the table has to be scanned.
+ */
+static UINT find_index_lookup( MSIWHEREVIEW *wv, const struct expr *cond, const struct join_table *table,
+                               const UINT rows[], UINT *col, UINT *val )
+{
+    const struct expr *column, *other;
+    UINT r;
+
+    if (!cond || (cond->type != EXPR_COMPLEX && cond->type != EXPR_STRCMP))
+        return ERROR_FUNCTION_FAILED;
+
+    if (cond->type == EXPR_COMPLEX && cond->u.expr.op == OP_AND)
+    {
+        r = find_index_lookup( wv, cond->u.expr.left, table, rows, col, val );
+        if (r == ERROR_FUNCTION_FAILED)
+            r = find_index_lookup( wv, cond->u.expr.right, table, rows, col, val );
+        return r;
+    }
+
+    if (cond->u.expr.op != OP_EQ)
+        return ERROR_FUNCTION_FAILED;
+
+    if (is_table_column( cond->u.expr.left, table ))
+    {
+        column = cond->u.expr.left;
+        other = cond->u.expr.right;
+    }
+    else if (is_table_column( cond->u.expr.right, table ))
+    {
+        column = cond->u.expr.right;
+        other = cond->u.expr.left;
+    }
+    else
+        return ERROR_FUNCTION_FAILED;
+
+    switch (other->type)
+    {
+    case EXPR_UVAL:
+        if (column->type == EXPR_COL_NUMBER)
+            *val = other->u.uval + 0x8000;
+        else if (column->type == EXPR_COL_NUMBER32)
+            *val = other->u.uval + 0x80000000;
+        else
+            return ERROR_FUNCTION_FAILED;
+        break;
+
+    case EXPR_SVAL:
+        /* null and empty strings compare equal */
+        if (column->type != EXPR_COL_NUMBER_STRING || !other->u.sval[0])
+            return ERROR_FUNCTION_FAILED;
+        if (msi_string2id( wv->db->strings, other->u.sval, -1, val ) != ERROR_SUCCESS)
+            return ERROR_NO_MORE_ITEMS;
+        break;
+
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+    case EXPR_COL_NUMBER_STRING:
+        if (other->type != column->type ||
+            rows[other->u.column.parsed.table->table_index] == INVALID_ROW_INDEX)
+            return ERROR_FUNCTION_FAILED;
+        if (expr_fetch_value( &other->u.column, rows, val ) != ERROR_SUCCESS)
+            return ERROR_FUNCTION_FAILED;
+        if (other->type == EXPR_COL_NUMBER_STRING && !*val)
+            return ERROR_FUNCTION_FAILED;
+        break;
+
+    default:
+        return ERROR_FUNCTION_FAILED;
+    }
+
+    *col = column->u.column.parsed.column;
+    return ERROR_SUCCESS;
+}
+
+static UINT get_next_row( struct join_table *table, UINT *col, UINT val, UINT *row, MSIITERHANDLE *handle )
+{
+    UINT r;
+
+    if (*col)
+    {
+        r = table->view->ops->find_matching_rows( table->view, *col, val, row, handle );
+        if (r == ERROR_SUCCESS || r == ERROR_NO_MORE_ITEMS || *handle)
+            return r;
+
+        /* the index couldn't be used, scan the whole table instead */
+        TRACE("find_matching_rows returned %u, falling back to a scan\n", r);
+        *col = 0;
+    }
+
+    *row = (*row == INVALID_ROW_INDEX) ? 0 : *row + 1;
+    return *row < table->row_count ? ERROR_SUCCESS : ERROR_NO_MORE_ITEMS;
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, struct join_table **tables,
                              UINT table_rows[] )
 {
-    UINT r = ERROR_FUNCTION_FAILED;
+    UINT *row = &table_rows[(*tables)->table_index];
+    MSIITERHANDLE handle = NULL;
+    UINT ret, r = ERROR_SUCCESS, col = 0, key = 0;
     INT val;
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    /* use the index of an equality the rows have to satisfy instead of a full scan */
+    if ((*tables)->view->ops->find_matching_rows)
+    {
+        ret = find_index_lookup( wv, wv->cond, *tables, table_rows, &col, &key );
+        if (ret == ERROR_NO_MORE_ITEMS)
+            return ERROR_SUCCESS;
+        if (ret != ERROR_SUCCESS)
+            col = 0;
+    }
+
+    while (!(ret = get_next_row( *tables, &col, key, row, &handle )))
     {
         val = 0;
         wv->rec_index = 0;
@@ -678,7 +792,9 @@ static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, struct join_ta
             }
         }
     }
-    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    if (ret != ERROR_SUCCESS && ret != ERROR_NO_MORE_ITEMS)
+        r = ret;
+    *row = INVALID_ROW_INDEX;
     return r;
 }
 
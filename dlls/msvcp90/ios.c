@@ -856,11 +856,11 @@ __ASM_BLOCK_BEGIN(ios_vtables)
             VTABLE_ADD_FUNC(basic_streambuf_char_showmanyc)
             VTABLE_ADD_FUNC(basic_filebuf_char_underflow)
             VTABLE_ADD_FUNC(basic_filebuf_char_uflow)
-            VTABLE_ADD_FUNC(basic_streambuf_char_xsgetn)
+            VTABLE_ADD_FUNC(basic_filebuf_char_xsgetn)
 #if _MSVCP_VER >= 80 && _MSVCP_VER <= 90
-            VTABLE_ADD_FUNC(basic_streambuf_char__Xsgetn_s)
+            VTABLE_ADD_FUNC(basic_filebuf_char__Xsgetn_s)
 #endif
-            VTABLE_ADD_FUNC(basic_streambuf_char_xsputn)
+            VTABLE_ADD_FUNC(basic_filebuf_char_xsputn)
             VTABLE_ADD_FUNC(basic_filebuf_char_seekoff)
             VTABLE_ADD_FUNC(basic_filebuf_char_seekpos)
             VTABLE_ADD_FUNC(basic_filebuf_char_setbuf)
@@ -877,11 +877,11 @@ __ASM_BLOCK_BEGIN(ios_vtables)
             VTABLE_ADD_FUNC(basic_streambuf_wchar_showmanyc)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_underflow)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_uflow)
-            VTABLE_ADD_FUNC(basic_streambuf_wchar_xsgetn)
+            VTABLE_ADD_FUNC(basic_filebuf_wchar_xsgetn)
 #if _MSVCP_VER >= 80 && _MSVCP_VER <= 90
-            VTABLE_ADD_FUNC(basic_streambuf_wchar__Xsgetn_s)
+            VTABLE_ADD_FUNC(basic_filebuf_wchar__Xsgetn_s)
 #endif
-            VTABLE_ADD_FUNC(basic_streambuf_wchar_xsputn)
+            VTABLE_ADD_FUNC(basic_filebuf_wchar_xsputn)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_seekoff)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_seekpos)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_setbuf)
@@ -898,11 +898,11 @@ __ASM_BLOCK_BEGIN(ios_vtables)
             VTABLE_ADD_FUNC(basic_streambuf_wchar_showmanyc)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_underflow)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_uflow)
-            VTABLE_ADD_FUNC(basic_streambuf_wchar_xsgetn)
+            VTABLE_ADD_FUNC(basic_filebuf_wchar_xsgetn)
 #if _MSVCP_VER >= 80 && _MSVCP_VER <= 90
-            VTABLE_ADD_FUNC(basic_streambuf_wchar__Xsgetn_s)
+            VTABLE_ADD_FUNC(basic_filebuf_wchar__Xsgetn_s)
 #endif
-            VTABLE_ADD_FUNC(basic_streambuf_wchar_xsputn)
+            VTABLE_ADD_FUNC(basic_filebuf_wchar_xsputn)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_seekoff)
             VTABLE_ADD_FUNC(basic_filebuf_wchar_seekpos)
             VTABLE_ADD_FUNC(basic_filebuf_short_setbuf)
@@ -3503,6 +3503,148 @@ int __thiscall basic_filebuf_char_underflow(basic_filebuf_char *this)
     return ret;
 }
 
+#if _MSVCP_VER >= 100 /* sizeof(streamsize) == 8 */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char_xsputn, 16)
+#else
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char_xsputn, 12)
+#endif
+streamsize __thiscall basic_filebuf_char_xsputn(basic_filebuf_char *this, const char *ptr, streamsize count)
+{
+    char buf[1024], *to_next;
+    const char *from_next;
+    streamsize copied, chunk;
+    int max_len;
+
+    TRACE("(%p %p %s)\n", this, ptr, wine_dbgstr_longlong(count));
+
+    if(!basic_filebuf_char_is_open(this) || count <= 0)
+        return 0;
+
+    if(!this->cvt) {
+        /* the put area is the FILE buffer, pass everything that doesn't fit in one call */
+        chunk = basic_streambuf_char__Pnavail(&this->base);
+        if(chunk > count)
+            chunk = count;
+        if(chunk > 0) {
+            memcpy(*this->base.pwpos, ptr, chunk);
+            *this->base.pwpos += chunk;
+            *this->base.pwsize -= chunk;
+        }
+        if(chunk == count)
+            return count;
+        return chunk + fwrite(ptr+chunk, sizeof(char), count-chunk, this->file);
+    }
+
+    /* the output of a block of max_len characters always fits in buf */
+    max_len = codecvt_base_max_length(&this->cvt->base);
+    if(max_len < 1)
+        max_len = 1;
+
+    for(copied=0; copied<count;) {
+        chunk = sizeof(buf) / max_len;
+        if(chunk > count-copied)
+            chunk = count-copied;
+
+        switch(chunk ? codecvt_char_out(this->cvt, &this->state, ptr+copied, ptr+copied+chunk,
+                    &from_next, buf, buf+sizeof(buf), &to_next) : CODECVT_partial) {
+        case CODECVT_ok:
+        case CODECVT_partial:
+            if(chunk && from_next != ptr+copied) {
+                if(to_next != buf && !fwrite(buf, to_next-buf, 1, this->file))
+                    return copied;
+                copied = from_next-ptr;
+                break;
+            }
+            /* no progress, let overflow deal with the next character */
+            if(call_basic_streambuf_char_overflow(&this->base, (unsigned char)ptr[copied]) == EOF)
+                return copied;
+            copied++;
+            break;
+        case CODECVT_noconv:
+            return copied + fwrite(ptr+copied, sizeof(char), count-copied, this->file);
+        default:
+            return copied;
+        }
+    }
+
+    return copied;
+}
+
+#if _MSVCP_VER >= 100 /* sizeof(streamsize) == 8 */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char__Xsgetn_s, 20)
+#else
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char__Xsgetn_s, 16)
+#endif
+streamsize __thiscall basic_filebuf_char__Xsgetn_s(basic_filebuf_char *this, char *ptr, size_t size, streamsize count)
+{
+    streamsize copied, chunk;
+    const char *from_next;
+    char *to_next;
+    FILE *file;
+    int c, ret;
+
+    TRACE("(%p %p %Iu %s)\n", this, ptr, size, wine_dbgstr_longlong(count));
+
+    if(count > 0 && (size_t)count > size)
+        count = size;
+
+    for(copied=0; copied<count;) {
+        chunk = basic_streambuf_char__Gnavail(&this->base);
+        if(chunk > 0) {
+            if(chunk > count-copied)
+                chunk = count-copied;
+            memcpy(ptr+copied, *this->base.prpos, chunk);
+            *this->base.prpos += chunk;
+            *this->base.prsize -= chunk;
+            copied += chunk;
+            continue;
+        }
+
+        if(!basic_filebuf_char_is_open(this))
+            break;
+        file = this->file;
+
+        if(!this->cvt) {
+            /* the get area is the FILE buffer and it's empty, read the rest in one call */
+            copied += fread(ptr+copied, sizeof(char), count-copied, file);
+            break;
+        }
+
+        /* convert the bytes that are already buffered in place */
+        _lock_file(file);
+        if((file->_flag & _IOREAD) && file->_cnt > 0) {
+            ret = codecvt_char_in(this->cvt, &this->state, file->_ptr, file->_ptr+file->_cnt,
+                    &from_next, ptr+copied, ptr+count, &to_next);
+            if((ret == CODECVT_ok || ret == CODECVT_partial)
+                    && (from_next != file->_ptr || to_next != ptr+copied)) {
+                file->_cnt -= from_next - file->_ptr;
+                file->_ptr = (char*)from_next;
+                copied = to_next-ptr;
+                _unlock_file(file);
+                continue;
+            }
+        }
+        _unlock_file(file);
+
+        if((c = call_basic_streambuf_char_uflow(&this->base)) == EOF)
+            break;
+        ptr[copied++] = c;
+    }
+
+    return copied;
+}
+
+#if _MSVCP_VER >= 100 /* sizeof(streamsize) == 8 */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char_xsgetn, 16)
+#else
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char_xsgetn, 12)
+#endif
+streamsize __thiscall basic_filebuf_char_xsgetn(basic_filebuf_char *this, char *ptr, streamsize count)
+{
+    TRACE("(%p %p %s)\n", this, ptr, wine_dbgstr_longlong(count));
+    return basic_filebuf_char__Xsgetn_s(this, ptr, -1, count);
+}
+
 /* ?seekoff@?$basic_filebuf@DU?$char_traits@D@std@@@std@@MAE?AV?$fpos@H@2@JW4seekdir@ios_base@2@H@Z */
 /* ?seekoff@?$basic_filebuf@DU?$char_traits@D@std@@@std@@MEAA?AV?$fpos@H@2@_JW4seekdir@ios_base@2@H@Z */
 /* ?seekoff@?$basic_filebuf@DU?$char_traits@D@std@@@std@@MAE?AV?$fpos@H@2@JHH@Z */
@@ -4150,6 +4292,131 @@ unsigned short __thiscall basic_filebuf_wchar_underflow(basic_filebuf_wchar *thi
     return ret;
 }
 
+#if _MSVCP_VER >= 100 /* sizeof(streamsize) == 8 */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_wchar_xsputn, 16)
+#else
+DEFINE_THISCALL_WRAPPER(basic_filebuf_wchar_xsputn, 12)
+#endif
+streamsize __thiscall basic_filebuf_wchar_xsputn(basic_filebuf_wchar *this, const wchar_t *ptr, streamsize count)
+{
+    char buf[1024], *to_next;
+    const wchar_t *from_next;
+    streamsize copied, chunk;
+    int max_len;
+
+    TRACE("(%p %p %s)\n", this, ptr, wine_dbgstr_longlong(count));
+
+    if(!basic_filebuf_wchar_is_open(this) || !this->cvt
+            || basic_streambuf_wchar__Pnavail(&this->base))
+        return basic_streambuf_wchar_xsputn(&this->base, ptr, count);
+
+    /* the output of a block of max_len characters always fits in buf */
+    max_len = codecvt_base_max_length(&this->cvt->base);
+    if(max_len < 1)
+        max_len = 1;
+
+    for(copied=0; copied<count;) {
+        chunk = sizeof(buf) / max_len;
+        if(chunk > count-copied)
+            chunk = count-copied;
+
+        switch(chunk ? codecvt_wchar_out(this->cvt, &this->state, ptr+copied, ptr+copied+chunk,
+                    &from_next, buf, buf+sizeof(buf), &to_next) : CODECVT_partial) {
+        case CODECVT_ok:
+        case CODECVT_partial:
+            if(chunk && from_next != ptr+copied) {
+                if(to_next != buf && !fwrite(buf, to_next-buf, 1, this->file))
+                    return copied;
+                copied = from_next-ptr;
+                break;
+            }
+            /* no progress, let overflow deal with the next character */
+            if(call_basic_streambuf_wchar_overflow(&this->base, ptr[copied]) == WEOF)
+                return copied;
+            copied++;
+            break;
+        case CODECVT_noconv:
+            return copied + fwrite(ptr+copied, sizeof(wchar_t), count-copied, this->file);
+        default:
+            return copied;
+        }
+    }
+
+    return copied;
+}
+
+#if _MSVCP_VER >= 100 /* sizeof(streamsize) == 8 */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_wchar__Xsgetn_s, 20)
+#else
+DEFINE_THISCALL_WRAPPER(basic_filebuf_wchar__Xsgetn_s, 16)
+#endif
+streamsize __thiscall basic_filebuf_wchar__Xsgetn_s(basic_filebuf_wchar *this, wchar_t *ptr, size_t size, streamsize count)
+{
+    streamsize copied, chunk;
+    const char *from_next;
+    wchar_t *to_next;
+    unsigned short c;
+    FILE *file;
+    int ret;
+
+    TRACE("(%p %p %Iu %s)\n", this, ptr, size, wine_dbgstr_longlong(count));
+
+    if(count > 0 && (size_t)count > size)
+        count = size;
+
+    for(copied=0; copied<count;) {
+        chunk = basic_streambuf_wchar__Gnavail(&this->base);
+        if(chunk > 0) {
+            if(chunk > count-copied)
+                chunk = count-copied;
+            memcpy(ptr+copied, *this->base.prpos, chunk*sizeof(wchar_t));
+            *this->base.prpos += chunk;
+            *this->base.prsize -= chunk;
+            copied += chunk;
+            continue;
+        }
+
+        if(!basic_filebuf_wchar_is_open(this))
+            break;
+        file = this->file;
+
+        /* convert the bytes that are already buffered in place */
+        if(this->cvt) {
+            _lock_file(file);
+            if((file->_flag & _IOREAD) && file->_cnt > 0) {
+                ret = codecvt_wchar_in(this->cvt, &this->state, file->_ptr, file->_ptr+file->_cnt,
+                        &from_next, ptr+copied, ptr+count, &to_next);
+                if((ret == CODECVT_ok || ret == CODECVT_partial)
+                        && (from_next != file->_ptr || to_next != ptr+copied)) {
+                    file->_cnt -= from_next - file->_ptr;
+                    file->_ptr = (char*)from_next;
+                    copied = to_next-ptr;
+                    _unlock_file(file);
+                    continue;
+                }
+            }
+            _unlock_file(file);
+        }
+
+        if((c = call_basic_streambuf_wchar_uflow(&this->base)) == WEOF)
+            break;
+        ptr[copied++] = c;
+    }
+
+    return copied;
+}
+
+#if _MSVCP_VER >= 100 /* sizeof(streamsize) == 8 */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_wchar_xsgetn, 16)
+#else
+DEFINE_THISCALL_WRAPPER(basic_filebuf_wchar_xsgetn, 12)
+#endif
+streamsize __thiscall basic_filebuf_wchar_xsgetn(basic_filebuf_wchar *this, wchar_t *ptr, streamsize count)
+{
+    TRACE("(%p %p %s)\n", this, ptr, wine_dbgstr_longlong(count));
+    return basic_filebuf_wchar__Xsgetn_s(this, ptr, -1, count);
+}
+
 /* ?seekoff@?$basic_filebuf@GU?$char_traits@G@std@@@std@@MAE?AV?$fpos@H@2@JW4seekdir@ios_base@2@H@Z */
 /* ?seekoff@?$basic_filebuf@GU?$char_traits@G@std@@@std@@MEAA?AV?$fpos@H@2@_JW4seekdir@ios_base@2@H@Z */
 /* ?seekoff@?$basic_filebuf@_WU?$char_traits@_W@std@@@std@@MAE?AV?$fpos@H@2@JHH@Z */
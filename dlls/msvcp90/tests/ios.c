@@ -477,6 +477,12 @@ static void (*__thiscall p_basic_fstream_char_vbase_dtor)(basic_fstream_char*);
 static basic_fstream_wchar* (*__thiscall p_basic_fstream_wchar_ctor_name)(basic_fstream_wchar*, const char*, int, int, MSVCP_bool);
 static void (*__thiscall p_basic_fstream_wchar_vbase_dtor)(basic_fstream_wchar*);
 
+/* streambuf */
+static streamsize (*__thiscall p_basic_streambuf_char_sgetn)(basic_streambuf_char*, char*, streamsize);
+static streamsize (*__thiscall p_basic_streambuf_char_sputn)(basic_streambuf_char*, const char*, streamsize);
+static streamsize (*__thiscall p_basic_streambuf_wchar_sgetn)(basic_streambuf_wchar*, wchar_t*, streamsize);
+static streamsize (*__thiscall p_basic_streambuf_wchar_sputn)(basic_streambuf_wchar*, const wchar_t*, streamsize);
+
 /* istream */
 static basic_istream_char* (*__thiscall p_basic_istream_char_read_uint64)(basic_istream_char*, unsigned __int64*);
 static basic_istream_char* (*__thiscall p_basic_istream_char_read_float)(basic_istream_char*, float*);
@@ -694,6 +700,15 @@ static BOOL init(void)
         SET(p_basic_fstream_wchar_vbase_dtor,
             "??_D?$basic_fstream@_WU?$char_traits@_W@std@@@std@@QEAAXXZ");
 
+        SET(p_basic_streambuf_char_sgetn,
+            "?sgetn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QEAA_JPEAD_J@Z");
+        SET(p_basic_streambuf_char_sputn,
+            "?sputn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QEAA_JPEBD_J@Z");
+        SET(p_basic_streambuf_wchar_sgetn,
+            "?sgetn@?$basic_streambuf@_WU?$char_traits@_W@std@@@std@@QEAA_JPEA_W_J@Z");
+        SET(p_basic_streambuf_wchar_sputn,
+            "?sputn@?$basic_streambuf@_WU?$char_traits@_W@std@@@std@@QEAA_JPEB_W_J@Z");
+
         SET(p_basic_istream_char_read_uint64,
             "??5?$basic_istream@DU?$char_traits@D@std@@@std@@QEAAAEAV01@AEA_K@Z");
         SET(p_basic_istream_char_read_float,
@@ -847,6 +862,15 @@ static BOOL init(void)
         SET(p_basic_fstream_wchar_vbase_dtor,
             "??_D?$basic_fstream@_WU?$char_traits@_W@std@@@std@@QAEXXZ");
 
+        SET(p_basic_streambuf_char_sgetn,
+            "?sgetn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QAEHPADH@Z");
+        SET(p_basic_streambuf_char_sputn,
+            "?sputn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QAEHPBDH@Z");
+        SET(p_basic_streambuf_wchar_sgetn,
+            "?sgetn@?$basic_streambuf@_WU?$char_traits@_W@std@@@std@@QAEHPA_WH@Z");
+        SET(p_basic_streambuf_wchar_sputn,
+            "?sputn@?$basic_streambuf@_WU?$char_traits@_W@std@@@std@@QAEHPB_WH@Z");
+
         SET(p_basic_istream_char_read_uint64,
             "??5?$basic_istream@DU?$char_traits@D@std@@@std@@QAAAAV01@AA_K@Z");
         SET(p_basic_istream_char_read_float,
@@ -996,6 +1020,15 @@ static BOOL init(void)
         SET(p_basic_fstream_wchar_vbase_dtor,
             "??_D?$basic_fstream@_WU?$char_traits@_W@std@@@std@@QAEXXZ");
 
+        SET(p_basic_streambuf_char_sgetn,
+            "?sgetn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QAEHPADH@Z");
+        SET(p_basic_streambuf_char_sputn,
+            "?sputn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QAEHPBDH@Z");
+        SET(p_basic_streambuf_wchar_sgetn,
+            "?sgetn@?$basic_streambuf@_WU?$char_traits@_W@std@@@std@@QAEHPA_WH@Z");
+        SET(p_basic_streambuf_wchar_sputn,
+            "?sputn@?$basic_streambuf@_WU?$char_traits@_W@std@@@std@@QAEHPB_WH@Z");
+
         SET(p_basic_istream_char_read_uint64,
             "??5?$basic_istream@DU?$char_traits@D@std@@@std@@QAEAAV01@AA_K@Z");
         SET(p_basic_istream_char_read_float,
@@ -2023,6 +2056,60 @@ static void test_istream_tellg(void)
 }
 
 
+static void test_filebuf_sputn_sgetn(void)
+{
+    static char buf[100000], rbuf[100000];
+    static wchar_t wbuf[50000], wrbuf[50000];
+    const char *testfile = "file.txt";
+    basic_fstream_wchar wfs;
+    basic_fstream_char fs;
+    streamsize count;
+    int i;
+
+    for(i=0; i<ARRAY_SIZE(buf); i++)
+        buf[i] = (i % 80 == 79) ? '\n' : 'a' + i % 26;
+    for(i=0; i<ARRAY_SIZE(wbuf); i++)
+        wbuf[i] = (i % 80 == 79) ? '\n' : 'a' + i % 26;
+
+    /* fstream<char> version */
+    call_func5(p_basic_fstream_char_ctor_name, &fs, testfile,
+            OPENMODE_out|OPENMODE_in|OPENMODE_trunc, SH_DENYNO, TRUE);
+
+    count = (streamsize)call_func3(p_basic_streambuf_char_sputn, &fs.filebuf.base, buf, 10);
+    ok(count == 10, "sputn returned %Id\n", count);
+    count = (streamsize)call_func3(p_basic_streambuf_char_sputn, &fs.filebuf.base, buf+10, ARRAY_SIZE(buf)-10);
+    ok(count == ARRAY_SIZE(buf)-10, "sputn returned %Id\n", count);
+
+    call_func3(p_basic_istream_char_seekg, &fs.base.base1, 0, SEEKDIR_beg);
+    count = (streamsize)call_func3(p_basic_streambuf_char_sgetn, &fs.filebuf.base, rbuf, 1);
+    ok(count == 1, "sgetn returned %Id\n", count);
+    count = (streamsize)call_func3(p_basic_streambuf_char_sgetn, &fs.filebuf.base, rbuf+1, ARRAY_SIZE(rbuf)-1);
+    ok(count == ARRAY_SIZE(rbuf)-1, "sgetn returned %Id\n", count);
+    ok(!memcmp(buf, rbuf, sizeof(buf)), "read data doesn't match\n");
+
+    call_func1(p_basic_fstream_char_vbase_dtor, &fs);
+
+    /* fstream<wchar_t> version */
+    call_func5(p_basic_fstream_wchar_ctor_name, &wfs, testfile,
+            OPENMODE_out|OPENMODE_in|OPENMODE_trunc, SH_DENYNO, TRUE);
+
+    count = (streamsize)call_func3(p_basic_streambuf_wchar_sputn, &wfs.filebuf.base, wbuf, 10);
+    ok(count == 10, "sputn returned %Id\n", count);
+    count = (streamsize)call_func3(p_basic_streambuf_wchar_sputn, &wfs.filebuf.base, wbuf+10, ARRAY_SIZE(wbuf)-10);
+    ok(count == ARRAY_SIZE(wbuf)-10, "sputn returned %Id\n", count);
+
+    call_func3(p_basic_istream_wchar_seekg, &wfs.base.base1, 0, SEEKDIR_beg);
+    count = (streamsize)call_func3(p_basic_streambuf_wchar_sgetn, &wfs.filebuf.base, wrbuf, 1);
+    ok(count == 1, "sgetn returned %Id\n", count);
+    count = (streamsize)call_func3(p_basic_streambuf_wchar_sgetn, &wfs.filebuf.base, wrbuf+1, ARRAY_SIZE(wrbuf)-1);
+    ok(count == ARRAY_SIZE(wrbuf)-1, "sgetn returned %Id\n", count);
+    ok(!memcmp(wbuf, wrbuf, sizeof(wbuf)), "read data doesn't match\n");
+
+    call_func1(p_basic_fstream_wchar_vbase_dtor, &wfs);
+
+    unlink(testfile);
+}
+
 static void test_istream_getline(void)
 {
     basic_stringstream_wchar wss;
@@ -2510,6 +2597,7 @@ START_TEST(ios)
     test_istream_seekg_fpos();
     test_istream_peek();
     test_istream_tellg();
+    test_filebuf_sputn_sgetn();
     test_istream_getline();
     test_ostream_print_ushort();
     test_ostream_print_float();
@@ -1417,10 +1417,10 @@ static void test_StructuredTaskCollection(void)
 {
     HANDLE chore_start_evt, chore_evt1, chore_evt2;
     _StructuredTaskCollection task_coll;
-    struct chore chore1, chore2;
+    struct chore chore1, chore2, chores[64];
     DWORD main_thread_id;
     Context *context;
-    int status;
+    int status, i;
     DWORD ret;
     BOOL b;
 
@@ -1568,6 +1568,24 @@ static void test_StructuredTaskCollection(void)
     ok(chore1.executed, "Chore was not executed\n");
     call_func1(p__StructuredTaskCollection_dtor, &task_coll);
 
+    /* test running many chores (main + scheduled) */
+    call_func2(p__StructuredTaskCollection_ctor, &task_coll, NULL);
+    for (i = 0; i < ARRAY_SIZE(chores); i++)
+    {
+        chore_ctor(&chores[i]);
+        call_func2(p__StructuredTaskCollection__Schedule, &task_coll, &chores[i].chore);
+    }
+    ok(task_coll.count == ARRAY_SIZE(chores), "Wrong chore count: %ld != 64\n", task_coll.count);
+    chore_ctor(&chore1);
+    chore1.main_tid = main_thread_id;
+
+    status = p__StructuredTaskCollection__RunAndWait(&task_coll, &chore1.chore);
+    ok(status == 1, "_StructuredTaskCollection::_RunAndWait failed: %d\n", status);
+    ok(chore1.executed, "Main chore was not executed\n");
+    for (i = 0; i < ARRAY_SIZE(chores); i++)
+        ok(chores[i].executed, "Chore #%d was not executed\n", i);
+    call_func1(p__StructuredTaskCollection_dtor, &task_coll);
+
     /* test that running chores can be canceled */
     call_func2(p__StructuredTaskCollection_ctor, &task_coll, NULL);
     ResetEvent(chore_start_evt);
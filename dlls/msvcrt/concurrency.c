@@ -127,6 +127,11 @@ typedef struct Scheduler {
         void, (Scheduler*,void (__cdecl*)(void*),void*), (this,proc,data))
 #endif
 
+struct chore_queue {
+    SRWLOCK lock;
+    struct list chores;
+};
+
 typedef struct {
     Scheduler scheduler;
     LONG ref;
@@ -137,7 +142,11 @@ typedef struct {
     int shutdown_size;
     HANDLE *shutdown_events;
     CRITICAL_SECTION cs;
-    struct list scheduled_chores;
+    unsigned int queue_count;
+    struct chore_queue *queues;
+    LONG max_workers;
+    LONG active_workers;
+    LONG pending_chores;
 } ThreadScheduler;
 extern const vtable_ptr ThreadScheduler_vtable;
 
@@ -903,19 +912,25 @@ static void remove_scheduled_chores(Scheduler *scheduler, const ExternalContextB
 {
     ThreadScheduler *tscheduler = (ThreadScheduler*)scheduler;
     struct scheduled_chore *sc, *next;
+    unsigned int i;
 
     if (tscheduler->scheduler.vtable != &ThreadScheduler_vtable)
         return;
 
-    EnterCriticalSection(&tscheduler->cs);
-    LIST_FOR_EACH_ENTRY_SAFE(sc, next, &tscheduler->scheduled_chores,
-                             struct scheduled_chore, entry) {
-        if (sc->chore->task_collection->context == &context->context) {
-            list_remove(&sc->entry);
-            operator_delete(sc);
+    for (i = 0; i < tscheduler->queue_count; i++) {
+        struct chore_queue *queue = &tscheduler->queues[i];
+
+        AcquireSRWLockExclusive(&queue->lock);
+        LIST_FOR_EACH_ENTRY_SAFE(sc, next, &queue->chores,
+                                 struct scheduled_chore, entry) {
+            if (sc->chore->task_collection->context == &context->context) {
+                list_remove(&sc->entry);
+                operator_delete(sc);
+                InterlockedDecrement(&tscheduler->pending_chores);
+            }
         }
+        ReleaseSRWLockExclusive(&queue->lock);
     }
-    LeaveCriticalSection(&tscheduler->cs);
 }
 
 static void ExternalContextBase_dtor(ExternalContextBase *this)
@@ -1238,6 +1253,7 @@ void __thiscall SchedulerPolicy_dtor(SchedulerPolicy *this)
 static void ThreadScheduler_dtor(ThreadScheduler *this)
 {
     int i;
+    unsigned int q;
     struct scheduled_chore *sc, *next;
 
     if(this->ref != 0) WARN("ref = %ld\n", this->ref);
@@ -1250,11 +1266,14 @@ static void ThreadScheduler_dtor(ThreadScheduler *this)
     this->cs.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection(&this->cs);
 
-    if (!list_empty(&this->scheduled_chores))
-        ERR("scheduled chore list is not empty\n");
-    LIST_FOR_EACH_ENTRY_SAFE(sc, next, &this->scheduled_chores,
-            struct scheduled_chore, entry)
-        operator_delete(sc);
+    for(q=0; q<this->queue_count; q++) {
+        if (!list_empty(&this->queues[q].chores))
+            ERR("scheduled chore list is not empty\n");
+        LIST_FOR_EACH_ENTRY_SAFE(sc, next, &this->queues[q].chores,
+                struct scheduled_chore, entry)
+            operator_delete(sc);
+    }
+    operator_delete(this->queues);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_Id, 4)
@@ -1462,6 +1481,7 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
         const SchedulerPolicy *policy)
 {
     SYSTEM_INFO si;
+    unsigned int i;
 
     TRACE("(%p)->()\n", this);
 
@@ -1481,7 +1501,19 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
     InitializeCriticalSection(&this->cs);
     this->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": ThreadScheduler");
 
-    list_init(&this->scheduled_chores);
+    /* One chore queue per virtual processor. Worker threads are started on
+     * demand, up to MaxConcurrency, but at least MinConcurrency of them may
+     * run if chores are available. */
+    this->queue_count = this->virt_proc_no ? this->virt_proc_no : 1;
+    this->queues = operator_new(this->queue_count * sizeof(*this->queues));
+    for(i=0; i<this->queue_count; i++) {
+        InitializeSRWLock(&this->queues[i].lock);
+        list_init(&this->queues[i].chores);
+    }
+    this->max_workers = max(this->queue_count,
+            SchedulerPolicy_GetPolicyValue(&this->policy, MinConcurrency));
+    this->active_workers = 0;
+    this->pending_chores = 0;
     return this;
 }
 
@@ -2035,11 +2067,30 @@ static void __cdecl chore_wrapper(_UnrealizedChore *chore)
     __FINALLY_CTX(chore_wrapper_finally, chore)
 }
 
+static unsigned int get_home_queue(ThreadScheduler *scheduler)
+{
+    return (GetCurrentThreadId() >> 2) % scheduler->queue_count;
+}
+
+static BOOL get_worker_slot(ThreadScheduler *scheduler)
+{
+    LONG workers;
+
+    do {
+        workers = scheduler->active_workers;
+        if (workers >= scheduler->max_workers)
+            return FALSE;
+    } while (InterlockedCompareExchange(&scheduler->active_workers,
+                workers + 1, workers) != workers);
+    return TRUE;
+}
+
 static BOOL pick_and_execute_chore(ThreadScheduler *scheduler)
 {
-    struct list *entry;
+    struct list *entry = NULL;
     struct scheduled_chore *sc;
     _UnrealizedChore *chore;
+    unsigned int i, home;
 
     TRACE("(%p)\n", scheduler);
 
@@ -2049,13 +2100,25 @@ static BOOL pick_and_execute_chore(ThreadScheduler *scheduler)
         return FALSE;
     }
 
-    EnterCriticalSection(&scheduler->cs);
-    entry = list_head(&scheduler->scheduled_chores);
-    if (entry)
-        list_remove(entry);
-    LeaveCriticalSection(&scheduler->cs);
+    if (!ReadNoFence(&scheduler->pending_chores))
+        return FALSE;
+
+    /* Take the most recently scheduled chore from our own queue, otherwise
+     * steal the oldest one from the other queues. */
+    home = get_home_queue(scheduler);
+    for (i = 0; i < scheduler->queue_count && !entry; i++)
+    {
+        struct chore_queue *queue = &scheduler->queues[(home + i) % scheduler->queue_count];
+
+        AcquireSRWLockExclusive(&queue->lock);
+        entry = i ? list_tail(&queue->chores) : list_head(&queue->chores);
+        if (entry)
+            list_remove(entry);
+        ReleaseSRWLockExclusive(&queue->lock);
+    }
     if (!entry)
         return FALSE;
+    InterlockedDecrement(&scheduler->pending_chores);
 
     sc = LIST_ENTRY(entry, struct scheduled_chore, entry);
     chore = sc->chore;
@@ -2067,7 +2130,15 @@ static BOOL pick_and_execute_chore(ThreadScheduler *scheduler)
 
 static void __cdecl _StructuredTaskCollection_scheduler_cb(void *data)
 {
-    pick_and_execute_chore((ThreadScheduler*)get_current_scheduler());
+    ThreadScheduler *scheduler = (ThreadScheduler*)get_current_scheduler();
+
+    do
+    {
+        while (pick_and_execute_chore(scheduler)) ;
+        InterlockedDecrement(&scheduler->active_workers);
+        /* A chore may have been queued after the last pick, while all worker
+         * slots were taken. */
+    } while (ReadAcquire(&scheduler->pending_chores) && get_worker_slot(scheduler));
 }
 
 static bool schedule_chore(_StructuredTaskCollection *this,
@@ -2075,6 +2146,7 @@ static bool schedule_chore(_StructuredTaskCollection *this,
 {
     struct scheduled_chore *sc;
     ThreadScheduler *scheduler;
+    struct chore_queue *queue;
 
     if (chore->task_collection) {
         invalid_multiple_scheduling e;
@@ -2098,9 +2170,16 @@ static bool schedule_chore(_StructuredTaskCollection *this,
     chore->chore_wrapper = chore_wrapper;
     InterlockedIncrement(&this->count);
 
-    EnterCriticalSection(&scheduler->cs);
-    list_add_head(&scheduler->scheduled_chores, &sc->entry);
-    LeaveCriticalSection(&scheduler->cs);
+    queue = &scheduler->queues[get_home_queue(scheduler)];
+    AcquireSRWLockExclusive(&queue->lock);
+    list_add_head(&queue->chores, &sc->entry);
+    ReleaseSRWLockExclusive(&queue->lock);
+    InterlockedIncrement(&scheduler->pending_chores);
+
+    /* Only start a new worker if there's a free slot, running workers keep
+     * picking chores until all queues are empty. */
+    if (!get_worker_slot(scheduler))
+        return FALSE;
     *pscheduler = &scheduler->scheduler;
     return TRUE;
 }
@@ -2162,6 +2241,7 @@ static void CALLBACK exception_ptr_rethrow_finally(BOOL normal, void *data)
 /*_TaskCollectionStatus*/int __stdcall _StructuredTaskCollection__RunAndWait(
         _StructuredTaskCollection *this, _UnrealizedChore *chore)
 {
+    ThreadScheduler *scheduler = NULL;
     LONG expected, val;
     ULONG_PTR exception;
 
@@ -2176,16 +2256,18 @@ static void CALLBACK exception_ptr_rethrow_finally(BOOL normal, void *data)
         execute_chore(chore, this);
     }
 
-    if (this->context) {
-        ThreadScheduler *scheduler = get_thread_scheduler_from_context(this->context);
-        if (scheduler) {
-            while (pick_and_execute_chore(scheduler)) ;
-        }
-    }
+    if (this->context)
+        scheduler = get_thread_scheduler_from_context(this->context);
 
+    /* Execute queued chores inline instead of blocking while they're
+     * waiting for a worker. */
     expected = this->count ? this->count : FINISHED_INITIAL;
     while ((val = this->finished) != expected)
+    {
+        if (scheduler && pick_and_execute_chore(scheduler))
+            continue;
         RtlWaitOnAddress((LONG*)&this->finished, &val, sizeof(val), NULL);
+    }
 
     this->finished = 0;
     this->count = 0;
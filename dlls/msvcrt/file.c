@@ -5256,31 +5256,31 @@ int CDECL tmpfile_s(FILE** file)
     return 0;
 }
 
+/* the puts callbacks are called with the file locked by vf(w)printf_helper */
 static int puts_clbk_file_a(void *file, int len, const char *str)
 {
-    return fwrite(str, sizeof(char), len, file);
+    FILE *f = file;
+
+    if(f->_cnt >= len) {
+        memcpy(f->_ptr, str, len);
+        f->_ptr += len;
+        f->_cnt -= len;
+        return len;
+    }
+    return _fwrite_nolock(str, sizeof(char), len, f);
 }
 
 static int puts_clbk_file_w(void *file, int len, const wchar_t *str)
 {
-    int i, ret;
-
-    _lock_file(file);
+    int i;
 
-    if(!(get_ioinfo_nolock(((FILE*)file)->_file)->wxflag & WX_TEXT)) {
-        ret = _fwrite_nolock(str, sizeof(wchar_t), len, file);
-        _unlock_file(file);
-        return ret;
-    }
+    if(!(get_ioinfo_nolock(((FILE*)file)->_file)->wxflag & WX_TEXT))
+        return _fwrite_nolock(str, sizeof(wchar_t), len, file);
 
     for(i=0; i<len; i++) {
-        if(_fputwc_nolock(str[i], file) == WEOF) {
-            _unlock_file(file);
+        if(_fputwc_nolock(str[i], file) == WEOF)
             return -1;
-        }
     }
-
-    _unlock_file(file);
     return len;
 }
 
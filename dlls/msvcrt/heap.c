@@ -24,9 +24,11 @@
 #include <malloc.h>
 #include "msvcrt.h"
 #include "mtdll.h"
+#include "winternl.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(msvcrt);
+WINE_DECLARE_DEBUG_CHANNEL(heap);
 
 /* MT */
 #define LOCK_HEAP   _lock( _HEAP_LOCK )
@@ -43,6 +45,33 @@ WINE_DEFAULT_DEBUG_CHANNEL(msvcrt);
 
 static HANDLE heap, sb_heap;
 
+/* Recently freed small blocks are kept in per-thread lists indexed by their
+ * exact size, so a recycled block reports the same _msize as a fresh one.
+ * A cached block holds the next block of its list, followed by a marker
+ * derived from the owning cache, so that freeing it again is noticed.
+ *
+ * Caches are only ever touched by their own thread, which keeps malloc and
+ * free free of interlocked operations. Flushing every cache bumps a global
+ * generation instead, and each thread empties its cache on its next heap
+ * call; blocks cached by threads that don't call into the heap meanwhile
+ * still show up as used in _heapwalk. */
+#define HEAP_CACHE_MAX_SIZE  256
+#define HEAP_CACHE_BIN_DEPTH 16
+#define HEAP_CACHE_MAX_BYTES 0x8000
+#define HEAP_CACHE_DISABLED  ((struct heap_cache *)1)
+#define HEAP_CACHE_MAGIC     ((ULONG_PTR)0x48434143)  /* "CACH" */
+
+struct heap_cache
+{
+    void  *bins[HEAP_CACHE_MAX_SIZE + 1];
+    BYTE   counts[HEAP_CACHE_MAX_SIZE + 1];
+    size_t bytes;
+    LONG   generation;
+};
+
+static DWORD heap_cache_tls = TLS_OUT_OF_INDEXES;
+static LONG heap_cache_generation;
+
 typedef int (CDECL *MSVCRT_new_handler_func)(size_t size);
 
 static MSVCRT_new_handler_func MSVCRT_new_handler;
@@ -53,8 +82,135 @@ static unsigned int MSVCRT_amblksiz = 16;
 /* FIXME - According to documentation it should be 480 bytes, at runtime default is 0 */
 static size_t MSVCRT_sbh_threshold = 0;
 
+static void heap_cache_flush(struct heap_cache *cache)
+{
+    void *block;
+    size_t size;
+
+    for (size = 0; size <= HEAP_CACHE_MAX_SIZE; size++)
+    {
+        while ((block = cache->bins[size]))
+        {
+            cache->bins[size] = *(void **)block;
+            ((ULONG_PTR *)block)[1] = 0;
+            HeapFree(heap, 0, block);
+        }
+        cache->counts[size] = 0;
+    }
+    cache->bytes = 0;
+}
+
+static struct heap_cache *heap_cache_get(BOOL create)
+{
+    struct heap_cache *cache;
+    LONG generation;
+    DWORD err;
+
+    if (heap_cache_tls == TLS_OUT_OF_INDEXES) return NULL;
+
+    err = GetLastError();  /* need to preserve last error */
+    generation = ReadNoFence(&heap_cache_generation);
+    cache = TlsGetValue(heap_cache_tls);
+    if (!cache && create && (cache = HeapAlloc(heap, HEAP_ZERO_MEMORY, sizeof(*cache))))
+    {
+        cache->generation = generation;
+        TlsSetValue(heap_cache_tls, cache);
+    }
+    if (cache == HEAP_CACHE_DISABLED) cache = NULL;
+    if (cache && cache->generation != generation)
+    {
+        heap_cache_flush(cache);
+        cache->generation = generation;
+    }
+    SetLastError(err);
+    return cache;
+}
+
+/* flush the calling thread's cache now, and the other ones on their next heap call */
+static void heap_cache_flush_all(void)
+{
+    InterlockedIncrement(&heap_cache_generation);
+    heap_cache_get(FALSE);
+}
+
+/* the marker doesn't depend on the cache, so that every thread recognizes
+ * a block sitting in any thread's cache */
+static inline ULONG_PTR heap_cache_marker(const void *block)
+{
+    return (ULONG_PTR)block ^ HEAP_CACHE_MAGIC;
+}
+
+static void *heap_cache_alloc(size_t size)
+{
+    struct heap_cache *cache;
+    void *block;
+
+    if (size < 2 * sizeof(void *) || size > HEAP_CACHE_MAX_SIZE) return NULL;
+    if (!(cache = heap_cache_get(FALSE)) || sb_heap || !(block = cache->bins[size])) return NULL;
+
+    cache->bins[size] = *(void **)block;
+    cache->counts[size]--;
+    cache->bytes -= size;
+    ((ULONG_PTR *)block)[1] = 0;
+    return block;
+}
+
+/* the block carries the cache marker, so it is most likely being freed
+ * twice. If it is in our cache, hand both frees to the heap to let it
+ * report the error. Otherwise it may be in another thread's cache, which
+ * we can't touch; freeing it to the heap would then let that thread and
+ * the heap both hand it out, so it is left alone. */
+static void heap_cache_double_free(struct heap_cache *cache, void *ptr, size_t size)
+{
+    void **prev;
+
+    for (prev = &cache->bins[size]; *prev; prev = (void **)*prev)
+    {
+        if (*prev != ptr) continue;
+        WARN("block %p freed twice\n", ptr);
+        *prev = *(void **)ptr;
+        ((ULONG_PTR *)ptr)[1] = 0;
+        cache->counts[size]--;
+        cache->bytes -= size;
+        HeapFree(heap, 0, ptr);
+        HeapFree(heap, 0, ptr);
+        return;
+    }
+    WARN("block %p freed twice or owned by another thread's cache, ignoring\n", ptr);
+}
+
+static BOOL heap_cache_free(void *ptr)
+{
+    struct heap_cache *cache;
+    size_t size;
+
+    if (heap_cache_tls == TLS_OUT_OF_INDEXES || !ptr) return FALSE;
+
+    size = HeapSize(heap, 0, ptr);
+    if (size < 2 * sizeof(void *) || size > HEAP_CACHE_MAX_SIZE) return FALSE;
+    if (!(cache = heap_cache_get(TRUE)) || sb_heap) return FALSE;
+
+    if (((ULONG_PTR *)ptr)[1] == heap_cache_marker(ptr))
+    {
+        heap_cache_double_free(cache, ptr, size);
+        return TRUE;
+    }
+
+    if (cache->counts[size] >= HEAP_CACHE_BIN_DEPTH) return FALSE;
+    if (cache->bytes + size > HEAP_CACHE_MAX_BYTES) return FALSE;
+
+    *(void **)ptr = cache->bins[size];
+    ((ULONG_PTR *)ptr)[1] = heap_cache_marker(ptr);
+    cache->bins[size] = ptr;
+    cache->counts[size]++;
+    cache->bytes += size;
+    return TRUE;
+}
+
 static void* msvcrt_heap_alloc(DWORD flags, size_t size)
 {
+    void *ret;
+
     if(size < MSVCRT_sbh_threshold)
     {
         void *memblock, *temp, **saved;
@@ -68,6 +224,12 @@ static void* msvcrt_heap_alloc(DWORD flags, size_t size)
         return memblock;
     }
 
+    if ((ret = heap_cache_alloc(size)))
+    {
+        if (flags & HEAP_ZERO_MEMORY) memset(ret, 0, size);
+        return ret;
+    }
+
     return HeapAlloc(heap, flags, size);
 }
 
@@ -111,6 +273,7 @@ static BOOL msvcrt_heap_free(void *ptr)
         return HeapFree(sb_heap, 0, *saved);
     }
 
+    if (heap_cache_free(ptr)) return TRUE;
     return HeapFree(heap, 0, ptr);
 }
 
@@ -257,6 +420,8 @@ int CDECL _heapchk(void)
  */
 int CDECL _heapmin(void)
 {
+  heap_cache_flush_all();
+
   if (!HeapCompact( heap, 0 ) ||
           (sb_heap && !HeapCompact( sb_heap, 0 )))
   {
@@ -277,6 +442,10 @@ int CDECL _heapwalk(_HEAPINFO *next)
   if (sb_heap)
       FIXME("small blocks heap not supported\n");
 
+  /* report cached blocks as free */
+  if (!next->_pentry)
+      heap_cache_flush_all();
+
   LOCK_HEAP;
   phe.lpData = next->_pentry;
   phe.cbData = next->_size;
@@ -530,6 +699,7 @@ int CDECL _set_sbh_threshold(size_t threshold)
 
   if(!sb_heap)
   {
+      heap_cache_flush_all();
       sb_heap = HeapCreate(0, 0, 0);
       if(!sb_heap)
           return 0;
@@ -829,12 +999,40 @@ int CDECL wmemcpy_s(wchar_t *dest, size_t numberOfElements,
 
 BOOL msvcrt_init_heap(void)
 {
+    static const ULONG debug_flags = FLG_HEAP_ENABLE_TAIL_CHECK | FLG_HEAP_ENABLE_FREE_CHECK |
+            FLG_HEAP_VALIDATE_PARAMETERS | FLG_HEAP_VALIDATE_ALL | FLG_HEAP_PAGE_ALLOCS;
+
     heap = HeapCreate(0, 0, 0);
-    return heap != NULL;
+    if (!heap) return FALSE;
+
+    /* keep every free visible to the heap when it is being validated */
+    if (!(RtlGetNtGlobalFlags() & debug_flags) && !TRACE_ON(heap) && !WARN_ON(heap))
+        heap_cache_tls = TlsAlloc();
+    return TRUE;
+}
+
+void msvcrt_free_heap_cache(void)
+{
+    struct heap_cache *cache;
+
+    if (heap_cache_tls == TLS_OUT_OF_INDEXES) return;
+
+    if ((cache = heap_cache_get(FALSE)))
+    {
+        heap_cache_flush(cache);
+        HeapFree(heap, 0, cache);
+    }
+    /* the thread may still free memory from other DLLs' detach routines */
+    TlsSetValue(heap_cache_tls, HEAP_CACHE_DISABLED);
 }
 
 void msvcrt_destroy_heap(void)
 {
+    if (heap_cache_tls != TLS_OUT_OF_INDEXES)
+    {
+        TlsFree(heap_cache_tls);
+        heap_cache_tls = TLS_OUT_OF_INDEXES;
+    }
     HeapDestroy(heap);
     if(sb_heap)
         HeapDestroy(sb_heap);
@@ -40,6 +40,7 @@
 #include <stdio.h>
 #include <fenv.h>
 #include <fpieee.h>
+#include <intrin.h>
 #include <limits.h>
 #include <locale.h>
 #include <math.h>
@@ -65,11 +66,24 @@ typedef int (CDECL *MSVCRT_matherr_func)(struct _exception *);
 static MSVCRT_matherr_func MSVCRT_default_matherr_func = NULL;
 
 BOOL sse2_supported;
+BOOL erms_supported;
 static BOOL sse2_enabled;
 
 void msvcrt_init_math( void *module )
 {
     sse2_supported = IsProcessorFeaturePresent( PF_XMMI64_INSTRUCTIONS_AVAILABLE );
+#if defined(__i386__) || defined(__x86_64__)
+    {
+        int regs[4];
+
+        __cpuid( regs, 0 );
+        if (regs[0] >= 7)
+        {
+            __cpuidex( regs, 7, 0 );
+            erms_supported = (regs[1] >> 9) & 1;
+        }
+    }
+#endif
 #if _MSVCR_VER <=71
     sse2_enabled = FALSE;
 #else
@@ -567,6 +581,25 @@ static double __round(double x)
     return *(double*)&llx;
 }
 
+/* Rounds x to the nearest integer using the current rounding mode (ties to
+ * even by default) and returns the integer in the low bits of *ki, |x| must
+ * be smaller than 2^51. This is much cheaper than __round in the argument
+ * reduction of the exp and pow kernels and matches musl there. */
+static inline double round_toint(double x, UINT64 *ki)
+{
+    static const double shift = 0x1.8p52;
+    double kd;
+
+#ifdef __i386__
+    /* make sure the sum is rounded to double precision */
+    kd = fp_barrier(x + shift);
+#else
+    kd = x + shift;
+#endif
+    *ki = *(UINT64*)&kd;
+    return kd - shift;
+}
+
 #if !defined(__i386__) || _MSVCR_VER >= 120
 /* Copied from musl: src/math/expm1f.c */
 static float __expm1f(float x)
@@ -1232,8 +1265,7 @@ float CDECL expf( float x )
     /* Round and convert z to int, the result is in [-150*N, 128*N] and
        ideally ties-to-even rule is used, otherwise the magnitude of r
        can be bigger which gives larger approximation error.  */
-    kd = __round(z);
-    ki = (INT64)kd;
+    kd = round_toint(z, &ki);
     r = z - kd;
 
     /* exp(x) = 2^(k/N) * 2^(r/N) ~= s * (C0*r^3 + C1*r^2 + C2*r + 1) */
@@ -1536,8 +1568,7 @@ static float powf_exp2(double xd, UINT32 sign_bias)
     double kd, z, r, r2, y, s;
 
     /* N*x = k + r with r in [-1/2, 1/2] */
-    kd = __round(xd); /* k */
-    ki = (INT64)kd;
+    kd = round_toint(xd, &ki); /* k */
     r = xd - kd;
 
     /* exp2(x) = 2^(k/N) * 2^r ~= s * (C0*r^3 + C1*r^2 + C2*r + 1) */
@@ -3020,8 +3051,7 @@ double CDECL exp( double x )
     /* exp(x) = 2^(k/N) * exp(r), with exp(r) in [2^(-1/2N),2^(1/2N)]. */
     /* x = ln2/N*k + r, with int k and r in [-ln2/2N, ln2/2N]. */
     z = invln2N * x;
-    kd = __round(z);
-    ki = (INT64)kd;
+    kd = round_toint(z, &ki);
 
     r = x + kd * negln2hiN + kd * negln2loN;
     /* 2^(k/N) ~= scale * (1 + tail). */
@@ -3852,8 +3882,7 @@ static double pow_exp(double argx, double argy, double x, double xtail, UINT32 s
     /* exp(x) = 2^(k/N) * exp(r), with exp(r) in [2^(-1/2N),2^(1/2N)]. */
     /* x = ln2/N*k + r, with int k and r in [-ln2/2N, ln2/2N]. */
     z = invln2N * x;
-    kd = __round(z);
-    ki = (INT64)kd;
+    kd = round_toint(z, &ki);
     r = x + kd * negln2hiN + kd * negln2loN;
     /* The code assumes 2^-200 < |xtail| < 2^-8/N. */
     r += xtail;
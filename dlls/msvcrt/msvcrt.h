@@ -34,6 +34,7 @@
 #undef wcsncpy
 
 extern BOOL sse2_supported DECLSPEC_HIDDEN;
+extern BOOL erms_supported DECLSPEC_HIDDEN;
 
 #define DBL80_MAX_10_EXP 4932
 #define DBL80_MIN_10_EXP -4951
@@ -230,6 +231,7 @@ extern void msvcrt_free_signals(void) DECLSPEC_HIDDEN;
 extern void msvcrt_free_popen_data(void) DECLSPEC_HIDDEN;
 extern BOOL msvcrt_init_heap(void) DECLSPEC_HIDDEN;
 extern void msvcrt_destroy_heap(void) DECLSPEC_HIDDEN;
+extern void msvcrt_free_heap_cache(void) DECLSPEC_HIDDEN;
 extern void msvcrt_init_clock(void) DECLSPEC_HIDDEN;
 
 #if _MSVCR_VER >= 100
@@ -83,15 +83,15 @@ static inline int FUNC_NAME(pf_fill)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ct
     written = r;
 
     if((!left && flags->LeftAlign) || (left && !flags->LeftAlign)) {
-        APICHAR ch;
+        APICHAR pad[32];
+        int n = min(flags->FieldLength-len, (int)ARRAY_SIZE(pad));
 
-        if(left && flags->PadZero)
-            ch = '0';
-        else
-            ch = ' ';
+        /* output the padding in blocks instead of one char at a time */
+        for(i=0; i<n; i++)
+            pad[i] = left && flags->PadZero ? '0' : ' ';
 
-        for(i=0; i<flags->FieldLength-len && r>=0; i++) {
-            r = pf_puts(puts_ctx, 1, &ch);
+        for(i=flags->FieldLength-len; i>0 && r>=0; i-=n) {
+            r = pf_puts(puts_ctx, min(i, n), pad);
             written += r;
         }
     }
@@ -586,6 +586,54 @@ static inline void FUNC_NAME(pf_integer_conv)(APICHAR *buf, pf_flags *flags, LON
     }
 }
 
+/* The digits of a floating point number are collected in a small buffer
+ * and passed to pf_puts in chunks rather than a limb or a character at
+ * a time. Once pf_puts fails the error is kept and nothing else is output. */
+struct FUNC_NAME(fp_out) {
+    FUNC_NAME(puts_clbk) pf_puts;
+    void *puts_ctx;
+    int written;
+    int len;
+    APICHAR buf[64];
+};
+
+static inline void FUNC_NAME(fp_out_flush)(struct FUNC_NAME(fp_out) *out)
+{
+    int r;
+
+    if(out->written < 0 || !out->len) return;
+
+    r = out->pf_puts(out->puts_ctx, out->len, out->buf);
+    out->written = r < 0 ? r : out->written + r;
+    out->len = 0;
+}
+
+static inline void FUNC_NAME(fp_out_chars)(struct FUNC_NAME(fp_out) *out, APICHAR ch, int count)
+{
+    while(count > 0 && out->written >= 0) {
+        if(out->len == ARRAY_SIZE(out->buf))
+            FUNC_NAME(fp_out_flush)(out);
+        for(; count > 0 && out->len < ARRAY_SIZE(out->buf); count--)
+            out->buf[out->len++] = ch;
+    }
+}
+
+/* outputs l as a len digits number, padded with leading zeros (len <= LIMB_DIGITS) */
+static inline void FUNC_NAME(fp_out_digits)(struct FUNC_NAME(fp_out) *out, DWORD l, int len)
+{
+    APICHAR *p;
+
+    if(out->len + len > ARRAY_SIZE(out->buf))
+        FUNC_NAME(fp_out_flush)(out);
+    if(out->written < 0) return;
+
+    out->len += len;
+    for(p = out->buf + out->len; len > 0; len--) {
+        *--p = '0' + l % 10;
+        l /= 10;
+    }
+}
+
 static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ctx,
         double v, pf_flags *flags, _locale_t locale, BOOL three_digit_exp,
         BOOL standard_rounding)
@@ -593,9 +641,8 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
     int e2, e10 = 0, round_pos, round_limb, radix_pos, first_limb_len, i, len, r, ret;
     BYTE bnum_data[FIELD_OFFSET(struct bnum, data[BNUM_PREC64])];
     struct bnum *b = (struct bnum*)bnum_data;
-    APICHAR buf[LIMB_DIGITS + 1];
+    struct FUNC_NAME(fp_out) out;
     BOOL trim_tail = FALSE, round_up = FALSE;
-    pf_flags f;
     int limb_len, prec;
     ULONGLONG m;
     DWORD l;
@@ -619,6 +666,34 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
             if(bnum_lshift(b, shift)) e10 += LIMB_DIGITS;
             e2 -= shift;
         }
+        if(e2 < 0 && e2 > -64) {
+            /* The fractional part fits in 64 bits, its limbs can be computed
+             * directly instead of shifting the whole number right. */
+            int bits = -e2;
+            ULONGLONG frac = m & (((ULONGLONG)1 << bits) - 1), lo, hi;
+
+            m >>= bits;
+            b->data[0] = m % LIMB_MAX;
+            b->data[1] = m / LIMB_MAX;
+            if(!b->data[1]) b->e = b->data[0] ? 1 : 0;
+
+            for(; frac; b->b--) {
+                /* frac * LIMB_MAX == hi << 32 | (DWORD)lo */
+                lo = (frac & 0xffffffff) * LIMB_MAX;
+                hi = (frac >> 32) * LIMB_MAX + (lo >> 32);
+                if(bits > 32) {
+                    b->data[bnum_idx(b, b->b-1)] = hi >> (bits - 32);
+                    frac = ((hi & (((ULONGLONG)1 << (bits - 32)) - 1)) << 32) | (lo & 0xffffffff);
+                } else {
+                    b->data[bnum_idx(b, b->b-1)] = lo >> bits;
+                    frac = lo & (((ULONGLONG)1 << bits) - 1);
+                }
+                if(b->e == b->b && !b->data[bnum_idx(b, b->b-1)]) b->e--;
+            }
+            e10 = LIMB_DIGITS * (b->e - 2);
+            e2 = 0;
+        }
+
         while(e2 < 0) {
             int shift = -e2 > 9 ? 9 : -e2;
             if(bnum_rshift(b, shift)) e10 -= LIMB_DIGITS;
@@ -632,10 +707,8 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
         e10 = -LIMB_DIGITS;
     }
 
-    if(!b->data[bnum_idx(b, b->e-1)])
-        first_limb_len = 1;
-    else
-        first_limb_len = floor(log10(b->data[bnum_idx(b, b->e - 1)])) + 1;
+    l = b->data[bnum_idx(b, b->e - 1)];
+    for(first_limb_len = 1; first_limb_len < LIMB_DIGITS && l >= p10s[first_limb_len]; first_limb_len++);
     radix_pos = first_limb_len + LIMB_DIGITS + e10;
 
     round_pos = flags->Precision;
@@ -697,10 +770,8 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
                 else b->data[bnum_idx(b, i+1)] = 1;
             }
             if(i == b->e-1) {
-                if(!b->data[bnum_idx(b, b->e-1)])
-                    i = 1;
-                else
-                    i = floor(log10(b->data[bnum_idx(b, b->e-1)])) + 1;
+                l = b->data[bnum_idx(b, b->e - 1)];
+                for(i = 1; i < LIMB_DIGITS && l >= p10s[i]; i++);
                 if(i != first_limb_len) {
                     first_limb_len = i;
                     radix_pos++;
@@ -816,58 +887,48 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
 
     r = FUNC_NAME(pf_fill)(pf_puts, puts_ctx, len, flags, TRUE);
     if(r < 0) return r;
-    ret = r;
 
-    f.Format = 'd';
-    f.PadZero = TRUE;
+    out.pf_puts = pf_puts;
+    out.puts_ctx = puts_ctx;
+    out.written = r;
+    out.len = 0;
+
     if(flags->Format=='f' || flags->Format=='F') {
-        if(radix_pos <= 0) {
-            buf[0] = '0';
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
-        }
+        if(radix_pos <= 0)
+            FUNC_NAME(fp_out_chars)(&out, '0', 1);
 
         limb_len = LIMB_DIGITS;
         for(i=b->e-1; radix_pos>0 && i>=b->b; i--) {
             limb_len = (i == b->e-1 ? first_limb_len : LIMB_DIGITS);
             l = b->data[bnum_idx(b, i)];
             if(limb_len > radix_pos) {
-                f.Precision = radix_pos;
+                prec = radix_pos;
                 l /= p10s[limb_len - radix_pos];
                 limb_len = limb_len - radix_pos;
             } else {
-                f.Precision = limb_len;
+                prec = limb_len;
                 limb_len = LIMB_DIGITS;
             }
-            radix_pos -= f.Precision;
-            FUNC_NAME(pf_integer_conv)(buf, &f, l);
-
-            r = pf_puts(puts_ctx, f.Precision, buf);
-            if(r < 0) return r;
-            ret += r;
+            radix_pos -= prec;
+            FUNC_NAME(fp_out_digits)(&out, l, prec);
         }
 
-        buf[0] = '0';
-        for(; radix_pos>0; radix_pos--) {
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
+        if(radix_pos > 0) {
+            FUNC_NAME(fp_out_chars)(&out, '0', radix_pos);
+            radix_pos = 0;
         }
 
         if(flags->Precision || flags->Alternate) {
-            buf[0] = *(locale ? locale->locinfo : get_locinfo())->lconv->decimal_point;
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
+            APICHAR dp = *(locale ? locale->locinfo : get_locinfo())->lconv->decimal_point;
+            FUNC_NAME(fp_out_chars)(&out, dp, 1);
         }
 
         prec = flags->Precision;
-        buf[0] = '0';
-        for(; prec>0 && radix_pos+LIMB_DIGITS-first_limb_len<0; radix_pos++, prec--) {
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
+        r = -(radix_pos+LIMB_DIGITS-first_limb_len);
+        if(r > prec) r = prec;
+        if(r > 0) {
+            FUNC_NAME(fp_out_chars)(&out, '0', r);
+            prec -= r;
         }
 
         for(; prec>0 && i>=b->b; i--) {
@@ -875,40 +936,25 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
             if(limb_len != LIMB_DIGITS)
                 l %= p10s[limb_len];
             if(limb_len > prec) {
-                f.Precision = prec;
+                r = prec;
                 l /= p10s[limb_len - prec];
             } else {
-                f.Precision = limb_len;
+                r = limb_len;
                 limb_len = LIMB_DIGITS;
             }
-            prec -= f.Precision;
-            FUNC_NAME(pf_integer_conv)(buf, &f, l);
-
-            r = pf_puts(puts_ctx, f.Precision, buf);
-            if(r < 0) return r;
-            ret += r;
+            prec -= r;
+            FUNC_NAME(fp_out_digits)(&out, l, r);
         }
 
-        buf[0] = '0';
-        for(; prec>0; prec--) {
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
-        }
+        FUNC_NAME(fp_out_chars)(&out, '0', prec);
     } else {
         l = b->data[bnum_idx(b, b->e - 1)];
         l /= p10s[first_limb_len - 1];
-
-        buf[0] = '0' + l;
-        r = pf_puts(puts_ctx, 1, buf);
-        if(r < 0) return r;
-        ret += r;
+        FUNC_NAME(fp_out_digits)(&out, l, 1);
 
         if(flags->Precision || flags->Alternate) {
-            buf[0] = *(locale ? locale->locinfo : get_locinfo())->lconv->decimal_point;
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
+            APICHAR dp = *(locale ? locale->locinfo : get_locinfo())->lconv->decimal_point;
+            FUNC_NAME(fp_out_chars)(&out, dp, 1);
         }
 
         prec = flags->Precision;
@@ -921,42 +967,33 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
             }
 
             if(limb_len > prec) {
-                f.Precision = prec;
+                r = prec;
                 l /= p10s[limb_len - prec];
             } else {
-                f.Precision = limb_len;
+                r = limb_len;
                 limb_len = LIMB_DIGITS;
             }
-            prec -= f.Precision;
-            FUNC_NAME(pf_integer_conv)(buf, &f, l);
-
-            r = pf_puts(puts_ctx, f.Precision, buf);
-            if(r < 0) return r;
-            ret += r;
+            prec -= r;
+            FUNC_NAME(fp_out_digits)(&out, l, r);
         }
 
-        buf[0] = '0';
-        for(; prec>0; prec--) {
-            r = pf_puts(puts_ctx, 1, buf);
-            if(r < 0) return r;
-            ret += r;
-        }
+        FUNC_NAME(fp_out_chars)(&out, '0', prec);
 
         if(!trim_tail || radix_pos) {
-            buf[0] = flags->Format;
-            buf[1] = radix_pos < 0 ? '-' : '+';
-            r = pf_puts(puts_ctx, 2, buf);
-            if(r < 0) return r;
-            ret += r;
-
-            f.Precision = three_digit_exp ? 3 : 2;
-            FUNC_NAME(pf_integer_conv)(buf, &f, radix_pos);
-            r = pf_puts(puts_ctx, f.Precision, buf);
-            if(r < 0) return r;
-            ret += r;
+            FUNC_NAME(fp_out_chars)(&out, flags->Format, 1);
+            FUNC_NAME(fp_out_chars)(&out, radix_pos < 0 ? '-' : '+', 1);
+
+            if(radix_pos < 0) radix_pos = -radix_pos;
+            r = three_digit_exp ? 3 : 2;
+            if(radix_pos > 99) r = 3;
+            FUNC_NAME(fp_out_digits)(&out, radix_pos, r);
         }
     }
 
+    FUNC_NAME(fp_out_flush)(&out);
+    if(out.written < 0) return out.written;
+    ret = out.written;
+
     r = FUNC_NAME(pf_fill)(pf_puts, puts_ctx, len, flags, FALSE);
     if(r < 0) return r;
     ret += r;
@@ -742,6 +742,103 @@ static inline BOOL bnum_to_mant(struct bnum *b, ULONGLONG *m)
     return TRUE;
 }
 
+/* Computes a * b as a 128-bit number */
+static inline void mul_64x64(ULONGLONG a, ULONGLONG b, ULONGLONG *hi, ULONGLONG *lo)
+{
+    ULONGLONG ll = (a & 0xffffffff) * (b & 0xffffffff), lh = (a & 0xffffffff) * (b >> 32);
+    ULONGLONG hl = (a >> 32) * (b & 0xffffffff), hh = (a >> 32) * (b >> 32);
+    ULONGLONG mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+
+    *lo = (mid << 32) | (ll & 0xffffffff);
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+/* Divides 128-bit number by d, returns the remainder */
+static inline DWORD div_128x32(ULONGLONG *hi, ULONGLONG *lo, DWORD d)
+{
+    ULONGLONG r = *hi >> 32, q;
+
+    q = r / d << 32;
+    r = r % d << 32 | (*hi & 0xffffffff);
+    *hi = q | r / d;
+    r = r % d << 32 | *lo >> 32;
+    q = r / d << 32;
+    r = r % d << 32 | (*lo & 0xffffffff);
+    *lo = q | r / d;
+    return r % d;
+}
+
+static inline int bit_length(ULONGLONG v)
+{
+    int ret = 0;
+
+    while(ret < 56 && v >> ret >= 0x100) ret += 8;
+    while(ret < 64 && v >> ret) ret++;
+    return ret;
+}
+
+/* Converts exact value of hi:lo * 2^exp to fpnum, inexact is set if value
+ * was truncated in previous computations */
+static struct fpnum fpnum_from_128(int sign, int exp, ULONGLONG hi, ULONGLONG lo, BOOL inexact)
+{
+    enum fpmod round = FP_ROUND_ZERO;
+    ULONGLONG half, dropped;
+    int shift;
+
+    if(!hi) return fpnum(sign, exp, lo, inexact ? FP_ROUND_DOWN : FP_ROUND_ZERO);
+
+    shift = bit_length(hi);
+    half = (ULONGLONG)1 << (shift - 1);
+    dropped = lo & ((half << 1) - 1);
+    if(dropped > half || (dropped == half && inexact)) round = FP_ROUND_UP;
+    else if(dropped == half) round = FP_ROUND_EVEN;
+    else if(dropped || inexact) round = FP_ROUND_DOWN;
+
+    lo = shift == 64 ? hi : (lo >> shift) | (hi << (64 - shift));
+    return fpnum(sign, exp + shift, lo, round);
+}
+
+/* Exact conversion of m * 10^e10 for small exponents */
+static BOOL fpnum_from_dec(int sign, ULONGLONG m, int e10, struct fpnum *ret)
+{
+    ULONGLONG hi, lo, p5 = 1;
+    int i, bits;
+    DWORD r;
+
+    while(e10 < 0 && !(m % 10)) {
+        m /= 10;
+        e10++;
+    }
+
+    if(e10 >= 0) {
+        if(e10 > 27) return FALSE;
+
+        /* m * 10^e10 == m * 5^e10 * 2^e10 */
+        for(i = 0; i < e10; i++) p5 *= 5;
+        mul_64x64(m, p5, &hi, &lo);
+        *ret = fpnum_from_128(sign, e10, hi, lo, FALSE);
+        return TRUE;
+    }
+
+    if(e10 < -26) return FALSE;
+
+    /* m * 10^e10 == (m << bits) / 5^-e10 * 2^(e10 - bits), the quotient is
+     * at least 2^64 so all the bits needed for rounding are kept */
+    bits = 64 - bit_length(m);
+    hi = m << bits;
+    lo = 0;
+    bits += 64;
+
+    for(i = 0; i < -e10 && i < 13; i++) p5 *= 5;
+    r = div_128x32(&hi, &lo, p5);
+    if(e10 < -13) {
+        for(p5 = 1; i < -e10; i++) p5 *= 5;
+        r |= div_128x32(&hi, &lo, p5);
+    }
+    *ret = fpnum_from_128(sign, e10 - bits, hi, lo, r != 0);
+    return TRUE;
+}
+
 static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
         void *ctx, pthreadlocinfo locinfo, BOOL ldouble, struct bnum *b)
 {
@@ -917,6 +1014,20 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     if(!b->data[bnum_idx(b, b->e-1)])
         return fpnum(sign, 0, 0, 0);
 
+    /* fast path for up to 19 significant digits and small exponents */
+    i = LIMB_DIGITS * (b->e-1 - b->b) + limb_digits;
+    if(i <= 19 && dp > -64 && dp < 64) {
+        struct fpnum ret;
+
+        m = 0;
+        for(off = b->e-1; off > b->b; off--)
+            m = m * LIMB_MAX + b->data[bnum_idx(b, off)];
+        m = m * (limb_digits == LIMB_DIGITS ? LIMB_MAX : p10s[limb_digits]);
+        m += b->data[bnum_idx(b, b->b)];
+        if(fpnum_from_dec(sign, m, dp - i, &ret))
+            return ret;
+    }
+
     /* Fill last limb with 0 if needed */
     if(b->b+1 != b->e) {
         for(; limb_digits != LIMB_DIGITS; limb_digits++)
@@ -927,8 +1038,6 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     }
 
     /* move decimal point to limb boundary */
-    if(limb_digits==dp && b->b==b->e-1)
-        return fpnum(sign, 0, b->data[bnum_idx(b, b->e-1)], FP_ROUND_ZERO);
     off = (dp - limb_digits) % LIMB_DIGITS;
     if(off < 0) off += LIMB_DIGITS;
     if(off) bnum_mult(b, p10s[off]);
@@ -1559,13 +1668,28 @@ int CDECL _atoldbl(_LDOUBLE *value, char *str)
     return _atoldbl_l( (MSVCRT__LDOUBLE*)value, str, NULL );
 }
 
+/* Helpers to scan strings a word at a time. Words are only read from aligned
+ * addresses, so that the scan never crosses into the next page before the
+ * terminator or the searched byte is found. */
+#define WORD_ONES  ((size_t)0x0101010101010101ull)
+#define WORD_HIGHS ((size_t)0x8080808080808080ull)
+
+static inline BOOL word_has_zero_byte(size_t w)
+{
+    return ((w - WORD_ONES) & ~w & WORD_HIGHS) != 0;
+}
+
 /*********************************************************************
  *              strlen (MSVCRT.@)
  */
 size_t __cdecl strlen(const char *str)
 {
     const char *s = str;
-    while (*s) s++;
+    const size_t *w;
+
+    for (; (size_t)s % sizeof(size_t); s++) if (!*s) return s - str;
+    for (w = (const size_t *)s; !word_has_zero_byte(*w); w++);
+    for (s = (const char *)w; *s; s++);
     return s - str;
 }
 
@@ -1576,8 +1700,12 @@ size_t CDECL strnlen(const char *s, size_t maxlen)
 {
     size_t i;
 
-    for(i=0; i<maxlen; i++)
-        if(!s[i]) break;
+    for (i = 0; i < maxlen && (size_t)(s + i) % sizeof(size_t); i++)
+        if (!s[i]) return i;
+    for (; maxlen - i >= sizeof(size_t); i += sizeof(size_t))
+        if (word_has_zero_byte(*(const size_t *)(s + i))) break;
+    for (; i < maxlen; i++)
+        if (!s[i]) break;
 
     return i;
 }
@@ -3177,6 +3305,15 @@ void * __cdecl _memccpy(void *dst, const void *src, int c, size_t n)
 static inline void memset_aligned_32(unsigned char *d, uint64_t v, size_t n)
 {
     unsigned char *end = d + n;
+
+#if defined(__i386__) || defined(__x86_64__)
+    if (n >= 2048 && erms_supported)
+    {
+        unsigned char c = v;
+        __asm__ __volatile__ ("cld; rep; stosb" : "+D"(d), "+c"(n) : "a"(c) : "memory", "cc");
+        return;
+    }
+#endif
     while (d < end)
     {
         *(uint64_t *)(d + 0) = v;
@@ -3248,11 +3385,20 @@ void *__cdecl memset(void *dst, int c, size_t n)
  */
 char* __cdecl strchr(const char *str, int c)
 {
-    do
+    size_t v = WORD_ONES * (unsigned char)c;
+    const size_t *w;
+
+    for (; (size_t)str % sizeof(size_t); str++)
     {
         if (*str == (char)c) return (char*)str;
-    } while (*str++);
-    return NULL;
+        if (!*str) return NULL;
+    }
+    for (w = (const size_t *)str; !word_has_zero_byte(*w) && !word_has_zero_byte(*w ^ v); w++);
+    for (str = (const char *)w;; str++)
+    {
+        if (*str == (char)c) return (char*)str;
+        if (!*str) return NULL;
+    }
 }
 
 /*********************************************************************
@@ -3270,9 +3416,15 @@ char* __cdecl strrchr(const char *str, int c)
  */
 void* __cdecl memchr(const void *ptr, int c, size_t n)
 {
+    size_t v = WORD_ONES * (unsigned char)c;
     const unsigned char *p = ptr;
 
-    for (p = ptr; n; n--, p++) if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n && (size_t)p % sizeof(size_t); n--, p++)
+        if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n >= sizeof(size_t); n -= sizeof(size_t), p += sizeof(size_t))
+        if (word_has_zero_byte(*(const size_t *)p ^ v)) break;
+    for (; n; n--, p++)
+        if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
     return NULL;
 }
 
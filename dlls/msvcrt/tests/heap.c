@@ -19,6 +19,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <malloc.h>
 #include <errno.h>
 #include "wine/test.h"
@@ -494,6 +495,81 @@ static void test_calloc(void)
     free(ptr);
 }
 
+static DWORD WINAPI free_blocks_thread(void *arg)
+{
+    void **blocks = arg;
+    unsigned int i;
+
+    for (i = 0; i < 64; i++)
+        free(blocks[i]);
+    for (i = 0; i < 64; i++)
+        blocks[i] = malloc(i + 1);
+    return 0;
+}
+
+static void test_small_blocks(void)
+{
+    /* use function pointer to bypass gcc builtin */
+    void *(__cdecl *p_calloc)(size_t, size_t);
+    void *blocks[64];
+    unsigned char *mem;
+    unsigned int i, j;
+    HANDLE thread;
+    size_t size;
+
+    p_calloc = (void *)GetProcAddress( GetModuleHandleA("msvcrt.dll"), "calloc");
+
+    for (i = 1; i <= 300; i++)
+    {
+        winetest_push_context("%u", i);
+
+        mem = malloc(i);
+        ok(mem != NULL, "malloc failed\n");
+        memset(mem, 0xcc, i);
+        free(mem);
+
+        mem = p_calloc(1, i);
+        ok(mem != NULL, "calloc failed\n");
+        size = _msize(mem);
+        ok(size == i, "_msize returned %Iu\n", size);
+        for (j = 0; j < i; j++)
+            if (mem[j]) break;
+        ok(j == i, "byte %u not zeroed\n", j);
+        free(mem);
+
+        mem = malloc(i + 1);
+        ok(mem != NULL, "malloc failed\n");
+        size = _msize(mem);
+        ok(size == i + 1, "_msize returned %Iu\n", size);
+        free(mem);
+
+        winetest_pop_context();
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+        blocks[i] = malloc(i + 1);
+        ok(blocks[i] != NULL, "malloc failed\n");
+    }
+    thread = CreateThread(NULL, 0, free_blocks_thread, blocks, 0, NULL);
+    ok(thread != NULL, "CreateThread failed\n");
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+
+    for (i = 0; i < 64; i++)
+    {
+        ok(blocks[i] != NULL, "malloc failed\n");
+        size = _msize(blocks[i]);
+        ok(size == i + 1, "%u: _msize returned %Iu\n", i, size);
+        free(blocks[i]);
+
+        mem = malloc(i + 1);
+        size = _msize(mem);
+        ok(size == i + 1, "%u: _msize returned %Iu\n", i, size);
+        free(mem);
+    }
+}
+
 START_TEST(heap)
 {
     void *mem;
@@ -519,4 +595,5 @@ START_TEST(heap)
     test_aligned();
     test_sbheap();
     test_calloc();
+    test_small_blocks();
 }
@@ -458,7 +458,7 @@ static void test_fprintf(void)
 {
     FILE *fp = fopen("fprintf.tst", "wb");
     char buf[1024];
-    int ret;
+    int i, ret;
 
     ret = fprintf(fp, "simple test\n");
     ok(ret == 12, "ret = %d\n", ret);
@@ -533,6 +533,26 @@ static void test_fprintf(void)
     ok(ret == 37, "ret =  %d\n", ret);
     ok(!strcmp(buf, "unicode\r\n"), "buf = %s\n", buf);
 
+    fclose(fp);
+
+    fp = fopen("fprintf.tst", "wb");
+    for (i = 0; i < 200; i++)
+    {
+        ret = fprintf(fp, "%5d|%-40s|%0*d|%*s\n", i, "left", i % 70, i, i, "");
+        ok(ret == sprintf(buf, "%5d|%-40s|%0*d|%*s\n", i, "left", i % 70, i, i, ""),
+                "%d: ret = %d\n", i, ret);
+    }
+    fclose(fp);
+
+    fp = fopen("fprintf.tst", "rb");
+    for (i = 0; i < 200; i++)
+    {
+        char expect[1024];
+
+        sprintf(expect, "%5d|%-40s|%0*d|%*s\n", i, "left", i % 70, i, i, "");
+        fgets(buf, sizeof(buf), fp);
+        ok(!strcmp(buf, expect), "%d: buf = %s\n", i, buf);
+    }
     fclose(fp);
     unlink("fprintf.tst");
 }
@@ -1844,6 +1844,74 @@ static void test_strnlen(void)
     ok(res == 0, "Returned length = %d\n", (int)res);
 }
 
+static void test_string_scan(void)
+{
+    size_t (__cdecl *p_strlen)(const char *);
+    char * (__cdecl *p_strchr)(const char *, int);
+    void * (__cdecl *p_memchr)(const void *, int, size_t);
+    size_t (__cdecl *p_wcslen)(const wchar_t *);
+    unsigned int len, tail;
+    char *mem, *str, *p;
+    wchar_t *wstr;
+    DWORD prot;
+    size_t res;
+
+    p_strlen = (void *)GetProcAddress(hMsvcrt, "strlen");
+    p_strchr = (void *)GetProcAddress(hMsvcrt, "strchr");
+    p_memchr = (void *)GetProcAddress(hMsvcrt, "memchr");
+    p_wcslen = (void *)GetProcAddress(hMsvcrt, "wcslen");
+
+    /* strings ending right before an inaccessible page */
+    mem = VirtualAlloc(NULL, 0x2000, MEM_COMMIT, PAGE_READWRITE);
+    ok(mem != NULL, "VirtualAlloc failed\n");
+    ok(VirtualProtect(mem + 0x1000, 0x1000, PAGE_NOACCESS, &prot), "VirtualProtect failed\n");
+
+    for (len = 0; len < 40; len++)
+    {
+        for (tail = 0; tail < 2 * sizeof(size_t); tail++)
+        {
+            winetest_push_context("len %u, tail %u", len, tail);
+
+            str = mem + 0x1000 - len - 1 - tail;
+            memset(str, 'a', len);
+            memset(str + len, 0, tail + 1);
+            if (len) str[len - 1] = 'b';
+
+            res = p_strlen(str);
+            ok(res == len, "strlen returned %Iu\n", res);
+            if (p_strnlen)
+            {
+                res = p_strnlen(str, len + tail + 1);
+                ok(res == len, "strnlen returned %Iu\n", res);
+                res = p_strnlen(str, len / 2);
+                ok(res == len / 2, "strnlen returned %Iu\n", res);
+            }
+
+            p = p_strchr(str, 'b');
+            ok(p == (len ? str + len - 1 : NULL), "strchr returned %p, str %p\n", p, str);
+            p = p_strchr(str, 'c');
+            ok(!p, "strchr returned %p\n", p);
+            p = p_strchr(str, 0);
+            ok(p == str + len, "strchr returned %p, str %p\n", p, str);
+
+            p = p_memchr(str, 'b', len + tail + 1);
+            ok(p == (len ? str + len - 1 : NULL), "memchr returned %p, str %p\n", p, str);
+            p = p_memchr(str, 'c', len + tail + 1);
+            ok(!p, "memchr returned %p\n", p);
+
+            wstr = (wchar_t *)(mem + 0x1000) - len - 1 - tail;
+            memset(wstr, 0, (len + tail + 1) * sizeof(wchar_t));
+            for (res = 0; res < len; res++) wstr[res] = 0x100 + res;
+            res = p_wcslen(wstr);
+            ok(res == len, "wcslen returned %Iu\n", res);
+
+            winetest_pop_context();
+        }
+    }
+
+    VirtualFree(mem, 0, MEM_RELEASE);
+}
+
 static void test__strtoi64(void)
 {
     static const char no1[] = "31923";
@@ -4727,6 +4795,7 @@ START_TEST(string)
     test__wcsupr_s();
     test_strtol();
     test_strnlen();
+    test_string_scan();
     test__strtoi64();
     test__strtod();
     test_mbstowcs();
@@ -2900,14 +2900,31 @@ __msvcrt_ulong __cdecl wcstoul(const wchar_t *s, wchar_t **end, int base)
     return _wcstoul_l(s, end, base, NULL);
 }
 
+/* Helpers to scan wide strings a word at a time, see strlen(). Misaligned
+ * strings are scanned a character at a time. */
+#define WCHAR_ONES  ((size_t)0x0001000100010001ull)
+#define WCHAR_HIGHS ((size_t)0x8000800080008000ull)
+
+static inline BOOL word_has_zero_wchar(size_t w)
+{
+    return ((w - WCHAR_ONES) & ~w & WCHAR_HIGHS) != 0;
+}
+
 /******************************************************************
  *  wcsnlen (MSVCRT.@)
  */
 size_t CDECL wcsnlen(const wchar_t *s, size_t maxlen)
 {
-    size_t i;
+    size_t i = 0;
 
-    for (i = 0; i < maxlen; i++)
+    if (!((size_t)s % sizeof(wchar_t)))
+    {
+        for (; i < maxlen && (size_t)(s + i) % sizeof(size_t); i++)
+            if (!s[i]) return i;
+        for (; maxlen - i >= sizeof(size_t) / sizeof(wchar_t); i += sizeof(size_t) / sizeof(wchar_t))
+            if (word_has_zero_wchar(*(const size_t *)(s + i))) break;
+    }
+    for (; i < maxlen; i++)
         if (!s[i]) break;
     return i;
 }
@@ -2969,6 +2986,14 @@ wchar_t* CDECL wcsrchr(const wchar_t *str, wchar_t ch)
 size_t CDECL wcslen(const wchar_t *str)
 {
     const wchar_t *s = str;
+    const size_t *w;
+
+    if (!((size_t)s % sizeof(wchar_t)))
+    {
+        for (; (size_t)s % sizeof(size_t); s++) if (!*s) return s - str;
+        for (w = (const size_t *)s; !word_has_zero_wchar(*w); w++);
+        s = (const wchar_t *)w;
+    }
     while (*s) s++;
     return s - str;
 }
@@ -124,6 +124,16 @@ static inline int get_utf16( const WCHAR *src, unsigned int srclen, unsigned int
 }
 
 
+/* check whether the 8 bytes at an aligned address are all 7-bit ASCII */
+static inline BOOL is_ascii_block( const void *ptr, UINT64 mask )
+{
+    return !((UINT_PTR)ptr & 7) && !(*(const UINT64 *)ptr & mask);
+}
+
+#define ASCII_MASK_A 0x8080808080808080ull
+#define ASCII_MASK_W 0xff80ff80ff80ff80ull
+
+
 static inline void put_utf16( WCHAR *dst, unsigned int ch )
 {
     if (ch >= 0x10000)
@@ -316,6 +326,14 @@ static inline NTSTATUS utf8_wcstombs_size( const WCHAR *src, unsigned int srclen
 
     for (len = 0; srclen; srclen--, src++)
     {
+        while (srclen >= 4 && is_ascii_block( src, ASCII_MASK_W ))
+        {
+            len += 4;
+            src += 4;
+            srclen -= 4;
+        }
+        if (!srclen) break;
+
         if (*src < 0x80) len++;  /* 0x00-0x7f: 1 byte */
         else if (*src < 0x800) len += 2;  /* 0x80-0x7ff: 2 bytes */
         else
@@ -348,7 +366,15 @@ static inline NTSTATUS utf8_mbstowcs_size( const char *src, unsigned int srclen,
     for (len = 0; src < srcend; len++)
     {
         unsigned char ch = *src++;
-        if (ch < 0x80) continue;
+        if (ch < 0x80)
+        {
+            while (srcend - src >= 8 && is_ascii_block( src, ASCII_MASK_A ))
+            {
+                len += 8;
+                src += 8;
+            }
+            continue;
+        }
         if ((res = decode_utf8_char( ch, &src, srcend )) > 0x10ffff)
             status = STATUS_SOME_NOT_MAPPED;
         else
@@ -433,6 +459,20 @@ static inline NTSTATUS utf8_mbstowcs( WCHAR *dst, unsigned int dstlen, unsigned
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
             *dst++ = ch;
+            /* then convert 8 chars at a time while the source is aligned and plain ASCII */
+            while (srcend - src >= 8 && dstend - dst >= 8 && is_ascii_block( src, ASCII_MASK_A ))
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = src[3];
+                dst[4] = src[4];
+                dst[5] = src[5];
+                dst[6] = src[6];
+                dst[7] = src[7];
+                dst += 8;
+                src += 8;
+            }
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
@@ -467,7 +507,22 @@ static inline NTSTATUS utf8_wcstombs( char *dst, unsigned int dstlen, unsigned i
 
     for (end = dst + dstlen; srclen; srclen--, src++)
     {
-        WCHAR ch = *src;
+        WCHAR ch;
+
+        /* convert 4 chars at a time while the source is aligned and plain ASCII */
+        while (srclen >= 4 && end - dst >= 4 && is_ascii_block( src, ASCII_MASK_W ))
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = src[3];
+            dst += 4;
+            src += 4;
+            srclen -= 4;
+        }
+        if (!srclen) break;
+
+        ch = *src;
 
         if (ch < 0x80)  /* 0x00-0x7f: 1 byte */
         {
@@ -2279,6 +2279,67 @@ exit:
     RegCloseKey(clsidkey);
 }
 
+static void test_CoGetClassObject_registry_change(void)
+{
+    static const GUID deadbeef = {0xdeadbeef,0xdead,0xbeef,{0xde,0xad,0xbe,0xef,0xde,0xad,0xbe,0xef}};
+    static const char deadbeefA[] = "{DEADBEEF-DEAD-BEEF-DEAD-BEEFDEADBEEF}";
+    static const char dllA[] = "nonexistent_inproc_server.dll";
+    HKEY clsidkey, deadbeefkey, inprockey;
+    IUnknown *unk;
+    DWORD start;
+    HRESULT hr;
+    LONG lr;
+    int i;
+
+    CoInitialize(NULL);
+
+    start = GetTickCount();
+    for (i = 0; i < 1000; i++)
+    {
+        hr = CoGetClassObject(&CLSID_StdFont, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+        if (hr != S_OK) break;
+        IUnknown_Release(unk);
+    }
+    ok(hr == S_OK, "got %#lx\n", hr);
+    trace("%d class object lookups in %lu ms\n", i, GetTickCount() - start);
+
+    hr = CoGetClassObject(&deadbeef, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr == REGDB_E_CLASSNOTREG, "got %#lx\n", hr);
+
+    lr = RegOpenKeyExA(HKEY_CLASSES_ROOT, "CLSID", 0, KEY_READ, &clsidkey);
+    ok(!lr, "Couldn't open CLSID key, error %ld\n", lr);
+    lr = RegCreateKeyExA(clsidkey, deadbeefA, 0, NULL, 0, KEY_ALL_ACCESS, NULL, &deadbeefkey, NULL);
+    if (lr)
+    {
+        win_skip("failed to create a test key, error %ld\n", lr);
+        RegCloseKey(clsidkey);
+        CoUninitialize();
+        return;
+    }
+
+    /* a new registration is seen straight away */
+    lr = RegCreateKeyExA(deadbeefkey, "InprocServer32", 0, NULL, 0, KEY_ALL_ACCESS, NULL, &inprockey, NULL);
+    ok(!lr, "RegCreateKeyEx returned %ld\n", lr);
+    lr = RegSetValueExA(inprockey, NULL, 0, REG_SZ, (const BYTE *)dllA, sizeof(dllA));
+    ok(!lr, "RegSetValueEx returned %ld\n", lr);
+    RegCloseKey(inprockey);
+
+    hr = CoGetClassObject(&deadbeef, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr != REGDB_E_CLASSNOTREG && hr != S_OK, "got %#lx\n", hr);
+
+    /* and so is its removal */
+    lr = RegDeleteKeyA(deadbeefkey, "InprocServer32");
+    ok(!lr, "RegDeleteKey returned %ld\n", lr);
+    hr = CoGetClassObject(&deadbeef, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr == REGDB_E_CLASSNOTREG, "got %#lx\n", hr);
+
+    RegCloseKey(deadbeefkey);
+    RegDeleteKeyA(clsidkey, deadbeefA);
+    RegCloseKey(clsidkey);
+
+    CoUninitialize();
+}
+
 static void test_CoInitializeEx(void)
 {
     HRESULT hr;
@@ -4387,6 +4448,7 @@ START_TEST(compobj)
     test_CoCreateInstance();
     test_ole_menu();
     test_CoGetClassObject();
+    test_CoGetClassObject_registry_change();
     test_CoCreateInstanceEx();
     test_CoRegisterMessageFilter();
     test_CoRegisterPSClsid();
@@ -2795,6 +2795,97 @@ static const IUnknownVtbl HeapUnknown_Vtbl =
     HeapUnknown_Release
 };
 
+static void read_std_objref(IStream *stream, STDOBJREF *stdobjref)
+{
+    OBJREF objref;
+    DWORD size, read;
+    HRESULT hr;
+
+    hr = IStream_Seek(stream, ullZero, STREAM_SEEK_SET, NULL);
+    ok_ole_success(hr, IStream_Seek);
+    size = FIELD_OFFSET(OBJREF, u_objref.u_standard.saResAddr);
+    hr = IStream_Read(stream, &objref, size, &read);
+    ok_ole_success(hr, IStream_Read);
+    ok(read == size, "read = %ld, expected %ld\n", read, size);
+    ok(objref.flags == OBJREF_STANDARD, "objref.flags = %lx\n", objref.flags);
+    *stdobjref = objref.u_objref.u_standard.std;
+    hr = IStream_Seek(stream, ullZero, STREAM_SEEK_SET, NULL);
+    ok_ole_success(hr, IStream_Seek);
+}
+
+/* exported objects must still be found by object and by OID when there are many of them */
+static void test_many_exported_objects(void)
+{
+    static const unsigned int count = 300;
+    STDOBJREF stdobjref;
+    HeapUnknown **objects;
+    IStream **streams;
+    IStream *stream;
+    IUnknown *unk;
+    unsigned int i;
+    HRESULT hr;
+    OID *oids;
+
+    objects = HeapAlloc(GetProcessHeap(), 0, count * sizeof(*objects));
+    streams = HeapAlloc(GetProcessHeap(), 0, count * sizeof(*streams));
+    oids = HeapAlloc(GetProcessHeap(), 0, count * sizeof(*oids));
+    for (i = 0; i < count; i++)
+    {
+        objects[i] = HeapAlloc(GetProcessHeap(), 0, sizeof(**objects));
+        objects[i]->IUnknown_iface.lpVtbl = &HeapUnknown_Vtbl;
+        objects[i]->refs = 1;
+
+        hr = CreateStreamOnHGlobal(NULL, TRUE, &streams[i]);
+        ok_ole_success(hr, CreateStreamOnHGlobal);
+        hr = CoMarshalInterface(streams[i], &IID_IUnknown, &objects[i]->IUnknown_iface, MSHCTX_INPROC, NULL,
+                                MSHLFLAGS_TABLESTRONG);
+        ok(hr == S_OK, "CoMarshalInterface failed for object %u, hr %#lx\n", i, hr);
+        read_std_objref(streams[i], &stdobjref);
+        oids[i] = stdobjref.oid;
+        ok(!i || oids[i] != oids[i - 1], "object %u has the same OID as the previous one\n", i);
+    }
+
+    /* marshaling an object again must find its existing stub manager */
+    for (i = 0; i < count; i++)
+    {
+        hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+        ok_ole_success(hr, CreateStreamOnHGlobal);
+        hr = CoMarshalInterface(stream, &IID_IUnknown, &objects[i]->IUnknown_iface, MSHCTX_INPROC, NULL,
+                                MSHLFLAGS_NORMAL);
+        ok(hr == S_OK, "CoMarshalInterface failed for object %u, hr %#lx\n", i, hr);
+        read_std_objref(stream, &stdobjref);
+        ok(stdobjref.oid == oids[i], "object %u: got OID %s, expected %s\n", i,
+           wine_dbgstr_longlong(stdobjref.oid), wine_dbgstr_longlong(oids[i]));
+        hr = CoReleaseMarshalData(stream);
+        ok(hr == S_OK, "CoReleaseMarshalData failed for object %u, hr %#lx\n", i, hr);
+        IStream_Release(stream);
+    }
+
+    /* unmarshaling in the same apartment must find the object itself */
+    for (i = 0; i < count; i++)
+    {
+        hr = CoUnmarshalInterface(streams[i], &IID_IUnknown, (void **)&unk);
+        ok(hr == S_OK, "CoUnmarshalInterface failed for object %u, hr %#lx\n", i, hr);
+        if (hr != S_OK) continue;
+        ok(unk == &objects[i]->IUnknown_iface, "object %u: got %p, expected %p\n", i, unk,
+           &objects[i]->IUnknown_iface);
+        IUnknown_Release(unk);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        IStream_Seek(streams[i], ullZero, STREAM_SEEK_SET, NULL);
+        hr = CoReleaseMarshalData(streams[i]);
+        ok(hr == S_OK, "CoReleaseMarshalData failed for object %u, hr %#lx\n", i, hr);
+        IStream_Release(streams[i]);
+        ok(objects[i]->refs == 1, "object %u has %lu references\n", i, objects[i]->refs);
+        IUnknown_Release(&objects[i]->IUnknown_iface);
+    }
+    HeapFree(GetProcessHeap(), 0, oids);
+    HeapFree(GetProcessHeap(), 0, streams);
+    HeapFree(GetProcessHeap(), 0, objects);
+}
+
 static void test_proxybuffer(REFIID riid)
 {
     HRESULT hr;
@@ -4601,6 +4692,7 @@ START_TEST(marshal)
         test_tablestrong_marshal_and_unmarshal_twice();
         test_lock_object_external();
         test_disconnect_stub();
+        test_many_exported_objects();
         test_normal_marshal_and_unmarshal_twice();
 
         with_external_conn = !with_external_conn;
@@ -1933,6 +1933,52 @@ static void test_inheritance(void)
     return;
 }
 
+/* the dual view of a type info must work before any of its members were accessed */
+static void test_dual_typeinfo_fresh(void)
+{
+    ITypeInfo *ti, *dual_ti;
+    WCHAR path[MAX_PATH];
+    ITypeLib *typelib;
+    TYPEATTR *attr;
+    FUNCDESC *desc;
+    HRESULT hr;
+
+    GetModuleFileNameW(NULL, path, MAX_PATH);
+    hr = LoadTypeLib(path, &typelib);
+    if (FAILED(hr)) return;
+
+    hr = ITypeLib_GetTypeInfoOfGuid(typelib, &IID_ItestIF13, &ti);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+
+    hr = ITypeInfo_GetRefTypeInfo(ti, -1, &dual_ti);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+    hr = ITypeInfo_GetTypeAttr(dual_ti, &attr);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+    ok(attr->typekind == TKIND_INTERFACE, "kind %04x\n", attr->typekind);
+    ITypeInfo_ReleaseTypeAttr(dual_ti, attr);
+    hr = ITypeInfo_GetFuncDesc(dual_ti, 0, &desc);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+    ITypeInfo_ReleaseFuncDesc(dual_ti, desc);
+    ITypeInfo_Release(dual_ti);
+
+    hr = ITypeInfo_GetFuncDesc(ti, 9, &desc);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+    ok(desc->memid == 0x1236, "memid %08lx\n", desc->memid);
+    ITypeInfo_ReleaseFuncDesc(ti, desc);
+    ITypeInfo_Release(ti);
+
+    /* other type infos are still decoded correctly afterwards */
+    hr = ITypeLib_GetTypeInfoOfGuid(typelib, &IID_ItestIF5, &ti);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+    hr = ITypeInfo_GetFuncDesc(ti, 6, &desc);
+    ok(hr == S_OK, "hr %08lx\n", hr);
+    ok(desc->memid == 0x1234, "memid %08lx\n", desc->memid);
+    ITypeInfo_ReleaseFuncDesc(ti, desc);
+    ITypeInfo_Release(ti);
+
+    ITypeLib_Release(typelib);
+}
+
 static void test_CreateTypeLib(SYSKIND sys) {
     static OLECHAR typelibW[] = {'t','y','p','e','l','i','b',0};
     static OLECHAR helpfileW[] = {'C',':','\\','b','o','g','u','s','.','h','l','p',0};
@@ -7075,7 +7121,7 @@ static void test_register_typelib_64(void)
 
 static void test_LoadTypeLib(void)
 {
-    ITypeLib *tl;
+    ITypeLib *tl, *tl2;
     HRESULT hres;
 
     static const WCHAR kernel32_dllW[] = {'k','e','r','n','e','l','3','2','.','d','l','l',0};
@@ -7098,6 +7144,15 @@ static void test_LoadTypeLib(void)
     hres = LoadTypeLibEx(NULL, REGKIND_NONE, &tl);
     ok(hres == E_INVALIDARG, "Got %#lx.\n", hres);
     ok(tl == (void *)0xdeadbeef, "Got %p.\n", tl);
+
+    /* loading the same file again returns the already loaded instance */
+    hres = LoadTypeLib(wszStdOle2, &tl);
+    ok(hres == S_OK, "Got %#lx.\n", hres);
+    hres = LoadTypeLib(wszStdOle2, &tl2);
+    ok(hres == S_OK, "Got %#lx.\n", hres);
+    ok(tl == tl2, "Got %p and %p.\n", tl, tl2);
+    ITypeLib_Release(tl2);
+    ITypeLib_Release(tl);
 }
 
 static void test_SetVarHelpContext(void)
@@ -8563,6 +8618,7 @@ START_TEST(typelib)
     test_CreateTypeLib(SYS_WIN32);
     test_SetTypeDescAlias(SYS_WIN32);
     test_inheritance();
+    test_dual_typeinfo_fresh();
     test_SetVarHelpContext();
     test_SetFuncAndParamNames();
     test_SetDocString();
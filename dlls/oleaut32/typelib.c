@@ -1104,6 +1104,12 @@ typedef struct tagITypeLibImpl
     struct list ref_list;       /* list of ref types in this typelib */
     HREFTYPE dispatch_href;     /* reference to IDispatch, -1 if unused */
 
+    /* MSFT image kept mapped until the members of every type info are decoded */
+    IUnknown *image_file;
+    void *image;
+    DWORD image_length;
+    MSFT_SegDir image_segdir;
+    LONG pending_members;       /* number of type infos with undecoded members */
 
     /* typelibs are cached, keyed by path and index, so store the linked list info within them */
     struct list entry;
@@ -1136,7 +1142,7 @@ static inline ITypeLibImpl *impl_from_ICreateTypeLib2( ICreateTypeLib2 *iface )
 }
 
 /* ITypeLib methods */
-static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength);
+static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength, IUnknown *file);
 static ITypeLib2* ITypeLib2_Constructor_SLTG(LPVOID pLib, DWORD dwTLBLength);
 
 /*======================= ITypeInfo implementation =======================*/
@@ -1238,6 +1244,10 @@ typedef struct tagITypeInfoImpl
     /* variables  */
     TLBVarDesc *vardescs;
 
+    /* members of MSFT type infos are decoded on first use */
+    INIT_ONCE members_once;
+    int memoffset;              /* offset of the undecoded member records, -1 if none */
+
     /* Implemented Interfaces  */
     TLBImplType *impltypes;
 
@@ -1271,6 +1281,7 @@ static const ICreateTypeInfo2Vtbl CreateTypeInfo2Vtbl;
 
 static ITypeInfoImpl* ITypeInfoImpl_Constructor(void);
 static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This);
+static void TLB_load_members(ITypeInfoImpl *This);
 
 typedef struct tagTLBContext
 {
@@ -1547,9 +1558,14 @@ static void dump_TypeInfo(const ITypeInfoImpl * pty)
     TRACE("wTypeFlags: 0x%04x\n", pty->typeattr.wTypeFlags);
     TRACE("parent tlb:%p index in TLB:%u\n",pty->pTypeLib, pty->index);
     if (pty->typeattr.typekind == TKIND_MODULE) TRACE("dllname:%s\n", debugstr_w(TLB_get_bstr(pty->DllName)));
-    if (TRACE_ON(ole))
-        dump_TLBFuncDesc(pty->funcdescs, pty->typeattr.cFuncs);
-    dump_TLBVarDesc(pty->vardescs, pty->typeattr.cVars);
+    if (pty->memoffset != -1)
+        TRACE("members not decoded yet\n");
+    else
+    {
+        if (TRACE_ON(ole))
+            dump_TLBFuncDesc(pty->funcdescs, pty->typeattr.cFuncs);
+        dump_TLBVarDesc(pty->vardescs, pty->typeattr.cVars);
+    }
     dump_TLBImplType(pty->impltypes, pty->typeattr.cImplTypes);
 }
 
@@ -1660,6 +1676,8 @@ static inline TLBFuncDesc *TLB_get_funcdesc_by_memberid(ITypeInfoImpl *typeinfo,
 {
     int i;
 
+    TLB_load_members(typeinfo);
+
     for (i = 0; i < typeinfo->typeattr.cFuncs; ++i)
     {
         if (typeinfo->funcdescs[i].funcdesc.memid == memid)
@@ -1673,6 +1691,8 @@ static inline TLBFuncDesc *TLB_get_funcdesc_by_memberid_invkind(ITypeInfoImpl *t
 {
     int i;
 
+    TLB_load_members(typeinfo);
+
     for (i = 0; i < typeinfo->typeattr.cFuncs; ++i)
     {
         if (typeinfo->funcdescs[i].funcdesc.memid == memid && typeinfo->funcdescs[i].funcdesc.invkind == invkind)
@@ -1686,6 +1706,8 @@ static inline TLBVarDesc *TLB_get_vardesc_by_memberid(ITypeInfoImpl *typeinfo, M
 {
     int i;
 
+    TLB_load_members(typeinfo);
+
     for (i = 0; i < typeinfo->typeattr.cVars; ++i)
     {
         if (typeinfo->vardescs[i].vardesc.memid == memid)
@@ -1699,6 +1721,8 @@ static inline TLBVarDesc *TLB_get_vardesc_by_name(ITypeInfoImpl *typeinfo, const
 {
     int i;
 
+    TLB_load_members(typeinfo);
+
     for (i = 0; i < typeinfo->typeattr.cVars; ++i)
     {
         if (!lstrcmpiW(TLB_get_bstr(typeinfo->vardescs[i].Name), name))
@@ -2654,6 +2678,48 @@ static void TLB_fix_32on64_typeinfo(ITypeInfoImpl *info)
 }
 #endif
 
+static BOOL WINAPI TLB_decode_members(INIT_ONCE *once, void *param, void **context)
+{
+    ITypeInfoImpl *This = param;
+    ITypeLibImpl *lib = This->pTypeLib;
+    TLBContext cx;
+
+    if (This->memoffset == -1) return TRUE;
+
+    TRACE_(typelib)("decoding members of %p\n", This);
+
+    cx.oStart = 0;
+    cx.pos = 0;
+    cx.length = lib->image_length;
+    cx.mapping = lib->image;
+    cx.pTblDir = &lib->image_segdir;
+    cx.pLibInfo = lib;
+
+    if (This->typeattr.cFuncs > 0)
+        MSFT_DoFuncs(&cx, This, This->typeattr.cFuncs, This->typeattr.cVars,
+                     This->memoffset, &This->funcdescs);
+    if (This->typeattr.cVars > 0)
+        MSFT_DoVars(&cx, This, This->typeattr.cFuncs, This->typeattr.cVars,
+                    This->memoffset, &This->vardescs);
+    This->memoffset = -1;
+
+    if (!InterlockedDecrement(&lib->pending_members))
+    {
+        TRACE_(typelib)("all members of %p decoded, releasing image\n", lib);
+        IUnknown_Release(lib->image_file);
+        lib->image_file = NULL;
+        lib->image = NULL;
+    }
+    return TRUE;
+}
+
+/* Decodes the functions and variables of a type info loaded from an MSFT
+ * image. Must be called before accessing funcdescs or vardescs. */
+static void TLB_load_members(ITypeInfoImpl *This)
+{
+    InitOnceExecuteOnce(&This->members_once, TLB_decode_members, This, NULL);
+}
+
 /*
  * process a typeinfo record
  */
@@ -2713,16 +2779,12 @@ static ITypeInfoImpl * MSFT_DoTypeInfo(
 /* note: InfoType's Help file and HelpStringDll come from the containing
  * library. Further HelpString and Docstring appear to be the same thing :(
  */
-    /* functions */
-    if(ptiRet->typeattr.cFuncs >0 )
-        MSFT_DoFuncs(pcx, ptiRet, ptiRet->typeattr.cFuncs,
-		    ptiRet->typeattr.cVars,
-		    tiBase.memoffset, &ptiRet->funcdescs);
-    /* variables */
-    if(ptiRet->typeattr.cVars >0 )
-        MSFT_DoVars(pcx, ptiRet, ptiRet->typeattr.cFuncs,
-		   ptiRet->typeattr.cVars,
-		   tiBase.memoffset, &ptiRet->vardescs);
+    /* functions and variables are decoded by TLB_load_members() on first use */
+    if (ptiRet->typeattr.cFuncs > 0 || ptiRet->typeattr.cVars > 0)
+    {
+        ptiRet->memoffset = tiBase.memoffset;
+        pLibInfo->pending_members++;
+    }
     if(ptiRet->typeattr.cImplTypes >0 ) {
         switch(ptiRet->typeattr.typekind)
         {
@@ -3364,7 +3426,7 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
         {
             DWORD dwSignature = FromLEDWord(*((DWORD*) pBase));
             if (dwSignature == MSFT_SIGNATURE)
-                *ppTypeLib = ITypeLib2_Constructor_MSFT(pBase, dwTLBLength);
+                *ppTypeLib = ITypeLib2_Constructor_MSFT(pBase, dwTLBLength, pFile);
             else if (dwSignature == SLTG_SIGNATURE)
                 *ppTypeLib = ITypeLib2_Constructor_SLTG(pBase, dwTLBLength);
             else
@@ -3381,14 +3443,28 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
     if(*ppTypeLib) {
 	ITypeLibImpl *impl = impl_from_ITypeLib2(*ppTypeLib);
 
+        /* Another thread may have loaded the same file while we were parsing
+         * it; share its instance instead of keeping a second copy around. */
+        EnterCriticalSection(&cache_section);
+        LIST_FOR_EACH_ENTRY(entry, &tlb_cache, ITypeLibImpl, entry)
+        {
+            if (!wcsicmp(entry->path, pszPath) && entry->index == index)
+            {
+                TRACE("lost the race, using cached instance\n");
+                ITypeLib2_AddRef(&entry->ITypeLib2_iface);
+                LeaveCriticalSection(&cache_section);
+                ITypeLib2_Release(*ppTypeLib);
+                *ppTypeLib = &entry->ITypeLib2_iface;
+                return S_OK;
+            }
+        }
+
 	TRACE("adding to cache\n");
 	impl->path = heap_alloc((lstrlenW(pszPath)+1) * sizeof(WCHAR));
 	lstrcpyW(impl->path, pszPath);
 	/* We should really canonicalise the path here. */
         impl->index = index;
 
-        /* FIXME: check if it has added already in the meantime */
-        EnterCriticalSection(&cache_section);
         list_add_head(&tlb_cache, &impl->entry);
         LeaveCriticalSection(&cache_section);
         ret = S_OK;
@@ -3435,7 +3511,7 @@ static ITypeLibImpl* TypeLibImpl_Constructor(void)
  *
  * loading an MSFT typelib from an in-memory image
  */
-static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength)
+static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength, IUnknown *file)
 {
     TLBContext cx;
     LONG lPSegDir;
@@ -3647,6 +3723,15 @@ static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength)
     }
 #endif
 
+    if (pTypeLibImpl->pending_members)
+    {
+        IUnknown_AddRef(file);
+        pTypeLibImpl->image_file = file;
+        pTypeLibImpl->image = pLib;
+        pTypeLibImpl->image_length = dwTLBLength;
+        pTypeLibImpl->image_segdir = tlbSegDir;
+    }
+
     TRACE("(%p)\n", pTypeLibImpl);
     return &pTypeLibImpl->ITypeLib2_iface;
 }
@@ -4786,6 +4871,8 @@ static ULONG WINAPI ITypeLib2_fnRelease( ITypeLib2 *iface)
           ITypeInfoImpl_Destroy(This->typeinfos[i]);
       }
       heap_free(This->typeinfos);
+      if (This->image_file)
+          IUnknown_Release(This->image_file);
       heap_free(This);
       return 0;
     }
@@ -5040,6 +5127,7 @@ static HRESULT WINAPI ITypeLib2_fnIsName(
     for(tic = 0; tic < This->TypeInfoCount; ++tic){
         ITypeInfoImpl *pTInfo = This->typeinfos[tic];
         if(!TLB_str_memcmp(szNameBuf, pTInfo->Name, nNameBufLen)) goto ITypeLib2_fnIsName_exit;
+        TLB_load_members(pTInfo);
         for(fdc = 0; fdc < pTInfo->typeattr.cFuncs; ++fdc) {
             TLBFuncDesc *pFInfo = &pTInfo->funcdescs[fdc];
             int pc;
@@ -5099,6 +5187,7 @@ static HRESULT WINAPI ITypeLib2_fnFindName(
             goto ITypeLib2_fnFindName_exit;
         }
 
+        TLB_load_members(pTInfo);
         for(fdc = 0; fdc < pTInfo->typeattr.cFuncs; ++fdc) {
             TLBFuncDesc *func = &pTInfo->funcdescs[fdc];
 
@@ -5530,6 +5619,7 @@ static ITypeInfoImpl* ITypeInfoImpl_Constructor(void)
       pTypeInfoImpl->ICreateTypeInfo2_iface.lpVtbl = &CreateTypeInfo2Vtbl;
       pTypeInfoImpl->ref = 0;
       pTypeInfoImpl->hreftype = -1;
+      pTypeInfoImpl->memoffset = -1;
       pTypeInfoImpl->typeattr.memidConstructor = MEMBERID_NIL;
       pTypeInfoImpl->typeattr.memidDestructor = MEMBERID_NIL;
       pTypeInfoImpl->pcustdata_list = &pTypeInfoImpl->custdata_list;
@@ -5557,7 +5647,11 @@ static HRESULT WINAPI ITypeInfo_fnQueryInterface(
         *ppvObject = &This->ITypeInfo2_iface;
     else if(IsEqualIID(riid, &IID_ICreateTypeInfo) ||
              IsEqualIID(riid, &IID_ICreateTypeInfo2))
+    {
+        /* the ICreateTypeInfo2 methods access the members directly */
+        TLB_load_members(This);
         *ppvObject = &This->ICreateTypeInfo2_iface;
+    }
     else if(IsEqualIID(riid, &IID_ITypeComp))
         *ppvObject = &This->ITypeComp_iface;
 
@@ -5605,6 +5699,10 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
 
     TRACE("destroying ITypeInfo(%p)\n",This);
 
+    /* members that were never decoded have nothing to free */
+    if (This->memoffset != -1)
+        This->typeattr.cFuncs = This->typeattr.cVars = 0;
+
     for (i = 0; i < This->typeattr.cFuncs; ++i)
     {
         typeinfo_release_funcdesc(&This->funcdescs[i]);
@@ -5895,6 +5993,8 @@ static HRESULT ITypeInfoImpl_GetInternalDispatchFuncDesc( ITypeInfo *iface,
         *hrefoffset += DISPATCH_HREF_OFFSET;
     }
 
+    TLB_load_members(This);
+
     if (funcs)
         *funcs = implemented_funcs + This->typeattr.cFuncs;
     else
@@ -5921,6 +6021,7 @@ static HRESULT ITypeInfoImpl_GetInternalFuncDesc( ITypeInfo *iface, UINT index,
     if (index >= This->typeattr.cFuncs)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    TLB_load_members(This);
     *func_desc = &This->funcdescs[index];
     return S_OK;
 }
@@ -6060,7 +6161,7 @@ static HRESULT WINAPI ITypeInfo_fnGetVarDesc( ITypeInfo2 *iface, UINT index,
         LPVARDESC  *ppVarDesc)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    const TLBVarDesc *pVDesc = &This->vardescs[index];
+    const TLBVarDesc *pVDesc;
 
     TRACE("(%p) index %d\n", This, index);
 
@@ -6070,6 +6171,8 @@ static HRESULT WINAPI ITypeInfo_fnGetVarDesc( ITypeInfo2 *iface, UINT index,
     if (This->needs_layout)
         ICreateTypeInfo2_LayOut(&This->ICreateTypeInfo2_iface);
 
+    TLB_load_members(This);
+    pVDesc = &This->vardescs[index];
     return TLB_AllocAndInitVarDesc(&pVDesc->vardesc, ppVarDesc);
 }
 
@@ -6273,6 +6376,7 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
     for (i = 0; i < cNames; i++)
         pMemId[i] = MEMBERID_NIL;
 
+    TLB_load_members(This);
     for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc) {
         int j;
         const TLBFuncDesc *pFDesc = &This->funcdescs[fdc];
@@ -7220,6 +7324,7 @@ static HRESULT WINAPI ITypeInfo_fnInvoke(
 
     /* we do this instead of using GetFuncDesc since it will return a fake
      * FUNCDESC for dispinterfaces and we want the real function description */
+    TLB_load_members(This);
     for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc){
         pFuncInfo = &This->funcdescs[fdc];
         if ((memid == pFuncInfo->funcdesc.memid) &&
@@ -7881,6 +7986,8 @@ static HRESULT WINAPI ITypeInfo_fnGetRefTypeInfo(
         */
         pTypeInfoImpl = ITypeInfoImpl_Constructor();
 
+        /* the copy shares the member arrays, so they must exist first */
+        TLB_load_members(This);
         *pTypeInfoImpl = *This;
         pTypeInfoImpl->ref = 0;
         list_init(&pTypeInfoImpl->custdata_list);
@@ -8250,6 +8357,7 @@ static HRESULT WINAPI ITypeInfo2_fnGetFuncIndexOfMemId( ITypeInfo2 * iface,
     UINT fdc;
     HRESULT result;
 
+    TLB_load_members(This);
     for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc){
         const TLBFuncDesc *pFuncInfo = &This->funcdescs[fdc];
         if(memid == pFuncInfo->funcdesc.memid && (invKind & pFuncInfo->funcdesc.invkind))
@@ -8394,13 +8502,15 @@ static HRESULT WINAPI ITypeInfo2_fnGetVarCustData(
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     TLBCustData *pCData;
-    TLBVarDesc *pVDesc = &This->vardescs[index];
+    TLBVarDesc *pVDesc;
 
     TRACE("%p %s %p\n", This, debugstr_guid(guid), pVarVal);
 
     if(index >= This->typeattr.cVars)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    TLB_load_members(This);
+    pVDesc = &This->vardescs[index];
     pCData = TLB_get_custdata_by_guid(&pVDesc->custdata_list, guid);
     if(!pCData)
         return TYPE_E_ELEMENTNOTFOUND;
@@ -8575,13 +8685,15 @@ static HRESULT WINAPI ITypeInfo2_fnGetAllVarCustData( ITypeInfo2 * iface,
     UINT index, CUSTDATA *pCustData)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    TLBVarDesc * pVDesc = &This->vardescs[index];
+    TLBVarDesc * pVDesc;
 
     TRACE("%p %u %p\n", This, index, pCustData);
 
     if(index >= This->typeattr.cVars)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    TLB_load_members(This);
+    pVDesc = &This->vardescs[index];
     return TLB_copy_all_custdata(&pVDesc->custdata_list, pCustData);
 }
 
@@ -8815,6 +8927,7 @@ static HRESULT WINAPI ITypeComp_fnBind(
     pBindPtr->lpfuncdesc = NULL;
     *ppTInfo = NULL;
 
+    TLB_load_members(This);
     for(fdc = 0; fdc < This->typeattr.cFuncs; ++fdc){
         pFDesc = &This->funcdescs[fdc];
         if (!lstrcmpiW(TLB_get_bstr(pFDesc->Name), szName)) {
@@ -9584,6 +9697,7 @@ static DWORD WMSFT_compile_typeinfo_aux(ITypeInfoImpl *info,
     MEMBERID *memid;
     DWORD *name, *offsets, offs;
 
+    TLB_load_members(info);
     for(i = 0; i < info->typeattr.cFuncs; ++i){
         TLBFuncDesc *desc = &info->funcdescs[i];
 
@@ -6954,6 +6954,186 @@ static void WINAPI NdrBaseTypeFree(PMIDL_STUB_MESSAGE pStubMsg,
    /* nothing to do */
 }
 
+enum ndr_plan_kind
+{
+    NDR_PLAN_INTERP,    /* go through the per-type routines */
+    NDR_PLAN_BASETYPE,  /* base type with the same layout in memory and on the wire */
+    NDR_PLAN_STRUCT,    /* simple struct without pointers */
+    NDR_PLAN_CARRAY,    /* conformant array */
+};
+
+/***********************************************************************
+ *           ndr_init_type_plan [internal]
+ *
+ * Decodes the format of a top-level parameter once, so that the stubless
+ * interpreter can copy types with a fixed wire layout straight into or
+ * out of the buffer instead of dispatching through the routine tables.
+ */
+BOOL ndr_init_type_plan(struct ndr_type_plan *plan, PFORMAT_STRING format)
+{
+    plan->format = format;
+    plan->fc = *format;
+    plan->kind = NDR_PLAN_INTERP;
+    plan->alignment = 1;
+    plan->size = 0;
+    plan->buffer_size = NdrBufferSizer[*format & NDR_TABLE_MASK];
+    plan->marshall = NdrMarshaller[*format & NDR_TABLE_MASK];
+    plan->unmarshall = NdrUnmarshaller[*format & NDR_TABLE_MASK];
+    if (!plan->buffer_size || !plan->marshall || !plan->unmarshall)
+        return FALSE;
+
+    switch (*format)
+    {
+    case FC_BYTE:
+    case FC_CHAR:
+    case FC_SMALL:
+    case FC_USMALL:
+        plan->kind = NDR_PLAN_BASETYPE;
+        plan->size = sizeof(UCHAR);
+        break;
+    case FC_WCHAR:
+    case FC_SHORT:
+    case FC_USHORT:
+        plan->kind = NDR_PLAN_BASETYPE;
+        plan->size = sizeof(USHORT);
+        break;
+    case FC_LONG:
+    case FC_ULONG:
+    case FC_ERROR_STATUS_T:
+    case FC_ENUM32:
+    case FC_FLOAT:
+        plan->kind = NDR_PLAN_BASETYPE;
+        plan->size = sizeof(ULONG);
+        break;
+    case FC_HYPER:
+    case FC_DOUBLE:
+        plan->kind = NDR_PLAN_BASETYPE;
+        plan->size = sizeof(ULONGLONG);
+        break;
+    case FC_STRUCT:
+        plan->kind = NDR_PLAN_STRUCT;
+        plan->alignment = format[1] + 1;
+        plan->size = *(const WORD *)(format + 2);
+        return TRUE;
+    case FC_CARRAY:
+        plan->kind = NDR_PLAN_CARRAY;
+        plan->alignment = format[1] + 1;
+        plan->size = *(const WORD *)(format + 2);
+        return TRUE;
+    default:
+        return TRUE;
+    }
+    plan->alignment = plan->size;
+    return TRUE;
+}
+
+/***********************************************************************
+ *           ndr_type_plan_matches [internal]
+ *
+ * Checks that the format still holds what the plan was decoded from.
+ */
+BOOL ndr_type_plan_matches(const struct ndr_type_plan *plan)
+{
+    PFORMAT_STRING format = plan->format;
+
+    if (*format != plan->fc) return FALSE;
+    if (plan->kind == NDR_PLAN_STRUCT || plan->kind == NDR_PLAN_CARRAY)
+        return plan->alignment == format[1] + 1 && plan->size == *(const WORD *)(format + 2);
+    return TRUE;
+}
+
+/* arrays with embedded pointers still go through the per-type routines */
+static inline BOOL plan_array_has_pointers(MIDL_STUB_MESSAGE *msg, const struct ndr_type_plan *plan)
+{
+    return *SkipConformance(msg, plan->format + 4) == FC_PP;
+}
+
+void ndr_plan_buffer_size(MIDL_STUB_MESSAGE *msg, unsigned char *memory, const struct ndr_type_plan *plan)
+{
+    switch (plan->kind)
+    {
+    case NDR_PLAN_BASETYPE:
+    case NDR_PLAN_STRUCT:
+        align_length(&msg->BufferLength, plan->alignment);
+        safe_buffer_length_increment(msg, plan->size);
+        return;
+    case NDR_PLAN_CARRAY:
+        if (plan_array_has_pointers(msg, plan)) break;
+        ComputeConformance(msg, memory, plan->format + 4, 0);
+        SizeConformance(msg);
+        align_length(&msg->BufferLength, plan->alignment);
+        safe_buffer_length_increment(msg, safe_multiply(plan->size, msg->MaxCount));
+        return;
+    }
+    plan->buffer_size(msg, memory, plan->format);
+}
+
+void ndr_plan_marshall(MIDL_STUB_MESSAGE *msg, unsigned char *memory, const struct ndr_type_plan *plan)
+{
+    switch (plan->kind)
+    {
+    case NDR_PLAN_BASETYPE:
+        align_pointer_clear(&msg->Buffer, plan->alignment);
+        safe_copy_to_buffer(msg, memory, plan->size);
+        return;
+    case NDR_PLAN_STRUCT:
+        align_pointer_clear(&msg->Buffer, plan->alignment);
+        msg->BufferMark = msg->Buffer;
+        safe_copy_to_buffer(msg, memory, plan->size);
+        return;
+    case NDR_PLAN_CARRAY:
+        if (plan_array_has_pointers(msg, plan)) break;
+        ComputeConformance(msg, memory, plan->format + 4, 0);
+        WriteConformance(msg);
+        align_pointer_clear(&msg->Buffer, plan->alignment);
+        msg->BufferMark = msg->Buffer;
+        safe_copy_to_buffer(msg, memory, safe_multiply(plan->size, msg->MaxCount));
+        return;
+    }
+    plan->marshall(msg, memory, plan->format);
+}
+
+void ndr_plan_unmarshall(MIDL_STUB_MESSAGE *msg, unsigned char **memory, const struct ndr_type_plan *plan,
+                         unsigned char must_alloc)
+{
+    unsigned char *saved_buffer;
+    ULONG size;
+
+    if (!must_alloc) switch (plan->kind)
+    {
+    case NDR_PLAN_BASETYPE:
+        align_pointer(&msg->Buffer, plan->alignment);
+        if (!msg->IsClient && !*memory)
+        {
+            *memory = msg->Buffer;
+            safe_buffer_increment(msg, plan->size);
+        }
+        else
+            safe_copy_from_buffer(msg, *memory, plan->size);
+        return;
+    case NDR_PLAN_STRUCT:
+    case NDR_PLAN_CARRAY:
+        if (plan->kind == NDR_PLAN_CARRAY)
+        {
+            if (plan_array_has_pointers(msg, plan)) break;
+            ReadConformance(msg, plan->format + 4);
+            size = safe_multiply(plan->size, msg->MaxCount);
+        }
+        else size = plan->size;
+
+        align_pointer(&msg->Buffer, plan->alignment);
+        /* for servers, we just point straight into the RPC buffer */
+        if (!msg->IsClient && !*memory)
+            *memory = msg->Buffer;
+        saved_buffer = msg->BufferMark = msg->Buffer;
+        safe_buffer_increment(msg, size);
+        if (*memory != saved_buffer)
+            memcpy(*memory, saved_buffer, size);
+        return;
+    }
+    plan->unmarshall(msg, memory, plan->format, must_alloc);
+}
+
 /***********************************************************************
  *           NdrContextHandleBufferSize [internal]
  */
@@ -64,4 +64,24 @@ extern const NDR_FREE       NdrFreer[] DECLSPEC_HIDDEN;
 
 ULONG ComplexStructSize(PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat) DECLSPEC_HIDDEN;
 
+/* precomputed handling of a top-level parameter type */
+struct ndr_type_plan
+{
+    PFORMAT_STRING format;
+    unsigned char fc;        /* format character the plan was built for */
+    unsigned char kind;
+    unsigned char alignment;
+    unsigned short size;     /* size of a fixed type, or element size of an array */
+    NDR_BUFFERSIZE buffer_size;
+    NDR_MARSHALL marshall;
+    NDR_UNMARSHALL unmarshall;
+};
+
+BOOL ndr_init_type_plan(struct ndr_type_plan *plan, PFORMAT_STRING format) DECLSPEC_HIDDEN;
+BOOL ndr_type_plan_matches(const struct ndr_type_plan *plan) DECLSPEC_HIDDEN;
+void ndr_plan_buffer_size(MIDL_STUB_MESSAGE *msg, unsigned char *memory, const struct ndr_type_plan *plan) DECLSPEC_HIDDEN;
+void ndr_plan_marshall(MIDL_STUB_MESSAGE *msg, unsigned char *memory, const struct ndr_type_plan *plan) DECLSPEC_HIDDEN;
+void ndr_plan_unmarshall(MIDL_STUB_MESSAGE *msg, unsigned char **memory, const struct ndr_type_plan *plan,
+                         unsigned char must_alloc) DECLSPEC_HIDDEN;
+
 #endif  /* __WINE_NDR_MISC_H */
@@ -53,7 +53,7 @@ static inline BOOL is_oicf_stubdesc(const PMIDL_STUB_DESC pStubDesc)
 }
 
 static inline void call_buffer_sizer(PMIDL_STUB_MESSAGE pStubMsg, unsigned char *pMemory,
-                                     const NDR_PARAM_OIF *param)
+                                     const NDR_PARAM_OIF *param, const struct ndr_type_plan *type)
 {
     PFORMAT_STRING pFormat;
     NDR_BUFFERSIZE m;
@@ -69,6 +69,12 @@ static inline void call_buffer_sizer(PMIDL_STUB_MESSAGE pStubMsg, unsigned char
         if (!param->attr.IsByValue) pMemory = *(unsigned char **)pMemory;
     }
 
+    if (type)
+    {
+        ndr_plan_buffer_size(pStubMsg, pMemory, type);
+        return;
+    }
+
     m = NdrBufferSizer[pFormat[0] & NDR_TABLE_MASK];
     if (m) m(pStubMsg, pMemory, pFormat);
     else
@@ -79,7 +85,7 @@ static inline void call_buffer_sizer(PMIDL_STUB_MESSAGE pStubMsg, unsigned char
 }
 
 static inline unsigned char *call_marshaller(PMIDL_STUB_MESSAGE pStubMsg, unsigned char *pMemory,
-                                             const NDR_PARAM_OIF *param)
+                                             const NDR_PARAM_OIF *param, const struct ndr_type_plan *type)
 {
     PFORMAT_STRING pFormat;
     NDR_MARSHALL m;
@@ -95,6 +101,12 @@ static inline unsigned char *call_marshaller(PMIDL_STUB_MESSAGE pStubMsg, unsign
         if (!param->attr.IsByValue) pMemory = *(unsigned char **)pMemory;
     }
 
+    if (type)
+    {
+        ndr_plan_marshall(pStubMsg, pMemory, type);
+        return NULL;
+    }
+
     m = NdrMarshaller[pFormat[0] & NDR_TABLE_MASK];
     if (m) return m(pStubMsg, pMemory, pFormat);
     else
@@ -106,7 +118,8 @@ static inline unsigned char *call_marshaller(PMIDL_STUB_MESSAGE pStubMsg, unsign
 }
 
 static inline unsigned char *call_unmarshaller(PMIDL_STUB_MESSAGE pStubMsg, unsigned char **ppMemory,
-                                               const NDR_PARAM_OIF *param, unsigned char fMustAlloc)
+                                               const NDR_PARAM_OIF *param, const struct ndr_type_plan *type,
+                                               unsigned char fMustAlloc)
 {
     PFORMAT_STRING pFormat;
     NDR_UNMARSHALL m;
@@ -122,6 +135,12 @@ static inline unsigned char *call_unmarshaller(PMIDL_STUB_MESSAGE pStubMsg, unsi
         if (!param->attr.IsByValue) ppMemory = (unsigned char **)*ppMemory;
     }
 
+    if (type)
+    {
+        ndr_plan_unmarshall(pStubMsg, ppMemory, type, fMustAlloc);
+        return NULL;
+    }
+
     m = NdrUnmarshaller[pFormat[0] & NDR_TABLE_MASK];
     if (m) return m(pStubMsg, ppMemory, pFormat, fMustAlloc);
     else
@@ -477,8 +496,140 @@ static size_t basetype_arg_size( unsigned char fc )
     }
 }
 
+/* Marshalling plans for the parameters of a procedure. They are built the
+ * first time a procedure is called and are keyed by the addresses of its
+ * parameter list and type format string; only -Oicf format strings are
+ * cached, since converted -Oi formats live on the stack. Formats that get
+ * freed, like the ones generated from type libraries, must discard their
+ * plans with ndr_discard_proc_plans(). The decoded bytes are compared on
+ * every hit, in case a format was replaced at the same address anyway. */
+struct ndr_proc_plan
+{
+    struct ndr_proc_plan *next;
+    const unsigned char *format_types;
+    PFORMAT_STRING params;
+    const NDR_PARAM_OIF *params_copy;
+    unsigned short number_of_params;
+    struct ndr_type_plan types[1];
+};
+
+static struct ndr_proc_plan *proc_plans[256];
+static SRWLOCK proc_plans_lock = SRWLOCK_INIT;
+
+static inline unsigned int proc_plan_hash( PFORMAT_STRING params )
+{
+    return ((ULONG_PTR)params >> 2) % ARRAY_SIZE(proc_plans);
+}
+
+static BOOL proc_plan_matches( const struct ndr_proc_plan *plan, const MIDL_STUB_DESC *stub_desc,
+                               PFORMAT_STRING params, unsigned short number_of_params )
+{
+    unsigned int i;
+
+    if (plan->params != params || plan->format_types != stub_desc->pFormatTypes ||
+        plan->number_of_params != number_of_params ||
+        memcmp( plan->params_copy, params, number_of_params * sizeof(NDR_PARAM_OIF) ))
+        return FALSE;
+
+    for (i = 0; i < number_of_params; i++)
+        if (!ndr_type_plan_matches( &plan->types[i] )) return FALSE;
+    return TRUE;
+}
+
+static const struct ndr_proc_plan *get_proc_plan( const MIDL_STUB_DESC *stub_desc, PFORMAT_STRING params,
+                                                  unsigned short number_of_params )
+{
+    const NDR_PARAM_OIF *param = (const NDR_PARAM_OIF *)params;
+    struct ndr_proc_plan **bucket = &proc_plans[proc_plan_hash( params )];
+    struct ndr_proc_plan *plan, **prev;
+    PFORMAT_STRING format;
+    unsigned int i;
+
+    AcquireSRWLockShared( &proc_plans_lock );
+    for (plan = *bucket; plan; plan = plan->next)
+        if (proc_plan_matches( plan, stub_desc, params, number_of_params )) break;
+    ReleaseSRWLockShared( &proc_plans_lock );
+    if (plan) return plan;
+
+    if (!number_of_params) return NULL;
+    if (!(plan = malloc( offsetof(struct ndr_proc_plan, types[number_of_params]) +
+                         number_of_params * sizeof(NDR_PARAM_OIF) )))
+        return NULL;
+
+    for (i = 0; i < number_of_params; i++)
+    {
+        if (param[i].attr.IsBasetype) format = &param[i].u.type_format_char;
+        else format = &stub_desc->pFormatTypes[param[i].u.type_offset];
+        if (!ndr_init_type_plan( &plan->types[i], format ))
+        {
+            free( plan );
+            return NULL;
+        }
+    }
+
+    plan->format_types = stub_desc->pFormatTypes;
+    plan->params = params;
+    plan->params_copy = memcpy( &plan->types[number_of_params], params, number_of_params * sizeof(NDR_PARAM_OIF) );
+    plan->number_of_params = number_of_params;
+
+    /* drop stale plans for the same address, a concurrent caller may have
+     * inserted the same plan meanwhile, which is harmless */
+    AcquireSRWLockExclusive( &proc_plans_lock );
+    for (prev = bucket; *prev; )
+    {
+        struct ndr_proc_plan *old = *prev;
+
+        if (old->params == params && old->format_types == plan->format_types &&
+            !proc_plan_matches( old, stub_desc, params, number_of_params ))
+        {
+            *prev = old->next;
+            free( old );
+        }
+        else prev = &old->next;
+    }
+    plan->next = *bucket;
+    *bucket = plan;
+    ReleaseSRWLockExclusive( &proc_plans_lock );
+
+    TRACE( "built plan %p for %u params at %p\n", plan, number_of_params, params );
+    return plan;
+}
+
+/***********************************************************************
+ *           ndr_discard_proc_plans [internal]
+ *
+ * Frees the plans built for procedures using the given type format string,
+ * which is about to be freed. No call may be using it anymore.
+ */
+void ndr_discard_proc_plans( const unsigned char *format_types )
+{
+    struct ndr_proc_plan **prev, *plan;
+    unsigned int i;
+
+    AcquireSRWLockExclusive( &proc_plans_lock );
+    for (i = 0; i < ARRAY_SIZE(proc_plans); i++)
+    {
+        for (prev = &proc_plans[i]; (plan = *prev); )
+        {
+            if (plan->format_types == format_types)
+            {
+                *prev = plan->next;
+                free( plan );
+            }
+            else prev = &plan->next;
+        }
+    }
+    ReleaseSRWLockExclusive( &proc_plans_lock );
+}
+
+static inline const struct ndr_type_plan *param_type_plan( const struct ndr_proc_plan *plan, unsigned int i )
+{
+    return plan ? &plan->types[i] : NULL;
+}
+
 void client_do_args( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat, enum stubless_phase phase,
-                     void **fpu_args, unsigned short number_of_params, unsigned char *pRetVal )
+                     void **fpu_args, unsigned short number_of_params, unsigned char *pRetVal,
+                     const struct ndr_proc_plan *plan )
 {
     const NDR_PARAM_OIF *params = (const NDR_PARAM_OIF *)pFormat;
     unsigned int i;
@@ -519,16 +670,16 @@ void client_do_args( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat, enum s
         case STUBLESS_CALCSIZE:
             if (params[i].attr.IsSimpleRef && !*(unsigned char **)pArg)
                 RpcRaiseException(RPC_X_NULL_REF_POINTER);
-            if (params[i].attr.IsIn) call_buffer_sizer(pStubMsg, pArg, &params[i]);
+            if (params[i].attr.IsIn) call_buffer_sizer(pStubMsg, pArg, &params[i], param_type_plan(plan, i));
             break;
         case STUBLESS_MARSHAL:
-            if (params[i].attr.IsIn) call_marshaller(pStubMsg, pArg, &params[i]);
+            if (params[i].attr.IsIn) call_marshaller(pStubMsg, pArg, &params[i], param_type_plan(plan, i));
             break;
         case STUBLESS_UNMARSHAL:
             if (params[i].attr.IsOut)
             {
                 if (params[i].attr.IsReturn && pRetVal) pArg = pRetVal;
-                call_unmarshaller(pStubMsg, &pArg, &params[i], 0);
+                call_unmarshaller(pStubMsg, &pArg, &params[i], param_type_plan(plan, i), 0);
             }
             break;
         case STUBLESS_FREE:
@@ -705,7 +856,8 @@ static void CALLBACK ndr_client_call_finally(BOOL normal, void *arg)
 static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORMAT_STRING format,
         const PFORMAT_STRING handle_format, void **stack_top, void **fpu_stack, MIDL_STUB_MESSAGE *stub_msg,
         unsigned short procedure_number, unsigned short stack_size, unsigned int number_of_params,
-        INTERPRETER_OPT_FLAGS Oif_flags, INTERPRETER_OPT_FLAGS2 ext_flags, const NDR_PROC_HEADER *proc_header )
+        INTERPRETER_OPT_FLAGS Oif_flags, INTERPRETER_OPT_FLAGS2 ext_flags, const NDR_PROC_HEADER *proc_header,
+        const struct ndr_proc_plan *plan )
 {
     struct ndr_client_call_ctx finally_ctx;
     RPC_MESSAGE rpc_msg;
@@ -790,13 +942,13 @@ static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORM
         {
             TRACE( "INITOUT\n" );
             client_do_args(stub_msg, format, STUBLESS_INITOUT, fpu_stack,
-                           number_of_params, (unsigned char *)&retval);
+                           number_of_params, (unsigned char *)&retval, plan);
         }
 
         /* 2. CALCSIZE */
         TRACE( "CALCSIZE\n" );
         client_do_args(stub_msg, format, STUBLESS_CALCSIZE, fpu_stack,
-                       number_of_params, (unsigned char *)&retval);
+                       number_of_params, (unsigned char *)&retval, plan);
 
         /* 3. GETBUFFER */
         TRACE( "GETBUFFER\n" );
@@ -816,7 +968,7 @@ static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORM
         /* 4. MARSHAL */
         TRACE( "MARSHAL\n" );
         client_do_args(stub_msg, format, STUBLESS_MARSHAL, fpu_stack,
-                       number_of_params, (unsigned char *)&retval);
+                       number_of_params, (unsigned char *)&retval, plan);
 
         /* 5. SENDRECEIVE */
         TRACE( "SENDRECEIVE\n" );
@@ -842,7 +994,7 @@ static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORM
         /* 6. UNMARSHAL */
         TRACE( "UNMARSHAL\n" );
         client_do_args(stub_msg, format, STUBLESS_UNMARSHAL, fpu_stack,
-                       number_of_params, (unsigned char *)&retval);
+                       number_of_params, (unsigned char *)&retval, plan);
     }
     __FINALLY_CTX(ndr_client_call_finally, &finally_ctx)
 
@@ -870,6 +1022,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
     LONG_PTR RetVal = 0;
     PFORMAT_STRING pHandleFormat;
     NDR_PARAM_OIF old_args[256];
+    const struct ndr_proc_plan *plan = NULL;
 
     TRACE("pStubDesc %p, pFormat %p, ...\n", pStubDesc, pFormat);
 
@@ -930,6 +1083,8 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
             }
 #endif
         }
+
+        plan = get_proc_plan( pStubDesc, pFormat, number_of_params );
     }
     else
     {
@@ -944,14 +1099,14 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
         {
             RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                     stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                    number_of_params, Oif_flags, ext_flags, pProcHeader);
+                    number_of_params, Oif_flags, ext_flags, pProcHeader, plan);
         }
         __EXCEPT_ALL
         {
             /* 7. FREE */
             TRACE( "FREE\n" );
             client_do_args(&stubMsg, pFormat, STUBLESS_FREE, fpu_stack,
-                           number_of_params, (unsigned char *)&RetVal);
+                           number_of_params, (unsigned char *)&RetVal, NULL);
             RetVal = NdrProxyErrorHandler(GetExceptionCode());
         }
         __ENDTRY
@@ -962,7 +1117,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
         {
             RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                     stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                    number_of_params, Oif_flags, ext_flags, pProcHeader);
+                    number_of_params, Oif_flags, ext_flags, pProcHeader, plan);
         }
         __EXCEPT_ALL
         {
@@ -995,7 +1150,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
     {
         RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                 stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                number_of_params, Oif_flags, ext_flags, pProcHeader);
+                number_of_params, Oif_flags, ext_flags, pProcHeader, plan);
     }
 
     TRACE("RetVal = 0x%Ix\n", RetVal);
@@ -1217,7 +1372,7 @@ LONG_PTR __cdecl call_server_func(SERVER_ROUTINE func, unsigned char * args, uns
 
 static LONG_PTR *stub_do_args(MIDL_STUB_MESSAGE *pStubMsg,
                               PFORMAT_STRING pFormat, enum stubless_phase phase,
-                              unsigned short number_of_params)
+                              unsigned short number_of_params, const struct ndr_proc_plan *plan)
 {
     const NDR_PARAM_OIF *params = (const NDR_PARAM_OIF *)pFormat;
     unsigned int i;
@@ -1237,7 +1392,7 @@ static LONG_PTR *stub_do_args(MIDL_STUB_MESSAGE *pStubMsg,
         {
         case STUBLESS_MARSHAL:
             if (params[i].attr.IsOut || params[i].attr.IsReturn)
-                call_marshaller(pStubMsg, pArg, &params[i]);
+                call_marshaller(pStubMsg, pArg, &params[i], param_type_plan(plan, i));
             break;
         case STUBLESS_MUSTFREE:
             if (params[i].attr.MustFree)
@@ -1282,11 +1437,11 @@ static LONG_PTR *stub_do_args(MIDL_STUB_MESSAGE *pStubMsg,
                 *(void **)pArg = calloc(params[i].attr.ServerAllocSize, 8);
 
             if (params[i].attr.IsIn)
-                call_unmarshaller(pStubMsg, &pArg, &params[i], 0);
+                call_unmarshaller(pStubMsg, &pArg, &params[i], param_type_plan(plan, i), 0);
             break;
         case STUBLESS_CALCSIZE:
             if (params[i].attr.IsOut || params[i].attr.IsReturn)
-                call_buffer_sizer(pStubMsg, pArg, &params[i]);
+                call_buffer_sizer(pStubMsg, pArg, &params[i], param_type_plan(plan, i));
             break;
         default:
             RpcRaiseException(RPC_S_INTERNAL_ERROR);
@@ -1333,6 +1488,8 @@ LONG WINAPI NdrStubCall2(
     LONG_PTR *retval_ptr = NULL;
     /* correlation cache */
     ULONG_PTR NdrCorrCache[256];
+    /* cached marshalling plan for the parameters */
+    const struct ndr_proc_plan *plan = NULL;
 
     TRACE("pThis %p, pChannel %p, pRpcMsg %p, pdwStubPhase %p\n", pThis, pChannel, pRpcMsg, pdwStubPhase);
 
@@ -1456,6 +1613,8 @@ LONG WINAPI NdrStubCall2(
             if (ext_flags.Unused & 0x2) /* has range on conformance */
                 stubMsg.CorrDespIncrement = 12;
         }
+
+        plan = get_proc_plan( pStubDesc, pFormat, number_of_params );
     }
     else
     {
@@ -1529,7 +1688,7 @@ LONG WINAPI NdrStubCall2(
         case STUBLESS_MARSHAL:
         case STUBLESS_MUSTFREE:
         case STUBLESS_FREE:
-            retval_ptr = stub_do_args(&stubMsg, pFormat, phase, number_of_params);
+            retval_ptr = stub_do_args(&stubMsg, pFormat, phase, number_of_params, plan);
             break;
         default:
             ERR("shouldn't reach here. phase %d\n", phase);
@@ -1741,7 +1900,7 @@ static void do_ndr_async_client_call( const MIDL_STUB_DESC *pStubDesc, PFORMAT_S
 
     /* 1. CALCSIZE */
     TRACE( "CALCSIZE\n" );
-    client_do_args(pStubMsg, pFormat, STUBLESS_CALCSIZE, NULL, async_call_data->number_of_params, NULL);
+    client_do_args(pStubMsg, pFormat, STUBLESS_CALCSIZE, NULL, async_call_data->number_of_params, NULL, NULL);
 
     /* 2. GETBUFFER */
     TRACE( "GETBUFFER\n" );
@@ -1766,7 +1925,7 @@ static void do_ndr_async_client_call( const MIDL_STUB_DESC *pStubDesc, PFORMAT_S
 
     /* 3. MARSHAL */
     TRACE( "MARSHAL\n" );
-    client_do_args(pStubMsg, pFormat, STUBLESS_MARSHAL, NULL, async_call_data->number_of_params, NULL);
+    client_do_args(pStubMsg, pFormat, STUBLESS_MARSHAL, NULL, async_call_data->number_of_params, NULL, NULL);
 
     /* 4. SENDRECEIVE */
     TRACE( "SEND\n" );
@@ -1878,7 +2037,7 @@ RPC_STATUS NdrpCompleteAsyncClientCall(RPC_ASYNC_STATE *pAsync, void *Reply)
     /* 2. UNMARSHAL */
     TRACE( "UNMARSHAL\n" );
     client_do_args(pStubMsg, async_call_data->pParamFormat, STUBLESS_UNMARSHAL,
-                   NULL, async_call_data->number_of_params, Reply);
+                   NULL, async_call_data->number_of_params, Reply, NULL);
 
 cleanup:
     if (pStubMsg->fHasNewCorrDesc)
@@ -2111,11 +2270,11 @@ void RPC_ENTRY NdrAsyncServerCall(PRPC_MESSAGE pRpcMsg)
 
     /* 1. UNMARSHAL */
     TRACE("UNMARSHAL\n");
-    stub_do_args(async_call_data->pStubMsg, pFormat, STUBLESS_UNMARSHAL, async_call_data->number_of_params);
+    stub_do_args(async_call_data->pStubMsg, pFormat, STUBLESS_UNMARSHAL, async_call_data->number_of_params, NULL);
 
     /* 2. INITOUT */
     TRACE("INITOUT\n");
-    async_call_data->retval_ptr = stub_do_args(async_call_data->pStubMsg, pFormat, STUBLESS_INITOUT, async_call_data->number_of_params);
+    async_call_data->retval_ptr = stub_do_args(async_call_data->pStubMsg, pFormat, STUBLESS_INITOUT, async_call_data->number_of_params, NULL);
 
     /* 3. CALLSERVER */
     TRACE("CALLSERVER\n");
@@ -2179,7 +2338,7 @@ RPC_STATUS NdrpCompleteAsyncServerCall(RPC_ASYNC_STATE *pAsync, void *Reply)
         case STUBLESS_MARSHAL:
         case STUBLESS_MUSTFREE:
         case STUBLESS_FREE:
-            stub_do_args(pStubMsg, async_call_data->pHandleFormat, phase, async_call_data->number_of_params);
+            stub_do_args(pStubMsg, async_call_data->pHandleFormat, phase, async_call_data->number_of_params, NULL);
             break;
         default:
             ERR("shouldn't reach here. phase %d\n", phase);
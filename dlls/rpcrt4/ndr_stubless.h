@@ -257,8 +257,11 @@ LONG_PTR CDECL ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORMAT_STRING pForma
                                 void **stack_top, void **fpu_stack ) DECLSPEC_HIDDEN;
 LONG_PTR CDECL ndr_async_client_call( PMIDL_STUB_DESC pStubDesc, PFORMAT_STRING pFormat,
                                       void **stack_top ) DECLSPEC_HIDDEN;
+struct ndr_proc_plan;
 void client_do_args( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat, enum stubless_phase phase,
-                     void **fpu_args, unsigned short number_of_params, unsigned char *pRetVal ) DECLSPEC_HIDDEN;
+                     void **fpu_args, unsigned short number_of_params, unsigned char *pRetVal,
+                     const struct ndr_proc_plan *plan ) DECLSPEC_HIDDEN;
+void ndr_discard_proc_plans( const unsigned char *format_types ) DECLSPEC_HIDDEN;
 PFORMAT_STRING convert_old_args( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat,
                                  unsigned int stack_size, BOOL object_proc,
                                  void *buffer, unsigned int size, unsigned int *count ) DECLSPEC_HIDDEN;
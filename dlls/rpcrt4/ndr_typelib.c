@@ -26,6 +26,7 @@
 #include "rpcproxy.h"
 #include "ndrtypes.h"
 #include "wine/debug.h"
+#include "wine/list.h"
 
 #include "cpsf.h"
 #include "initguid.h"
@@ -1172,9 +1173,68 @@ static HRESULT write_iface_fs(ITypeInfo *typeinfo, WORD funcs, WORD parentfuncs,
     return S_OK;
 }
 
+/* Generated format strings only depend on the interface description, so they
+ * are shared by every proxy and stub built for the same interface of the same
+ * type library. Entries live as long as some proxy or stub references them. */
+struct typelib_format
+{
+    struct list entry;
+    LONG refcount;
+    GUID libid;
+    LCID lcid;
+    WORD major, minor;
+    SYSKIND syskind;
+    GUID iid;
+    WORD funcs, parentfuncs;
+    unsigned char *type;
+    unsigned char *proc;
+    unsigned short *offset;
+};
+
+static struct list typelib_format_cache = LIST_INIT(typelib_format_cache);
+
+static CRITICAL_SECTION typelib_format_cs;
+static CRITICAL_SECTION_DEBUG typelib_format_cs_debug =
+{
+    0, 0, &typelib_format_cs,
+    { &typelib_format_cs_debug.ProcessLocksList, &typelib_format_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": typelib_format_cs") }
+};
+static CRITICAL_SECTION typelib_format_cs = { &typelib_format_cs_debug, -1, 0, 0, 0, 0 };
+
+static BOOL typelib_format_matches(const struct typelib_format *a, const struct typelib_format *b)
+{
+    return IsEqualGUID(&a->libid, &b->libid) && a->lcid == b->lcid
+            && a->major == b->major && a->minor == b->minor
+            && a->syskind == b->syskind && IsEqualGUID(&a->iid, &b->iid)
+            && a->funcs == b->funcs && a->parentfuncs == b->parentfuncs;
+}
+
+static void free_typelib_format(struct typelib_format *format)
+{
+    ndr_discard_proc_plans(format->type);
+    free(format->type);
+    free(format->proc);
+    free(format->offset);
+    free(format);
+}
+
+static void release_typelib_format(struct typelib_format *format)
+{
+    LONG refcount;
+
+    EnterCriticalSection(&typelib_format_cs);
+    if (!(refcount = --format->refcount))
+        list_remove(&format->entry);
+    LeaveCriticalSection(&typelib_format_cs);
+
+    if (!refcount)
+        free_typelib_format(format);
+}
+
 static HRESULT build_format_strings(ITypeInfo *typeinfo, WORD funcs,
-        WORD parentfuncs, const unsigned char **type_ret,
-        const unsigned char **proc_ret, unsigned short **offset_ret)
+        WORD parentfuncs, unsigned char **type_ret,
+        unsigned char **proc_ret, unsigned short **offset_ret)
 {
     size_t tfs_size;
     const unsigned char *tfs = get_type_format_string( &tfs_size );
@@ -1216,6 +1276,100 @@ err:
     return hr;
 }
 
+static HRESULT get_typelib_format(ITypeInfo *typeinfo, WORD funcs, WORD parentfuncs,
+        struct typelib_format **ret)
+{
+    struct typelib_format *format, *cached;
+    TYPEATTR *typeattr;
+    ITypeLib *typelib;
+    TLIBATTR *libattr;
+    BOOL cacheable;
+    HRESULT hr;
+
+    if (!(format = calloc(1, sizeof(*format))))
+        return E_OUTOFMEMORY;
+    format->refcount = 1;
+    format->funcs = funcs;
+    format->parentfuncs = parentfuncs;
+    list_init(&format->entry);
+
+    if (SUCCEEDED(hr = ITypeInfo_GetTypeAttr(typeinfo, &typeattr)))
+    {
+        format->iid = typeattr->guid;
+        ITypeInfo_ReleaseTypeAttr(typeinfo, typeattr);
+        hr = ITypeInfo_GetContainingTypeLib(typeinfo, &typelib, NULL);
+    }
+    if (SUCCEEDED(hr))
+    {
+        if (SUCCEEDED(hr = ITypeLib_GetLibAttr(typelib, &libattr)))
+        {
+            format->libid = libattr->guid;
+            format->lcid = libattr->lcid;
+            format->major = libattr->wMajorVerNum;
+            format->minor = libattr->wMinorVerNum;
+            format->syskind = libattr->syskind;
+            ITypeLib_ReleaseTLibAttr(typelib, libattr);
+        }
+        ITypeLib_Release(typelib);
+    }
+    if (FAILED(hr))
+    {
+        free(format);
+        return hr;
+    }
+
+    /* Libraries without an identity (e.g. built in memory through
+     * ICreateTypeLib) can't be told apart, so don't share their strings. */
+    cacheable = !IsEqualGUID(&format->libid, &GUID_NULL) && !IsEqualGUID(&format->iid, &GUID_NULL);
+
+    if (cacheable)
+    {
+        EnterCriticalSection(&typelib_format_cs);
+        LIST_FOR_EACH_ENTRY(cached, &typelib_format_cache, struct typelib_format, entry)
+        {
+            if (typelib_format_matches(cached, format))
+            {
+                TRACE("Reusing format strings for %s.\n", debugstr_guid(&format->iid));
+                cached->refcount++;
+                LeaveCriticalSection(&typelib_format_cs);
+                free(format);
+                *ret = cached;
+                return S_OK;
+            }
+        }
+        LeaveCriticalSection(&typelib_format_cs);
+    }
+
+    hr = build_format_strings(typeinfo, funcs, parentfuncs, &format->type,
+            &format->proc, &format->offset);
+    if (FAILED(hr))
+    {
+        free(format);
+        return hr;
+    }
+
+    if (cacheable)
+    {
+        EnterCriticalSection(&typelib_format_cs);
+        LIST_FOR_EACH_ENTRY(cached, &typelib_format_cache, struct typelib_format, entry)
+        {
+            if (typelib_format_matches(cached, format))
+            {
+                cached->refcount++;
+                LeaveCriticalSection(&typelib_format_cs);
+                free_typelib_format(format);
+                *ret = cached;
+                return S_OK;
+            }
+        }
+        list_add_head(&typelib_format_cache, &format->entry);
+        LeaveCriticalSection(&typelib_format_cs);
+    }
+
+    *ret = format;
+    return S_OK;
+}
+
 /* Common helper for Create{Proxy,Stub}FromTypeInfo(). */
 static HRESULT get_iface_info(ITypeInfo *typeinfo, WORD *funcs, WORD *parentfuncs,
         GUID *parentiid, ITypeInfo **real_typeinfo)
@@ -1309,7 +1463,7 @@ struct typelib_proxy
     MIDL_STUB_DESC stub_desc;
     MIDL_STUBLESS_PROXY_INFO proxy_info;
     CInterfaceProxyVtbl *proxy_vtbl;
-    unsigned short *offset_table;
+    struct typelib_format *format;
 };
 
 static ULONG WINAPI typelib_proxy_Release(IRpcProxyBuffer *iface)
@@ -1327,9 +1481,7 @@ static ULONG WINAPI typelib_proxy_Release(IRpcProxyBuffer *iface)
             IUnknown_Release(proxy->proxy.base_object);
         if (proxy->proxy.base_proxy)
             IRpcProxyBuffer_Release(proxy->proxy.base_proxy);
-        free((void *)proxy->stub_desc.pFormatTypes);
-        free((void *)proxy->proxy_info.ProcFormatString);
-        free(proxy->offset_table);
+        release_typelib_format(proxy->format);
         free(proxy->proxy_vtbl);
         free(proxy);
     }
@@ -1414,8 +1566,7 @@ HRESULT WINAPI CreateProxyFromTypeInfo(ITypeInfo *typeinfo, IUnknown *outer,
     for (i = 0; i < funcs; i++)
         proxy->proxy_vtbl->Vtbl[parentfuncs + i] = (void *)-1;
 
-    hr = build_format_strings(real_typeinfo, funcs, parentfuncs, &proxy->stub_desc.pFormatTypes,
-            &proxy->proxy_info.ProcFormatString, &proxy->offset_table);
+    hr = get_typelib_format(real_typeinfo, funcs, parentfuncs, &proxy->format);
     ITypeInfo_Release(real_typeinfo);
     if (FAILED(hr))
     {
@@ -1423,14 +1574,14 @@ HRESULT WINAPI CreateProxyFromTypeInfo(ITypeInfo *typeinfo, IUnknown *outer,
         free(proxy);
         return hr;
     }
-    proxy->proxy_info.FormatStringOffset = &proxy->offset_table[-3];
+    proxy->stub_desc.pFormatTypes = proxy->format->type;
+    proxy->proxy_info.ProcFormatString = proxy->format->proc;
+    proxy->proxy_info.FormatStringOffset = &proxy->format->offset[-3];
 
     hr = typelib_proxy_init(proxy, outer, funcs + parentfuncs, &parentiid, proxy_buffer, out);
     if (FAILED(hr))
     {
-        free((void *)proxy->stub_desc.pFormatTypes);
-        free((void *)proxy->proxy_info.ProcFormatString);
-        free((void *)proxy->offset_table);
+        release_typelib_format(proxy->format);
         free(proxy->proxy_vtbl);
         free(proxy);
     }
@@ -1445,7 +1596,7 @@ struct typelib_stub
     MIDL_STUB_DESC stub_desc;
     MIDL_SERVER_INFO server_info;
     CInterfaceStubVtbl stub_vtbl;
-    unsigned short *offset_table;
+    struct typelib_format *format;
     PRPC_STUB_FUNCTION *dispatch_table;
 };
 
@@ -1469,9 +1620,7 @@ static ULONG WINAPI typelib_stub_Release(IRpcStubBuffer *iface)
             free(stub->dispatch_table);
         }
 
-        free((void *)stub->stub_desc.pFormatTypes);
-        free((void *)stub->server_info.ProcString);
-        free(stub->offset_table);
+        release_typelib_format(stub->format);
         free(stub);
     }
 
@@ -1538,15 +1687,16 @@ HRESULT WINAPI CreateStubFromTypeInfo(ITypeInfo *typeinfo, REFIID iid,
     init_stub_desc(&stub->stub_desc);
     stub->server_info.pStubDesc = &stub->stub_desc;
 
-    hr = build_format_strings(real_typeinfo, funcs, parentfuncs, &stub->stub_desc.pFormatTypes,
-            &stub->server_info.ProcString, &stub->offset_table);
+    hr = get_typelib_format(real_typeinfo, funcs, parentfuncs, &stub->format);
     ITypeInfo_Release(real_typeinfo);
     if (FAILED(hr))
     {
         free(stub);
         return hr;
     }
-    stub->server_info.FmtStringOffset = &stub->offset_table[-3];
+    stub->stub_desc.pFormatTypes = stub->format->type;
+    stub->server_info.ProcString = stub->format->proc;
+    stub->server_info.FmtStringOffset = &stub->format->offset[-3];
 
     stub->iid = *iid;
     stub->stub_vtbl.header.piid = &stub->iid;
@@ -1570,9 +1720,7 @@ HRESULT WINAPI CreateStubFromTypeInfo(ITypeInfo *typeinfo, REFIID iid,
     hr = typelib_stub_init(stub, server, &parentiid, stub_buffer);
     if (FAILED(hr))
     {
-        free((void *)stub->stub_desc.pFormatTypes);
-        free((void *)stub->server_info.ProcString);
-        free(stub->offset_table);
+        release_typelib_format(stub->format);
         free(stub);
     }
 
@@ -236,13 +236,15 @@ static RPC_STATUS RpcAssoc_BindConnection(const RpcAssoc *assoc, RpcConnection *
     RPC_STATUS status;
     unsigned char *auth_data = NULL;
     ULONG auth_length;
+    USHORT features = rpcrt4_conn_request_features(conn);
+    unsigned int i;
 
     TRACE("sending bind request to server\n");
 
     hdr = RPCRT4_BuildBindHeader(NDR_LOCAL_DATA_REPRESENTATION,
                                  RPC_MAX_PACKET_SIZE, RPC_MAX_PACKET_SIZE,
                                  assoc->assoc_group_id,
-                                 InterfaceId, TransferSyntax);
+                                 InterfaceId, TransferSyntax, features);
 
     status = RPCRT4_Send(conn, hdr, NULL, 0);
     free(hdr);
@@ -268,14 +270,22 @@ static RPC_STATUS RpcAssoc_BindConnection(const RpcAssoc *assoc, RpcConnection *
             ROUND_UP(FIELD_OFFSET(RpcAddressString, string[server_address->length]), 4);
             RpcResultList *results = (RpcResultList*)((ULONG_PTR)server_address +
                 ROUND_UP(FIELD_OFFSET(RpcAddressString, string[server_address->length]), 4));
-            if ((results->num_results == 1) &&
+            if ((results->num_results == 1 || (features && results->num_results == 2)) &&
                 (remaining >= FIELD_OFFSET(RpcResultList, results[results->num_results])))
             {
                 switch (results->results[0].result)
                 {
                 case RESULT_ACCEPT:
+                    /* the server switches to the negotiated features right after the bind ack */
+                    for (i = 1; status == RPC_S_OK && i < results->num_results; i++)
+                    {
+                        if (results->results[i].result == RESULT_NEGOTIATE_ACK &&
+                            (results->results[i].reason & features))
+                            status = rpcrt4_conn_enable_features(conn, results->results[i].reason & features,
+                                                                 &results->results[i].transfer_syntax);
+                    }
                     /* respond to authorization request */
-                    if (auth_length > sizeof(RpcAuthVerifier))
+                    if (status == RPC_S_OK && auth_length > sizeof(RpcAuthVerifier))
                         status = RPCRT4_ClientConnectionAuth(conn,
                                                              auth_data + sizeof(RpcAuthVerifier),
                                                              auth_length);
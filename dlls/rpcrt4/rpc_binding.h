@@ -119,6 +119,9 @@ struct connection_ops {
   RPC_STATUS (*revert_to_self)(RpcConnection *conn);
   RPC_STATUS (*inquire_auth_client)(RpcConnection *, RPC_AUTHZ_HANDLE *, RPC_WSTR *, ULONG *, ULONG *, ULONG *, ULONG);
   RPC_STATUS (*inquire_client_pid)(RpcConnection *conn, ULONG *pid);
+  USHORT (*request_features)(RpcConnection *conn);
+  USHORT (*accept_features)(RpcConnection *conn, USHORT features, RPC_SYNTAX_IDENTIFIER *data);
+  RPC_STATUS (*enable_features)(RpcConnection *conn, USHORT features, const RPC_SYNTAX_IDENTIFIER *data);
 };
 
 /* don't know what MS's structure looks like */
@@ -254,6 +257,24 @@ static inline RPC_STATUS rpcrt4_conn_inquire_auth_client(
     return conn->ops->inquire_auth_client(conn, privs, server_princ_name, authn_level, authn_svc, authz_svc, flags);
 }
 
+/* bind time features supported by the transport */
+static inline USHORT rpcrt4_conn_request_features(RpcConnection *conn)
+{
+    return conn->ops->request_features ? conn->ops->request_features(conn) : 0;
+}
+
+static inline USHORT rpcrt4_conn_accept_features(RpcConnection *conn, USHORT features,
+                                                 RPC_SYNTAX_IDENTIFIER *data)
+{
+    return conn->ops->accept_features ? conn->ops->accept_features(conn, features, data) : 0;
+}
+
+static inline RPC_STATUS rpcrt4_conn_enable_features(RpcConnection *conn, USHORT features,
+                                                     const RPC_SYNTAX_IDENTIFIER *data)
+{
+    return conn->ops->enable_features ? conn->ops->enable_features(conn, features, data) : RPC_S_OK;
+}
+
 /* floors 3 and up */
 RPC_STATUS RpcTransport_GetTopOfTower(unsigned char *tower_data, size_t *tower_size, const char *protseq, const char *networkaddr, const char *endpoint) DECLSPEC_HIDDEN;
 RPC_STATUS RpcTransport_ParseTopOfTower(const unsigned char *tower_data, size_t tower_size, char **protseq, char **networkaddr, char **endpoint) DECLSPEC_HIDDEN;
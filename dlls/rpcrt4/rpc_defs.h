@@ -211,12 +211,19 @@ enum rpc_packet_type
 #define RESULT_ACCEPT               0
 #define RESULT_USER_REJECTION       1
 #define RESULT_PROVIDER_REJECTION   2
+#define RESULT_NEGOTIATE_ACK        3
 
 #define REASON_NONE                             0
 #define REASON_ABSTRACT_SYNTAX_NOT_SUPPORTED    1
 #define REASON_TRANSFER_SYNTAXES_NOT_SUPPORTED  2
 #define REASON_LOCAL_LIMIT_EXCEEDED             3
 
+/* bind time feature negotiation, the features are requested in the last
+ * bytes of the transfer syntax and acknowledged in the result reason */
+#define BIND_FEATURE_SECURITY_CONTEXT_MULTIPLEXING  0x0001
+#define BIND_FEATURE_KEEP_CONNECTION_ON_ORPHAN      0x0002
+#define BIND_FEATURE_WINE_SHARED_MEMORY             0x8000  /* ncalrpc between Wine processes */
+
 #define REJECT_REASON_NOT_SPECIFIED            0
 #define REJECT_TEMPORARY_CONGESTION            1
 #define REJECT_LOCAL_LIMIT_EXCEEDED            2
@@ -183,32 +183,58 @@ RpcPktHdr *RPCRT4_BuildFaultHeader(ULONG DataRepresentation, RPC_STATUS Status)
   return (RpcPktHdr *)header;
 }
 
+/* bind time feature negotiation syntax, the last 8 bytes hold the requested features */
+static const RPC_SYNTAX_IDENTIFIER bind_feature_syntax =
+    { { 0x6cb71c2c, 0x9812, 0x4540, { 0 } }, { 1, 0 } };
+
+BOOL RPCRT4_IsBindFeatureSyntax(const RPC_SYNTAX_IDENTIFIER *syntax, unsigned short *features)
+{
+  if (memcmp(&syntax->SyntaxGUID, &bind_feature_syntax.SyntaxGUID, FIELD_OFFSET(GUID, Data4)))
+    return FALSE;
+  *features = syntax->SyntaxGUID.Data4[0] | (syntax->SyntaxGUID.Data4[1] << 8);
+  return TRUE;
+}
+
 RpcPktHdr *RPCRT4_BuildBindHeader(ULONG DataRepresentation,
                                   unsigned short MaxTransmissionSize,
                                   unsigned short MaxReceiveSize,
                                   ULONG  AssocGroupId,
                                   const RPC_SYNTAX_IDENTIFIER *AbstractId,
-                                  const RPC_SYNTAX_IDENTIFIER *TransferId)
+                                  const RPC_SYNTAX_IDENTIFIER *TransferId,
+                                  unsigned short Features)
 {
   RpcPktHdr *header;
   RpcContextElement *ctxt_elem;
+  unsigned int num_elements = Features ? 2 : 1;
+  ULONG size = sizeof(header->bind) + num_elements * FIELD_OFFSET(RpcContextElement, transfer_syntaxes[1]);
 
-  header = calloc(1, sizeof(header->bind) + FIELD_OFFSET(RpcContextElement, transfer_syntaxes[1]));
+  header = calloc(1, size);
   if (header == NULL) {
     return NULL;
   }
   ctxt_elem = (RpcContextElement *)(&header->bind + 1);
 
   RPCRT4_BuildCommonHeader(&header->common, PKT_BIND, DataRepresentation);
-  header->common.frag_len = sizeof(header->bind) + FIELD_OFFSET(RpcContextElement, transfer_syntaxes[1]);
+  header->common.frag_len = size;
   header->bind.max_tsize = MaxTransmissionSize;
   header->bind.max_rsize = MaxReceiveSize;
   header->bind.assoc_gid = AssocGroupId;
-  header->bind.num_elements = 1;
+  header->bind.num_elements = num_elements;
   ctxt_elem->num_syntaxes = 1;
   ctxt_elem->abstract_syntax = *AbstractId;
   ctxt_elem->transfer_syntaxes[0] = *TransferId;
 
+  if (Features)
+  {
+    ctxt_elem = (RpcContextElement *)&ctxt_elem->transfer_syntaxes[1];
+    ctxt_elem->context_id = 1;
+    ctxt_elem->num_syntaxes = 1;
+    ctxt_elem->abstract_syntax = *AbstractId;
+    ctxt_elem->transfer_syntaxes[0] = bind_feature_syntax;
+    ctxt_elem->transfer_syntaxes[0].SyntaxGUID.Data4[0] = Features & 0xff;
+    ctxt_elem->transfer_syntaxes[0].SyntaxGUID.Data4[1] = Features >> 8;
+  }
+
   return header;
 }
 
@@ -205,11 +205,12 @@ static RpcPktHdr *handle_bind_error(RpcConnection *conn, RPC_STATUS error)
 static RPC_STATUS process_bind_packet_no_send(
     RpcConnection *conn, RpcPktBindHdr *hdr, RPC_MESSAGE *msg,
     unsigned char *auth_data, ULONG auth_length, RpcPktHdr **ack_response,
-    unsigned char **auth_data_out, ULONG *auth_length_out)
+    unsigned char **auth_data_out, ULONG *auth_length_out, USHORT *features)
 {
   RPC_STATUS status;
   RpcContextElement *ctxt_elem;
-  unsigned int i;
+  unsigned int i, feature_index = 0;
+  USHORT requested = 0;
   RpcResult *results;
 
   /* validate data */
@@ -246,6 +247,17 @@ static RPC_STATUS process_bind_packet_no_send(
       RpcServerInterface* sif = NULL;
       unsigned int j;
 
+      if (ctxt_elem->num_syntaxes &&
+          RPCRT4_IsBindFeatureSyntax(&ctxt_elem->transfer_syntaxes[0], &requested))
+      {
+          TRACE("bind time features %#x requested on connection %p\n", requested, conn);
+          results[i].result = RESULT_NEGOTIATE_ACK;
+          results[i].reason = 0;
+          memset(&results[i].transfer_syntax, 0, sizeof(results[i].transfer_syntax));
+          feature_index = i;
+          continue;
+      }
+
       for (j = 0; !sif && j < ctxt_elem->num_syntaxes; j++)
       {
           sif = RPCRT4_find_interface(NULL, &ctxt_elem->abstract_syntax,
@@ -318,6 +330,11 @@ static RPC_STATUS process_bind_packet_no_send(
       }
   }
 
+  /* the transport only switches once the bind ack has been sent */
+  if (requested && !UuidIsNil(&conn->ActiveInterface.SyntaxGUID, &status))
+      *features = results[feature_index].reason =
+          rpcrt4_conn_accept_features(conn, requested, &results[feature_index].transfer_syntax);
+
   *ack_response = RPCRT4_BuildBindAckHeader(NDR_LOCAL_DATA_REPRESENTATION,
                                             RPC_MAX_PACKET_SIZE,
                                             RPC_MAX_PACKET_SIZE,
@@ -343,10 +360,11 @@ static RPC_STATUS process_bind_packet(RpcConnection *conn, RpcPktBindHdr *hdr,
     RpcPktHdr *response = NULL;
     unsigned char *auth_data_out = NULL;
     ULONG auth_length_out = 0;
+    USHORT features = 0;
 
     status = process_bind_packet_no_send(conn, hdr, msg, auth_data, auth_length,
                                          &response, &auth_data_out,
-                                         &auth_length_out);
+                                         &auth_length_out, &features);
     if (status != RPC_S_OK)
         response = handle_bind_error(conn, status);
     if (response)
@@ -355,6 +373,9 @@ static RPC_STATUS process_bind_packet(RpcConnection *conn, RpcPktBindHdr *hdr,
         status = ERROR_OUTOFMEMORY;
     free(response);
 
+    if (status == RPC_S_OK && features)
+        status = rpcrt4_conn_enable_features(conn, features, NULL);
+
     return status;
 }
 
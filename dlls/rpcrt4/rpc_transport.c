@@ -68,6 +68,8 @@ typedef struct _RpcConnection_np
     IO_STATUS_BLOCK io_status;
     HANDLE event_cache;
     BOOL read_closed;
+    struct lrpc_shm_conn *lrpc;
+    struct lrpc_shm_conn *lrpc_pending;  /* server side, until the bind ack is sent */
 } RpcConnection_np;
 
 static RpcConnection *rpcrt4_conn_np_alloc(void)
@@ -468,6 +470,408 @@ static int rpcrt4_conn_np_wait_for_incoming_data(RpcConnection *conn)
     return rpcrt4_conn_np_read(conn, NULL, 0);
 }
 
+/* Once the pipe is connected, ncalrpc clients ask the server through bind
+ * time feature negotiation to move the connection to shared memory. The
+ * server then creates an unnamed section holding one ring buffer per
+ * direction plus the signalling events, duplicates them into the client
+ * process and passes the section handle back in the bind ack. Packets that
+ * follow the bind ack no longer go through the server's pipe queue. The
+ * pipe is kept open for impersonation and for querying the client process. */
+
+#define LRPC_SHM_RING_SIZE  0x10000
+#define LRPC_SHM_SPIN_COUNT 200
+
+struct lrpc_shm_ring
+{
+    LONG head;              /* total number of bytes written */
+    LONG tail;              /* total number of bytes read */
+    LONG reader_waiting;
+    LONG writer_waiting;
+    char data[LRPC_SHM_RING_SIZE];
+};
+
+struct lrpc_shm
+{
+    LONG closed;
+    /* handles duplicated into the client process */
+    ULONG client_server_process;
+    ULONG client_data_event[2];
+    ULONG client_space_event[2];
+    struct lrpc_shm_ring ring[2];  /* client to server, server to client */
+};
+
+struct lrpc_shm_conn
+{
+    struct lrpc_shm *shm;
+    HANDLE mapping;
+    HANDLE data_event[2];
+    HANDLE space_event[2];
+    HANDLE peer;
+    CRITICAL_SECTION write_cs;
+    LONG cancelled;
+};
+
+static struct lrpc_shm_conn *lrpc_shm_alloc(void)
+{
+    struct lrpc_shm_conn *lrpc;
+
+    if (!(lrpc = calloc(1, sizeof(*lrpc))))
+        return NULL;
+    InitializeCriticalSection(&lrpc->write_cs);
+    lrpc->write_cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": lrpc_shm_conn.write_cs");
+    return lrpc;
+}
+
+static void lrpc_shm_free(struct lrpc_shm_conn *lrpc)
+{
+    unsigned int i;
+
+    if (lrpc->shm) UnmapViewOfFile(lrpc->shm);
+    if (lrpc->mapping) CloseHandle(lrpc->mapping);
+    for (i = 0; i < 2; i++)
+    {
+        if (lrpc->data_event[i]) CloseHandle(lrpc->data_event[i]);
+        if (lrpc->space_event[i]) CloseHandle(lrpc->space_event[i]);
+    }
+    if (lrpc->peer) CloseHandle(lrpc->peer);
+    lrpc->write_cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&lrpc->write_cs);
+    free(lrpc);
+}
+
+static BOOL lrpc_shm_export(HANDLE client, HANDLE handle, DWORD access, ULONG *ret)
+{
+    HANDLE remote;
+
+    if (!DuplicateHandle(GetCurrentProcess(), handle, client, &remote, access, FALSE,
+                         access ? 0 : DUPLICATE_SAME_ACCESS))
+        return FALSE;
+    *ret = HandleToULong(remote);
+    return TRUE;
+}
+
+static void lrpc_shm_unexport(HANDLE client, ULONG handle)
+{
+    if (handle)
+        DuplicateHandle(client, ULongToHandle(handle), NULL, NULL, 0, FALSE, DUPLICATE_CLOSE_SOURCE);
+}
+
+/* create the shared memory for the given client, the client handles are stored in the section */
+static struct lrpc_shm_conn *lrpc_shm_create(HANDLE client, ULONG *client_mapping)
+{
+    struct lrpc_shm_conn *lrpc;
+    unsigned int i;
+
+    if (!(lrpc = lrpc_shm_alloc()))
+        return NULL;
+
+    if (!(lrpc->mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+                                             sizeof(struct lrpc_shm), NULL)))
+        goto fail;
+    if (!(lrpc->shm = MapViewOfFile(lrpc->mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(struct lrpc_shm))))
+        goto fail;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (!(lrpc->data_event[i] = CreateEventW(NULL, FALSE, FALSE, NULL)))
+            goto fail;
+        if (!(lrpc->space_event[i] = CreateEventW(NULL, FALSE, FALSE, NULL)))
+            goto fail;
+    }
+
+    if (!lrpc_shm_export(client, GetCurrentProcess(), SYNCHRONIZE, &lrpc->shm->client_server_process))
+        goto fail;
+    for (i = 0; i < 2; i++)
+    {
+        if (!lrpc_shm_export(client, lrpc->data_event[i], 0, &lrpc->shm->client_data_event[i]))
+            goto fail;
+        if (!lrpc_shm_export(client, lrpc->space_event[i], 0, &lrpc->shm->client_space_event[i]))
+            goto fail;
+    }
+    if (!lrpc_shm_export(client, lrpc->mapping, 0, client_mapping))
+        goto fail;
+
+    lrpc->peer = client;
+    return lrpc;
+
+fail:
+    WARN("failed to set up shared memory, error %lu\n", GetLastError());
+    if (lrpc->shm)
+    {
+        lrpc_shm_unexport(client, lrpc->shm->client_server_process);
+        for (i = 0; i < 2; i++)
+        {
+            lrpc_shm_unexport(client, lrpc->shm->client_data_event[i]);
+            lrpc_shm_unexport(client, lrpc->shm->client_space_event[i]);
+        }
+    }
+    lrpc_shm_free(lrpc);
+    return NULL;
+}
+
+/* take over the handles that the server duplicated into this process */
+static struct lrpc_shm_conn *lrpc_shm_open(HANDLE mapping)
+{
+    struct lrpc_shm_conn *lrpc;
+    unsigned int i;
+
+    if (!(lrpc = lrpc_shm_alloc()))
+    {
+        CloseHandle(mapping);
+        return NULL;
+    }
+
+    lrpc->mapping = mapping;
+    if (!(lrpc->shm = MapViewOfFile(lrpc->mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(struct lrpc_shm))))
+    {
+        WARN("failed to map shared memory, error %lu\n", GetLastError());
+        lrpc_shm_free(lrpc);
+        return NULL;
+    }
+
+    lrpc->peer = ULongToHandle(lrpc->shm->client_server_process);
+    for (i = 0; i < 2; i++)
+    {
+        lrpc->data_event[i] = ULongToHandle(lrpc->shm->client_data_event[i]);
+        lrpc->space_event[i] = ULongToHandle(lrpc->shm->client_space_event[i]);
+    }
+    return lrpc;
+}
+
+static void lrpc_shm_close(struct lrpc_shm_conn *lrpc)
+{
+    unsigned int i;
+
+    InterlockedExchange(&lrpc->shm->closed, TRUE);
+    for (i = 0; i < 2; i++)
+    {
+        SetEvent(lrpc->data_event[i]);
+        SetEvent(lrpc->space_event[i]);
+    }
+    lrpc_shm_free(lrpc);
+}
+
+/* wait until *pos no longer equals value */
+static BOOL lrpc_shm_wait(RpcConnection_np *npc, LONG volatile *waiting, LONG volatile *pos, LONG value,
+                          HANDLE event, BOOL reading)
+{
+    struct lrpc_shm_conn *lrpc = npc->lrpc;
+    HANDLE handles[2] = { event, lrpc->peer };
+    unsigned int i, spin_count = NtCurrentTeb()->Peb->NumberOfProcessors > 1 ? LRPC_SHM_SPIN_COUNT : 0;
+
+    /* the peer is usually about to reply, avoid a server round trip if it does so quickly */
+    for (i = 0; i < spin_count; i++)
+    {
+        if (ReadAcquire(pos) != value) return TRUE;
+        YieldProcessor();
+    }
+
+    for (;;)
+    {
+        InterlockedExchange(waiting, TRUE);
+        if (ReadAcquire(pos) != value) break;
+        if (ReadNoFence(&lrpc->shm->closed)) return FALSE;
+        if (reading && (npc->read_closed || InterlockedExchange(&lrpc->cancelled, FALSE))) return FALSE;
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+        {
+            WARN("peer process went away\n");
+            return FALSE;
+        }
+    }
+    WriteNoFence(waiting, FALSE);
+    return TRUE;
+}
+
+static int lrpc_shm_read(RpcConnection_np *npc, void *buffer, unsigned int count)
+{
+    struct lrpc_shm_conn *lrpc = npc->lrpc;
+    unsigned int in = !npc->common.server;
+    struct lrpc_shm_ring *ring = &lrpc->shm->ring[in];
+    LONG head, tail = ReadNoFence(&ring->tail);
+    unsigned int len, pos, done = 0;
+
+    for (;;)
+    {
+        head = ReadAcquire(&ring->head);
+        if (head == tail)
+        {
+            if (!lrpc_shm_wait(npc, &ring->reader_waiting, &ring->head, tail, lrpc->data_event[in], TRUE))
+                return -1;
+            continue;
+        }
+        if (done == count) break;
+
+        pos = (ULONG)tail % LRPC_SHM_RING_SIZE;
+        len = min((ULONG)(head - tail), count - done);
+        len = min(len, LRPC_SHM_RING_SIZE - pos);
+        memcpy((char *)buffer + done, ring->data + pos, len);
+        done += len;
+        tail += len;
+
+        InterlockedExchange(&ring->tail, tail);
+        if (ReadNoFence(&ring->writer_waiting) && InterlockedExchange(&ring->writer_waiting, FALSE))
+            SetEvent(lrpc->space_event[in]);
+        if (done == count) break;
+    }
+    return done;
+}
+
+static int lrpc_shm_write(RpcConnection_np *npc, const void *buffer, unsigned int count)
+{
+    struct lrpc_shm_conn *lrpc = npc->lrpc;
+    unsigned int out = npc->common.server;
+    struct lrpc_shm_ring *ring = &lrpc->shm->ring[out];
+    unsigned int len, pos, done = 0;
+    LONG head, tail;
+
+    /* a client write starts a new call, forget cancels that arrived too late for the previous one */
+    if (!npc->common.server) InterlockedExchange(&lrpc->cancelled, FALSE);
+
+    EnterCriticalSection(&lrpc->write_cs);
+    head = ReadNoFence(&ring->head);
+    while (done < count)
+    {
+        if (ReadNoFence(&lrpc->shm->closed)) break;
+
+        tail = ReadAcquire(&ring->tail);
+        if ((ULONG)(head - tail) == LRPC_SHM_RING_SIZE)
+        {
+            if (!lrpc_shm_wait(npc, &ring->writer_waiting, &ring->tail, tail, lrpc->space_event[out], FALSE))
+                break;
+            continue;
+        }
+
+        pos = (ULONG)head % LRPC_SHM_RING_SIZE;
+        len = min(LRPC_SHM_RING_SIZE - (ULONG)(head - tail), count - done);
+        len = min(len, LRPC_SHM_RING_SIZE - pos);
+        memcpy(ring->data + pos, (const char *)buffer + done, len);
+        done += len;
+        head += len;
+
+        InterlockedExchange(&ring->head, head);
+        if (ReadNoFence(&ring->reader_waiting) && InterlockedExchange(&ring->reader_waiting, FALSE))
+            SetEvent(lrpc->data_event[out]);
+    }
+    LeaveCriticalSection(&lrpc->write_cs);
+    return done == count ? count : -1;
+}
+
+static USHORT rpcrt4_ncalrpc_request_features(RpcConnection *conn)
+{
+    return BIND_FEATURE_WINE_SHARED_MEMORY;
+}
+
+static USHORT rpcrt4_ncalrpc_accept_features(RpcConnection *conn, USHORT features, RPC_SYNTAX_IDENTIFIER *data)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+    HANDLE client;
+    ULONG pid, mapping;
+
+    if (!(features & BIND_FEATURE_WINE_SHARED_MEMORY) || npc->lrpc || npc->lrpc_pending)
+        return 0;
+
+    /* the objects are only handed to the process on the other end of the pipe */
+    if (!GetNamedPipeClientProcessId(npc->pipe, &pid) ||
+        !(client = OpenProcess(PROCESS_DUP_HANDLE | SYNCHRONIZE, FALSE, pid)))
+    {
+        WARN("can't access client process, error %lu\n", GetLastError());
+        return 0;
+    }
+    if (!(npc->lrpc_pending = lrpc_shm_create(client, &mapping)))
+    {
+        CloseHandle(client);
+        return 0;
+    }
+
+    memset(data, 0, sizeof(*data));
+    data->SyntaxGUID.Data1 = mapping;
+    return BIND_FEATURE_WINE_SHARED_MEMORY;
+}
+
+static RPC_STATUS rpcrt4_ncalrpc_enable_features(RpcConnection *conn, USHORT features,
+                                                 const RPC_SYNTAX_IDENTIFIER *data)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+
+    if (!(features & BIND_FEATURE_WINE_SHARED_MEMORY))
+        return RPC_S_OK;
+
+    /* the server has switched after sending the bind ack, so a client that
+     * can't follow has to drop the connection */
+    if (conn->server)
+    {
+        npc->lrpc = npc->lrpc_pending;
+        npc->lrpc_pending = NULL;
+    }
+    else if (!npc->lrpc && !(npc->lrpc = lrpc_shm_open(ULongToHandle(data->SyntaxGUID.Data1))))
+        return RPC_S_OUT_OF_RESOURCES;
+
+    TRACE("%p: using shared memory\n", conn);
+    return RPC_S_OK;
+}
+
+static int rpcrt4_ncalrpc_read(RpcConnection *conn, void *buffer, unsigned int count)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+
+    if (npc->lrpc)
+        return lrpc_shm_read(npc, buffer, count);
+    return rpcrt4_conn_np_read(conn, buffer, count);
+}
+
+static int rpcrt4_ncalrpc_write(RpcConnection *conn, const void *buffer, unsigned int count)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+
+    if (npc->lrpc)
+        return lrpc_shm_write(npc, buffer, count);
+    return rpcrt4_conn_np_write(conn, buffer, count);
+}
+
+static int rpcrt4_ncalrpc_close(RpcConnection *conn)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+
+    if (npc->lrpc)
+    {
+        lrpc_shm_close(npc->lrpc);
+        npc->lrpc = NULL;
+    }
+    if (npc->lrpc_pending)
+    {
+        lrpc_shm_free(npc->lrpc_pending);
+        npc->lrpc_pending = NULL;
+    }
+    return rpcrt4_conn_np_close(conn);
+}
+
+static void rpcrt4_ncalrpc_close_read(RpcConnection *conn)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+
+    rpcrt4_conn_np_close_read(conn);
+    if (npc->lrpc)
+        SetEvent(npc->lrpc->data_event[!conn->server]);
+}
+
+static void rpcrt4_ncalrpc_cancel_call(RpcConnection *conn)
+{
+    RpcConnection_np *npc = (RpcConnection_np *)conn;
+
+    if (npc->lrpc)
+    {
+        InterlockedExchange(&npc->lrpc->cancelled, TRUE);
+        SetEvent(npc->lrpc->data_event[!conn->server]);
+    }
+    else
+        rpcrt4_conn_np_cancel_call(conn);
+}
+
+static int rpcrt4_ncalrpc_wait_for_incoming_data(RpcConnection *conn)
+{
+    return rpcrt4_ncalrpc_read(conn, NULL, 0);
+}
+
 static size_t rpcrt4_ncacn_np_get_top_of_tower(unsigned char *tower_data,
                                                const char *networkaddr,
                                                const char *endpoint)
@@ -3145,13 +3549,13 @@ static const struct connection_ops conn_protseq_list[] = {
     rpcrt4_conn_np_alloc,
     rpcrt4_ncalrpc_open,
     rpcrt4_ncalrpc_handoff,
-    rpcrt4_conn_np_read,
-    rpcrt4_conn_np_write,
-    rpcrt4_conn_np_close,
-    rpcrt4_conn_np_close_read,
-    rpcrt4_conn_np_cancel_call,
+    rpcrt4_ncalrpc_read,
+    rpcrt4_ncalrpc_write,
+    rpcrt4_ncalrpc_close,
+    rpcrt4_ncalrpc_close_read,
+    rpcrt4_ncalrpc_cancel_call,
     rpcrt4_ncalrpc_np_is_server_listening,
-    rpcrt4_conn_np_wait_for_incoming_data,
+    rpcrt4_ncalrpc_wait_for_incoming_data,
     rpcrt4_ncalrpc_get_top_of_tower,
     rpcrt4_ncalrpc_parse_top_of_tower,
     NULL,
@@ -3161,7 +3565,10 @@ static const struct connection_ops conn_protseq_list[] = {
     rpcrt4_conn_np_impersonate_client,
     rpcrt4_conn_np_revert_to_self,
     rpcrt4_ncalrpc_inquire_auth_client,
-    rpcrt4_ncalrpc_inquire_client_pid
+    rpcrt4_ncalrpc_inquire_client_pid,
+    rpcrt4_ncalrpc_request_features,
+    rpcrt4_ncalrpc_accept_features,
+    rpcrt4_ncalrpc_enable_features
   },
   { "ncacn_ip_tcp",
     { EPM_PROTOCOL_NCACN, EPM_PROTOCOL_TCP },
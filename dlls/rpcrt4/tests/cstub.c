@@ -1549,6 +1549,166 @@ static void test_ChannelBufferRefCount(IPSFactoryBuffer *ppsf)
     ok(!stubMessage.pRpcChannelBuffer, "dangling pRpcChannelBuffer = %p\n", stubMessage.pRpcChannelBuffer);
 }
 
+static GUID LIBID_typelib_test = {0x1234567d, 1234, 5678, {12,34,56,78,90,0xab,0xcd,0xef}};
+static GUID IID_typelib_if1 = {0x1234567e, 1234, 5678, {12,34,56,78,90,0xab,0xcd,0xef}};
+static GUID IID_typelib_if2 = {0x1234567f, 1234, 5678, {12,34,56,78,90,0xab,0xcd,0xef}};
+
+static ITypeInfo *create_test_typeinfo(ICreateTypeLib2 *typelib, ITypeInfo *unknown,
+        const WCHAR *name, const GUID *iid, WORD params)
+{
+    ELEMDESC elemdesc[2];
+    FUNCDESC funcdesc;
+    ICreateTypeInfo *create;
+    ITypeInfo *typeinfo;
+    HREFTYPE href;
+    HRESULT hr;
+    WORD i;
+
+    hr = ICreateTypeLib2_CreateTypeInfo(typelib, (WCHAR *)name, TKIND_INTERFACE, &create);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ICreateTypeInfo_SetGuid(create, iid);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ICreateTypeInfo_SetTypeFlags(create, TYPEFLAG_FOLEAUTOMATION);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ICreateTypeInfo_AddRefTypeInfo(create, unknown, &href);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ICreateTypeInfo_AddImplType(create, 0, href);
+    ok(hr == S_OK, "got %#lx\n", hr);
+
+    memset(elemdesc, 0, sizeof(elemdesc));
+    for (i = 0; i < params; i++)
+    {
+        elemdesc[i].tdesc.vt = VT_I4;
+        U(elemdesc[i]).paramdesc.wParamFlags = PARAMFLAG_FIN;
+    }
+    memset(&funcdesc, 0, sizeof(funcdesc));
+    funcdesc.funckind = FUNC_PUREVIRTUAL;
+    funcdesc.invkind = INVOKE_FUNC;
+    funcdesc.callconv = CC_STDCALL;
+    funcdesc.cParams = params;
+    funcdesc.lprgelemdescParam = elemdesc;
+    funcdesc.elemdescFunc.tdesc.vt = VT_HRESULT;
+    hr = ICreateTypeInfo_AddFuncDesc(create, 0, &funcdesc);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ICreateTypeInfo_LayOut(create);
+    ok(hr == S_OK, "got %#lx\n", hr);
+
+    hr = ICreateTypeInfo_QueryInterface(create, &IID_ITypeInfo, (void **)&typeinfo);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    ICreateTypeInfo_Release(create);
+    return typeinfo;
+}
+
+static const MIDL_STUBLESS_PROXY_INFO *get_typelib_proxy_info(IUnknown *iface)
+{
+    const CInterfaceProxyHeader *header = *(const CInterfaceProxyHeader **)iface;
+    return header[-1].pStublessProxyInfo;
+}
+
+static const MIDL_SERVER_INFO *get_typelib_server_info(IRpcStubBuffer *stub)
+{
+    const CInterfaceStubVtbl *vtbl = CONTAINING_RECORD(stub->lpVtbl, CInterfaceStubVtbl, Vtbl);
+    return vtbl->header.pServerInfo;
+}
+
+static void test_typelib_format_cache(void)
+{
+    HRESULT (WINAPI *pCreateProxyFromTypeInfo)(ITypeInfo *, IUnknown *, REFIID, IRpcProxyBuffer **, void **);
+    HRESULT (WINAPI *pCreateStubFromTypeInfo)(ITypeInfo *, REFIID, IUnknown *, IRpcStubBuffer **);
+    const MIDL_STUBLESS_PROXY_INFO *info1, *info2, *info3;
+    const MIDL_SERVER_INFO *server_info;
+    HMODULE rpcrt4 = GetModuleHandleA("rpcrt4.dll");
+    IRpcProxyBuffer *proxy1, *proxy2, *proxy3;
+    IUnknown *iface1, *iface2, *iface3;
+    ITypeInfo *unknown, *typeinfo1, *typeinfo2;
+    ICreateTypeLib2 *typelib;
+    unsigned char saved[16];
+    IRpcStubBuffer *stub;
+    ITypeLib *stdole;
+    ULONG refs;
+    HRESULT hr;
+
+    pCreateProxyFromTypeInfo = (void *)GetProcAddress(rpcrt4, "CreateProxyFromTypeInfo");
+    pCreateStubFromTypeInfo = (void *)GetProcAddress(rpcrt4, "CreateStubFromTypeInfo");
+    if (!pCreateProxyFromTypeInfo || !pCreateStubFromTypeInfo)
+    {
+        win_skip("CreateProxyFromTypeInfo is not available.\n");
+        return;
+    }
+
+    hr = LoadTypeLib(L"stdole2.tlb", &stdole);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ITypeLib_GetTypeInfoOfGuid(stdole, &IID_IUnknown, &unknown);
+    ok(hr == S_OK, "got %#lx\n", hr);
+
+    hr = CreateTypeLib2(sizeof(void *) == 8 ? SYS_WIN64 : SYS_WIN32, L"test_typelib_format.tlb", &typelib);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = ICreateTypeLib2_SetGuid(typelib, &LIBID_typelib_test);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    typeinfo1 = create_test_typeinfo(typelib, unknown, L"ITypelibTest1", &IID_typelib_if1, 1);
+    typeinfo2 = create_test_typeinfo(typelib, unknown, L"ITypelibTest2", &IID_typelib_if2, 2);
+
+    hr = pCreateProxyFromTypeInfo(typeinfo1, NULL, &IID_typelib_if1, &proxy1, (void **)&iface1);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = pCreateProxyFromTypeInfo(typeinfo1, NULL, &IID_typelib_if1, &proxy2, (void **)&iface2);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    hr = pCreateProxyFromTypeInfo(typeinfo2, NULL, &IID_typelib_if2, &proxy3, (void **)&iface3);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    ok(iface1 != iface2, "got the same proxy\n");
+
+    info1 = get_typelib_proxy_info(iface1);
+    info2 = get_typelib_proxy_info(iface2);
+    info3 = get_typelib_proxy_info(iface3);
+    ok(!memcmp(info1->ProcFormatString, info2->ProcFormatString, sizeof(saved)), "got different formats\n");
+    ok(memcmp(info1->ProcFormatString, info3->ProcFormatString, sizeof(saved)), "got the same format\n");
+    memcpy(saved, info1->ProcFormatString, sizeof(saved));
+
+    if (!strcmp(winetest_platform, "wine"))
+    {
+        /* proxies and stubs for the same interface share their format strings */
+        ok(info1->ProcFormatString == info2->ProcFormatString, "format strings are not shared\n");
+        ok(info1->pStubDesc->pFormatTypes == info2->pStubDesc->pFormatTypes, "type formats are not shared\n");
+        ok(info1->ProcFormatString != info3->ProcFormatString, "format strings are shared\n");
+
+        dummy_unknown.ref = 4;
+        hr = pCreateStubFromTypeInfo(typeinfo1, &IID_typelib_if1, &dummy_unknown.IUnknown_iface, &stub);
+        ok(hr == S_OK, "got %#lx\n", hr);
+        server_info = get_typelib_server_info(stub);
+        ok(server_info->ProcString == info1->ProcFormatString, "format strings are not shared\n");
+        IRpcStubBuffer_Release(stub);
+        ok(dummy_unknown.ref == 4, "got %ld\n", dummy_unknown.ref);
+    }
+
+    /* the format stays valid as long as one proxy references it */
+    refs = IUnknown_Release(iface1);
+    ok(refs == 1, "got %lu\n", refs);
+    refs = IRpcProxyBuffer_Release(proxy1);
+    ok(!refs, "got %lu\n", refs);
+    ok(!memcmp(info2->ProcFormatString, saved, sizeof(saved)), "format string changed\n");
+
+    refs = IUnknown_Release(iface2);
+    ok(refs == 1, "got %lu\n", refs);
+    refs = IRpcProxyBuffer_Release(proxy2);
+    ok(!refs, "got %lu\n", refs);
+
+    /* and is built again once every user is gone */
+    hr = pCreateProxyFromTypeInfo(typeinfo1, NULL, &IID_typelib_if1, &proxy1, (void **)&iface1);
+    ok(hr == S_OK, "got %#lx\n", hr);
+    info1 = get_typelib_proxy_info(iface1);
+    ok(!memcmp(info1->ProcFormatString, saved, sizeof(saved)), "got different formats\n");
+    IUnknown_Release(iface1);
+    IRpcProxyBuffer_Release(proxy1);
+
+    IUnknown_Release(iface3);
+    IRpcProxyBuffer_Release(proxy3);
+
+    ITypeInfo_Release(typeinfo2);
+    ITypeInfo_Release(typeinfo1);
+    ICreateTypeLib2_Release(typelib);
+    ITypeInfo_Release(unknown);
+    ITypeLib_Release(stdole);
+}
+
 START_TEST( cstub )
 {
     IPSFactoryBuffer *ppsf;
@@ -1575,6 +1735,7 @@ START_TEST( cstub )
     test_NdrDllRegisterProxy();
     test_delegated_methods();
     test_ChannelBufferRefCount(ppsf);
+    test_typelib_format_cache();
 
     OleUninitialize();
 }
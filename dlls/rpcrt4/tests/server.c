@@ -1987,6 +1987,57 @@ run_tests(void)
   test_handle_return();
 }
 
+static void
+test_call_rate(void)
+{
+  static int a[20000];
+  vector_t vs[8], u, v;
+  DWORD start, handles, new_handles;
+  int i, j, n, x, expect = 0;
+
+  /* the first call connects, Wine servers then duplicate the shared memory
+   * section, its four events and the server process into the client */
+  GetProcessHandleCount(GetCurrentProcess(), &handles);
+  ok(sum(1, 2) == 3, "RPC sum\n");
+  GetProcessHandleCount(GetCurrentProcess(), &new_handles);
+  if (!strcmp(winetest_platform, "wine"))
+    ok(new_handles - handles >= 6, "got %lu new handles, shared memory not used\n", new_handles - handles);
+
+  start = GetTickCount();
+  for (i = 0; i < 2000; i++)
+    if (sum(i, 1) != i + 1) break;
+  ok(i == 2000, "RPC sum failed at call %d\n", i);
+  trace("%d calls in %lu ms\n", i, GetTickCount() - start);
+
+  /* repeated calls of the same procedure with structs and conformant arrays */
+  start = GetTickCount();
+  for (i = 0; i < 1000; i++)
+  {
+    u.x = i; u.y = 1; u.z = -1;
+    v.x = 2; v.y = i; v.z = 3;
+    if (dot_copy_vectors(u, v) != 3 * i - 3) break;
+
+    n = 1 + i % ARRAY_SIZE(vs);
+    for (j = 0, x = 0; j < n; j++)
+    {
+      vs[j].x = i; vs[j].y = -j; vs[j].z = 1;
+      x += i + j + 1;
+    }
+    if (sum_L1_norms(n, vs) != x) break;
+  }
+  ok(i == 1000, "RPC struct calls failed at call %d\n", i);
+  trace("%d struct calls in %lu ms\n", i, GetTickCount() - start);
+
+  /* larger than a single fragment */
+  for (i = 0; i < ARRAY_SIZE(a); i++)
+  {
+    a[i] = i;
+    expect += i;
+  }
+  for (i = 0; i < 10; i++)
+    ok(sum_conf_array(a, ARRAY_SIZE(a)) == expect, "RPC sum_conf_array\n");
+}
+
 static void
 set_auth_info(RPC_BINDING_HANDLE handle)
 {
@@ -2068,6 +2119,7 @@ client(const char *test)
     ok(RPC_S_OK == RpcStringBindingComposeA(NULL, ncalrpc, NULL, guid, NULL, &binding), "RpcStringBindingCompose\n");
     ok(RPC_S_OK == RpcBindingFromStringBindingA(binding, &IMixedServer_IfHandle), "RpcBindingFromStringBinding\n");
 
+    test_call_rate(); /* must make the first call on the binding */
     run_tests(); /* can cause RPC_X_BAD_STUB_DATA exception */
     authinfo_test(RPC_PROTSEQ_LRPC, 0);
     test_I_RpcBindingInqLocalClientPID(RPC_PROTSEQ_LRPC, IMixedServer_IfHandle);
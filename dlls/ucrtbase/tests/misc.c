@@ -830,6 +830,34 @@ static void test_math_errors(void)
     ok(d == -1.0, "failed to change log10 return value: %e\n", d);
 }
 
+static void test_exp_pow(void)
+{
+    double d, x;
+    float f;
+    int i;
+
+    for(i = -1000; i <= 1000; i++) {
+        /* arguments close to the argument reduction rounding boundaries */
+        x = i * M_LN2 / 256;
+        d = exp(x) * exp(-x);
+        ok(fabs(d - 1.0) <= 4 * DBL_EPSILON, "exp(%a) * exp(%a) = %a\n", x, -x, d);
+
+        x = i * M_LN2 / 64;
+        f = expf(x) * expf(-x);
+        ok(fabsf(f - 1.0f) <= 4 * FLT_EPSILON, "expf(%a) * expf(%a) = %a\n", x, -x, f);
+
+        d = pow(2.0, i + 0.5);
+        x = ldexp(M_SQRT2, i);
+        ok(fabs(d - x) <= x * DBL_EPSILON, "pow(2, %d.5) = %a, expected %a\n", i, d, x);
+    }
+
+    for(i = -120; i <= 120; i++) {
+        f = powf(2.0f, i + 0.5f);
+        x = ldexp(M_SQRT2, i);
+        ok(fabs(f - x) <= x * FLT_EPSILON, "powf(2, %d.5) = %a, expected %a\n", i, f, x);
+    }
+}
+
 static void test_asctime(void)
 {
     const struct tm epoch = { 0, 0, 0, 1, 0, 70, 4, 0, 0 };
@@ -1623,6 +1651,7 @@ START_TEST(misc)
     test_lldiv();
     test_isblank();
     test_math_errors();
+    test_exp_pow();
     test_asctime();
     test_strftime();
     test_exit(arg_v[0]);
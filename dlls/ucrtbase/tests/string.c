@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <wchar.h>
 #include <stdio.h>
+#include <string.h>
 #include <locale.h>
 #include <mbctype.h>
 #include <mbstring.h>
@@ -152,6 +153,47 @@ static void test_strtod(void)
     test_strtod_str_errno("2.47e-324", 0, 9, ERANGE);
 }
 
+static void test_strtod_roundtrip(void)
+{
+    ULONGLONG seed = 0x2545f4914f6cdd1dull, bits, bits2;
+    char buf[64], buf2[64];
+    const char *fmt;
+    double d, d2;
+    int i, prec;
+
+    for (i = 0; i < 20000; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        if (i % 2)
+        {
+            d = (double)(seed % 100000000) / 1000;
+            fmt = "%.*f";
+            prec = (seed >> 60) % 10;
+        }
+        else
+        {
+            memcpy(&d, &seed, sizeof(d));
+            if (isnan(d) || isinf(d)) continue;
+            fmt = "%.*e";
+            prec = (seed >> 60) % 15;
+        }
+
+        sprintf(buf, "%.17g", d);
+        d2 = strtod(buf, NULL);
+        memcpy(&bits, &d, sizeof(bits));
+        memcpy(&bits2, &d2, sizeof(bits2));
+        ok(bits == bits2, "%s: got %#I64x, expected %#I64x\n", buf, bits2, bits);
+
+        /* up to 15 significant digits survive the conversion to double */
+        sprintf(buf, fmt, prec, d);
+        sprintf(buf2, fmt, prec, strtod(buf, NULL));
+        ok(!strcmp(buf, buf2), "got %s, expected %s\n", buf2, buf);
+    }
+}
+
 static void test_strtof(void)
 {
     static const struct {
@@ -639,6 +681,7 @@ START_TEST(string)
             "Invalid parameter handler was already set\n");
 
     test_strtod();
+    test_strtod_roundtrip();
     test_strtof();
     test__memicmp();
     test__memicmp_l();
@@ -111,6 +111,8 @@ static void dump_code(compile_ctx_t *ctx)
         TRACE_(vbscript_disas)("%d:\t%s", (int)(instr-ctx->code->instrs), instr_info[instr->op].op_str);
         dump_instr_arg(instr_info[instr->op].arg1_type, &instr->arg1);
         dump_instr_arg(instr_info[instr->op].arg2_type, &instr->arg2);
+        if(instr->local_ref != NO_LOCAL_REF)
+            TRACE_(vbscript_disas)("\t[local %u]", instr->local_ref);
         TRACE_(vbscript_disas)("\n");
     }
 }
@@ -165,6 +167,7 @@ static unsigned push_instr(compile_ctx_t *ctx, vbsop_t op)
 
     ctx->code->instrs[ctx->instr_cnt].op = op;
     ctx->code->instrs[ctx->instr_cnt].loc = ctx->loc;
+    ctx->code->instrs[ctx->instr_cnt].local_ref = NO_LOCAL_REF;
     return ctx->instr_cnt++;
 }
 
@@ -1469,6 +1472,67 @@ static void resolve_labels(compile_ctx_t *ctx, unsigned off)
     ctx->labels_cnt = 0;
 }
 
+static const WCHAR *get_instr_identifier(const instr_t *instr)
+{
+    switch(instr->op) {
+    case OP_assign_ident:
+    case OP_dim:
+    case OP_icall:
+    case OP_icallv:
+    case OP_ident:
+    case OP_incc:
+    case OP_redim:
+    case OP_redim_preserve:
+    case OP_set_ident:
+        return instr->arg1.bstr;
+    case OP_enumnext:
+    case OP_step:
+        return instr->arg2.bstr;
+    default:
+        return NULL;
+    }
+}
+
+/*
+ * Locals and arguments always take precedence over class members, globals and named items
+ * in lookup_identifier, so references to them can be bound once the function is compiled
+ * and all its Dim statements are known. Everything else is still looked up by name.
+ */
+static void resolve_local_refs(compile_ctx_t *ctx, function_t *func)
+{
+    const WCHAR *name;
+    instr_t *instr;
+    unsigned i;
+
+    if(func->type == FUNC_GLOBAL)
+        return;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        if(!(name = get_instr_identifier(instr)))
+            continue;
+
+        /* Function name may refer to the return value, depending on the invoke type. */
+        if((func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET) && !wcsicmp(name, func->name))
+            continue;
+
+        for(i = 0; i < func->var_cnt; i++) {
+            if(!wcsicmp(func->vars[i].name, name)) {
+                instr->local_ref = i;
+                break;
+            }
+        }
+        if(instr->local_ref != NO_LOCAL_REF)
+            continue;
+
+        for(i = 0; i < func->arg_cnt; i++) {
+            if(!wcsicmp(func->args[i].name, name)) {
+                instr->local_ref = func->var_cnt + i;
+                break;
+            }
+        }
+    }
+}
+
 static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_desc_t *array_desc)
 {
     unsigned dim_cnt = 0, i;
@@ -1560,6 +1624,8 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         assert(i == func->var_cnt);
     }
 
+    resolve_local_refs(ctx, func);
+
     if(func->array_cnt) {
         unsigned array_id = 0;
         dim_decl_t *dim_decl;
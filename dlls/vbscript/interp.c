@@ -134,6 +134,14 @@ static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_
     DISPID id;
     HRESULT hres;
 
+    if(ctx->instr->local_ref != NO_LOCAL_REF) {
+        unsigned local_ref = ctx->instr->local_ref;
+
+        ref->type = REF_VAR;
+        ref->u.v = local_ref < ctx->func->var_cnt ? ctx->vars+local_ref : ctx->args+local_ref-ctx->func->var_cnt;
+        return S_OK;
+    }
+
     if(invoke_type != VBDISP_CALLGET
        && (ctx->func->type == FUNC_FUNCTION || ctx->func->type == FUNC_PROPGET)
        && !wcsicmp(name, ctx->func->name)) {
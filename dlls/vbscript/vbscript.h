@@ -312,9 +312,15 @@ typedef union {
     DATE *date;
 } instr_arg_t;
 
+/* Instructions referring to a local variable or argument of the function they
+ * belong to have it resolved at compile time. local_ref is then an index into
+ * the function variables, followed by its arguments. */
+#define NO_LOCAL_REF (~0u)
+
 typedef struct {
     vbsop_t op;
     unsigned loc;
+    unsigned local_ref;
     instr_arg_t arg1;
     instr_arg_t arg2;
 } instr_t;
@@ -60,6 +60,8 @@ static RTL_CRITICAL_SECTION vcomp_section = { &critsect_debug, -1, 0, 0, 0, 0 };
 #define VCOMP_DYNAMIC_FLAGS_GUIDED      0x03
 #define VCOMP_DYNAMIC_FLAGS_INCREMENT   0x40
 
+#define VCOMP_SPIN_COUNT                4000
+
 struct vcomp_thread_data
 {
     struct vcomp_team_data  *team;
@@ -89,7 +91,7 @@ struct vcomp_team_data
 {
     CONDITION_VARIABLE      cond;
     int                     num_threads;
-    int                     finished_threads;
+    LONG                    finished_threads;
 
     /* callback arguments */
     int                     nargs;
@@ -97,8 +99,8 @@ struct vcomp_team_data
     va_list                 valist;
 
     /* barrier */
-    unsigned int            barrier;
-    int                     barrier_count;
+    LONG                    barrier;
+    LONG                    barrier_count;
 };
 
 struct vcomp_task_data
@@ -111,8 +113,9 @@ struct vcomp_task_data
     int                     num_sections;
     int                     section_index;
 
-    /* dynamic */
-    unsigned int            dynamic;
+    /* dynamic, the generation is stored in the high and the number
+     * of remaining iterations in the low part of the dynamic field */
+    LONG64                  dynamic;
     unsigned int            dynamic_first;
     unsigned int            dynamic_last;
     unsigned int            dynamic_iterations;
@@ -1057,26 +1060,34 @@ void CDECL _vcomp_flush(void)
 void CDECL _vcomp_barrier(void)
 {
     struct vcomp_team_data *team_data = vcomp_init_thread_data()->team;
+    unsigned int spin;
+    LONG barrier;
 
     TRACE("()\n");
 
     if (!team_data)
         return;
 
-    EnterCriticalSection(&vcomp_section);
-    if (++team_data->barrier_count >= team_data->num_threads)
+    barrier = ReadAcquire(&team_data->barrier);
+    if (InterlockedIncrement(&team_data->barrier_count) >= team_data->num_threads)
     {
-        team_data->barrier++;
         team_data->barrier_count = 0;
-        WakeAllConditionVariable(&team_data->cond);
+        InterlockedIncrement(&team_data->barrier);
+        RtlWakeAddressAll(&team_data->barrier);
+        return;
     }
-    else
+
+    /* spin for a while before going to sleep, unless there are more threads than processors */
+    spin = team_data->num_threads <= vcomp_num_procs ? VCOMP_SPIN_COUNT : 0;
+    while (ReadAcquire(&team_data->barrier) == barrier)
     {
-        unsigned int barrier = team_data->barrier;
-        while (team_data->barrier == barrier)
-            SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
+        if (spin)
+        {
+            spin--;
+            YieldProcessor();
+        }
+        else RtlWaitOnAddress(&team_data->barrier, &barrier, sizeof(barrier), NULL);
     }
-    LeaveCriticalSection(&vcomp_section);
 }
 
 void CDECL _vcomp_set_num_threads(int num_threads)
@@ -1470,14 +1481,17 @@ void CDECL _vcomp_for_dynamic_init(unsigned int flags, unsigned int first, unsig
         EnterCriticalSection(&vcomp_section);
         thread_data->dynamic++;
         thread_data->dynamic_type = type;
-        if ((int)(thread_data->dynamic - task_data->dynamic) > 0)
+        if ((int)(thread_data->dynamic - (unsigned int)(task_data->dynamic >> 32)) > 0)
         {
-            task_data->dynamic              = thread_data->dynamic;
+            LONG64 prev, dynamic = ((LONG64)thread_data->dynamic << 32) | iterations;
+
             task_data->dynamic_first        = first;
             task_data->dynamic_last         = last;
             task_data->dynamic_iterations   = iterations;
             task_data->dynamic_step         = step;
             task_data->dynamic_chunksize    = chunksize;
+            do prev = task_data->dynamic;
+            while (InterlockedCompareExchange64(&task_data->dynamic, dynamic, prev) != prev);
         }
         LeaveCriticalSection(&vcomp_section);
     }
@@ -1502,26 +1516,47 @@ int CDECL _vcomp_for_dynamic_next(unsigned int *begin, unsigned int *end)
     else if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_CHUNKED ||
              thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED)
     {
-        unsigned int iterations = 0;
-        EnterCriticalSection(&vcomp_section);
-        if (thread_data->dynamic == task_data->dynamic &&
-            task_data->dynamic_iterations != 0)
+        unsigned int iterations, remaining, first, last, total, chunksize;
+        LONG64 dynamic, prev;
+        int step;
+
+        /* The loop parameters are only written by _vcomp_for_dynamic_init before a
+         * new generation is published, a successful compare-exchange guarantees
+         * they belong to the generation the chunk was taken from. The initial
+         * value is read with an interlocked operation, a plain 64-bit load may
+         * be torn on 32-bit targets and has no acquire semantics. */
+        dynamic = InterlockedCompareExchange64(&task_data->dynamic, 0, 0);
+        for (;;)
         {
-            iterations = min(task_data->dynamic_iterations, task_data->dynamic_chunksize);
+            remaining = (unsigned int)dynamic;
+            if ((unsigned int)(dynamic >> 32) != thread_data->dynamic || !remaining)
+                return 0;
+
+            first       = task_data->dynamic_first;
+            last        = task_data->dynamic_last;
+            total       = task_data->dynamic_iterations;
+            step        = task_data->dynamic_step;
+            chunksize   = task_data->dynamic_chunksize;
+
+            iterations = min(remaining, chunksize);
             if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED &&
-                task_data->dynamic_iterations > num_threads * task_data->dynamic_chunksize)
+                remaining > num_threads * chunksize)
             {
-                iterations = (task_data->dynamic_iterations + num_threads - 1) / num_threads;
+                iterations = (remaining + num_threads - 1) / num_threads;
             }
-            *begin = task_data->dynamic_first;
-            *end   = task_data->dynamic_first + (iterations - 1) * task_data->dynamic_step;
-            task_data->dynamic_iterations -= iterations;
-            task_data->dynamic_first      += iterations * task_data->dynamic_step;
-            if (!task_data->dynamic_iterations)
-                *end = task_data->dynamic_last;
+            if (!iterations)
+                return 0;
+
+            prev = InterlockedCompareExchange64(&task_data->dynamic, dynamic - iterations, dynamic);
+            if (prev == dynamic) break;
+            dynamic = prev;
         }
-        LeaveCriticalSection(&vcomp_section);
-        return iterations != 0;
+
+        *begin = first + (total - remaining) * step;
+        *end   = *begin + (iterations - 1) * step;
+        if (iterations == remaining)
+            *end = last;
+        return 1;
     }
 
     return 0;
@@ -1687,6 +1722,12 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
 
     if (team_data.num_threads > 1)
     {
+        unsigned int spin = team_data.num_threads <= vcomp_num_procs ? VCOMP_SPIN_COUNT : 0;
+
+        /* the other threads usually finish shortly after the master thread */
+        while (spin-- && ReadAcquire(&team_data.finished_threads) < team_data.num_threads - 1)
+            YieldProcessor();
+
         EnterCriticalSection(&vcomp_section);
 
         team_data.finished_threads++;
@@ -594,6 +594,39 @@ static void test_vcomp_fork(void)
     pomp_set_num_threads(max_threads);
 }
 
+static void CDECL barrier_cb(LONG *count, LONG *failures)
+{
+    int num_threads = pomp_get_num_threads();
+    int i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        InterlockedIncrement(count);
+        p_vcomp_barrier();
+        if (*count != (i + 1) * num_threads) InterlockedIncrement(failures);
+        p_vcomp_barrier();
+    }
+}
+
+static void test_vcomp_barrier(void)
+{
+    int max_threads = pomp_get_max_threads();
+    LONG count, failures;
+    int i;
+
+    for (i = 1; i <= 8; i++)
+    {
+        pomp_set_num_threads(i);
+
+        count = failures = 0;
+        p_vcomp_fork(TRUE, 2, barrier_cb, &count, &failures);
+        ok(count == 1000 * i, "expected count == %d, got %ld\n", 1000 * i, count);
+        ok(!failures, "got %ld failures with %d threads\n", failures, i);
+    }
+
+    pomp_set_num_threads(max_threads);
+}
+
 static void CDECL section_cb(LONG *a, LONG *b, LONG *c)
 {
     int i;
@@ -2633,6 +2666,7 @@ START_TEST(vcomp)
     test_omp_get_num_threads(FALSE);
     test_omp_get_num_threads(TRUE);
     test_vcomp_fork();
+    test_vcomp_barrier();
     test_vcomp_sections_init();
     test_vcomp_for_static_simple_init();
     test_vcomp_for_static_init();
@@ -1107,6 +1107,36 @@ static BOOL match_row( const struct table *table, UINT row, const struct expr *c
     return val != 0;
 }
 
+static BOOL is_cond_prop( const struct expr *cond, const WCHAR *name )
+{
+    if (!cond) return FALSE;
+
+    switch (cond->type)
+    {
+    case EXPR_COMPLEX:
+        return is_cond_prop( cond->u.expr.left, name ) || is_cond_prop( cond->u.expr.right, name );
+    case EXPR_UNARY:
+        return is_cond_prop( cond->u.expr.left, name );
+    case EXPR_PROPVAL:
+        return !wcsicmp( cond->u.propval->name, name );
+    default:
+        return FALSE;
+    }
+}
+
+/* fill functions may skip computing properties that are neither selected nor used by the condition */
+static BOOL is_prop_needed( const struct table *table, const struct expr *cond, const WCHAR *name )
+{
+    const struct property *prop;
+
+    if (!table->proplist) return TRUE;
+    for (prop = table->proplist; prop; prop = prop->next)
+    {
+        if (!wcsicmp( prop->name, name )) return TRUE;
+    }
+    return is_cond_prop( cond, name );
+}
+
 static BOOL resize_table( struct table *table, UINT row_count, UINT row_size )
 {
     if (!table->num_rows_allocated)
@@ -2062,6 +2092,7 @@ static enum fill_status fill_datafile( struct table *table, const struct expr *c
     HANDLE handle;
     struct dirstack *dirstack;
     enum fill_status status = FILL_STATUS_UNFILTERED;
+    BOOL need_version = is_prop_needed( table, cond, L"Version" );
 
     if (!resize_table( table, 8, sizeof(*rec) )) return FILL_STATUS_FAILED;
 
@@ -2116,7 +2147,7 @@ static enum fill_status fill_datafile( struct table *table, const struct expr *c
                     }
                     rec = (struct record_datafile *)(table->data + offset);
                     rec->name    = build_name( root[0], new_path );
-                    rec->version = get_file_version( rec->name );
+                    rec->version = need_version ? get_file_version( rec->name ) : NULL;
                     free( new_path );
                     if (!match_row( table, row, cond, &status ))
                     {
@@ -681,6 +681,45 @@ done:
     return hr;
 }
 
+static enum fill_status refresh_table( struct table *table )
+{
+    enum fill_status status;
+
+    /* fill the complete table so that the rows can serve any query until they expire */
+    clear_table( table );
+    status = table->fill( table, NULL );
+
+    if (status == FILL_STATUS_FAILED) table->flags &= ~TABLE_FLAG_CACHED;
+    else
+    {
+        table->flags |= TABLE_FLAG_CACHED;
+        table->fill_time = GetTickCount();
+    }
+    return status;
+}
+
+static enum fill_status fill_table( struct table *table, const struct view *view )
+{
+    enum fill_status status;
+    DWORD ttl;
+
+    if ((ttl = get_cache_ttl( table )))
+    {
+        if ((table->flags & TABLE_FLAG_CACHED) && GetTickCount() - table->fill_time < ttl)
+        {
+            TRACE("using cached rows for %s\n", debugstr_w(table->name));
+            return FILL_STATUS_UNFILTERED;
+        }
+        return refresh_table( table );
+    }
+
+    clear_table( table );
+    table->proplist = view->proplist;
+    status = table->fill( table, view->cond );
+    table->proplist = NULL;
+    return status;
+}
+
 static HRESULT exec_select_view( struct view *view )
 {
     UINT i, j = 0, len;
@@ -690,11 +729,7 @@ static HRESULT exec_select_view( struct view *view )
     if (!view->table_count) return S_OK;
 
     table = view->table[0];
-    if (table->fill)
-    {
-        clear_table( table );
-        status = table->fill( table, view->cond );
-    }
+    if (table->fill) status = fill_table( table, view );
     if (status == FILL_STATUS_FAILED) return WBEM_E_FAILED;
     if (!table->num_rows) return S_OK;
 
@@ -890,6 +890,8 @@ static HRESULT WINAPI wbem_services_ExecMethod(
     if (hr != S_OK) goto done;
 
     hr = func( obj, context ? context : services->context, pInParams, ppOutParams );
+    /* the method may have changed the instances of the class */
+    invalidate_table_cache( table );
 
 done:
     if (result) IEnumWbemClassObject_Release( result );
@@ -22,6 +22,7 @@
 
 #include "windef.h"
 #include "winbase.h"
+#include "winreg.h"
 #include "wbemcli.h"
 
 #include "wine/debug.h"
@@ -305,6 +306,8 @@ void clear_table( struct table *table )
 {
     UINT i;
 
+    /* the cached rows are about to go */
+    if (table->fill) table->flags &= ~TABLE_FLAG_CACHED;
     if (!table->data) return;
 
     for (i = 0; i < table->num_rows; i++) free_row_values( table, i );
@@ -317,6 +320,22 @@ void clear_table( struct table *table )
     }
 }
 
+/* Results of a complete fill can be reused for the number of milliseconds
+ * set for the class name under HKCU\Software\Wine\WBEM\Cache. */
+DWORD get_cache_ttl( const struct table *table )
+{
+    DWORD ttl, size = sizeof(ttl);
+
+    if (RegGetValueW( HKEY_CURRENT_USER, L"Software\\Wine\\WBEM\\Cache", table->name, RRF_RT_REG_DWORD,
+                      NULL, &ttl, &size )) return 0;
+    return ttl;
+}
+
+void invalidate_table_cache( struct table *table )
+{
+    table->flags &= ~TABLE_FLAG_CACHED;
+}
+
 void free_columns( struct column *columns, UINT num_cols )
 {
     UINT i;
@@ -329,6 +348,9 @@ void free_table( struct table *table )
 {
     if (!table) return;
 
+    /* the cached rows of a builtin table outlive its last user */
+    if (!(table->flags & TABLE_FLAG_DYNAMIC) && (table->flags & TABLE_FLAG_CACHED)) return;
+
     clear_table( table );
     if (table->flags & TABLE_FLAG_DYNAMIC)
     {
@@ -385,6 +407,8 @@ struct table *create_table( const WCHAR *name, UINT num_cols, const struct colum
     table->fill               = fill;
     table->flags              = TABLE_FLAG_DYNAMIC;
     table->refs               = 0;
+    table->fill_time          = 0;
+    table->proplist           = NULL;
     list_init( &table->entry );
     return table;
 }
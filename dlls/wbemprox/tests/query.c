@@ -257,12 +257,39 @@ static void _check_property( ULONG line, IWbemClassObject *obj, const WCHAR *pro
 }
 #define check_property(a,b,c,d) _check_property(__LINE__,a,b,c,d)
 
+static ULONG count_instances( IWbemServices *services, const WCHAR *str )
+{
+    BSTR wql = SysAllocString( L"wql" ), query = SysAllocString( str );
+    IEnumWbemClassObject *result;
+    IWbemClassObject *obj;
+    ULONG count, total = 0;
+    HRESULT hr;
+
+    hr = IWbemServices_ExecQuery( services, wql, query, 0, NULL, &result );
+    ok( hr == S_OK, "query %s failed %#lx\n", wine_dbgstr_w(str), hr );
+    if (hr == S_OK)
+    {
+        for (;;)
+        {
+            IEnumWbemClassObject_Next( result, 10000, 1, &obj, &count );
+            if (!count) break;
+            IWbemClassObject_Release( obj );
+            total++;
+        }
+        IEnumWbemClassObject_Release( result );
+    }
+    SysFreeString( wql );
+    SysFreeString( query );
+    return total;
+}
+
 static void test_Win32_Service( IWbemServices *services )
 {
     BSTR class = SysAllocString( L"Win32_Service.Name=\"Spooler\"" ), empty = SysAllocString( L"" ), method;
     IWbemClassObject *service, *out;
     VARIANT state, retval, classvar;
     CIMTYPE type;
+    ULONG count;
     HRESULT hr;
 
     hr = IWbemServices_GetObject( services, class, 0, NULL, &service, NULL );
@@ -365,6 +392,12 @@ static void test_Win32_Service( IWbemServices *services )
     ok( hr == WBEM_E_NOT_FOUND, "got %#lx\n", hr );
     ok( service == NULL, "expected NULL service, got %p\n", service );
     SysFreeString( class );
+
+    /* properties used in the condition don't have to be selected */
+    count = count_instances( services, L"SELECT * FROM Win32_Service WHERE StartMode = 'Manual'" );
+    ok( count, "expected manual services\n" );
+    ok( count_instances( services, L"SELECT Name FROM Win32_Service WHERE StartMode = 'Manual'" ) == count,
+        "got different results\n" );
 }
 
 static void test_Win32_Bios( IWbemServices *services )
@@ -1658,6 +1691,69 @@ static void test_Win32_IP4RouteTable( IWbemServices *services )
     SysFreeString( wql );
 }
 
+static void test_table_cache( IWbemServices *services )
+{
+    STARTUPINFOA si = { sizeof(si) };
+    PROCESS_INFORMATION pi;
+    IWbemClassObject *out;
+    WCHAR query[80], path[64];
+    char cmdline[MAX_PATH + 32], **argv;
+    BSTR class, method;
+    DWORD ttl = 600000;
+    ULONG count, total;
+    HRESULT hr;
+    HKEY key;
+    LONG res;
+
+    res = RegCreateKeyExA( HKEY_CURRENT_USER, "Software\\Wine\\WBEM\\Cache", 0, NULL, 0, KEY_SET_VALUE, NULL,
+                           &key, NULL );
+    ok( !res, "got %ld\n", res );
+    res = RegSetValueExA( key, "Win32_Process", 0, REG_DWORD, (BYTE *)&ttl, sizeof(ttl) );
+    ok( !res, "got %ld\n", res );
+
+    total = count_instances( services, L"SELECT * FROM Win32_Process" );
+    ok( total, "expected processes\n" );
+
+    winetest_get_mainargs( &argv );
+    sprintf( cmdline, "\"%s\" query created_process", argv[0] );
+    res = CreateProcessA( NULL, cmdline, NULL, NULL, FALSE, CREATE_SUSPENDED, NULL, NULL, &si, &pi );
+    ok( res, "failed to create process %lu\n", GetLastError() );
+
+    /* later queries are answered from the cached rows */
+    count = count_instances( services, L"SELECT * FROM Win32_Process" );
+    ok( count == total || broken(count > 0) /* no cache */, "got %lu, expected %lu\n", count, total );
+    swprintf( query, ARRAY_SIZE(query), L"SELECT * FROM Win32_Process WHERE ProcessId = %lu", GetCurrentProcessId() );
+    count = count_instances( services, query );
+    ok( count == 1, "got %lu\n", count );
+
+    /* the new process isn't seen until the cached rows expire */
+    swprintf( query, ARRAY_SIZE(query), L"SELECT * FROM Win32_Process WHERE ProcessId = %lu", pi.dwProcessId );
+    count = count_instances( services, query );
+    ok( !count || broken(count == 1) /* no cache */, "got %lu\n", count );
+
+    /* executing a method drops the cached rows */
+    swprintf( path, ARRAY_SIZE(path), L"Win32_Process.Handle=\"%lu\"", GetCurrentProcessId() );
+    class = SysAllocString( path );
+    method = SysAllocString( L"GetOwner" );
+    out = NULL;
+    hr = IWbemServices_ExecMethod( services, class, method, 0, NULL, NULL, &out, NULL );
+    ok( hr == S_OK, "failed to execute method %#lx\n", hr );
+    if (out) IWbemClassObject_Release( out );
+    SysFreeString( method );
+    SysFreeString( class );
+
+    count = count_instances( services, query );
+    ok( count == 1, "got %lu\n", count );
+
+    TerminateProcess( pi.hProcess, 0 );
+    WaitForSingleObject( pi.hProcess, 5000 );
+    CloseHandle( pi.hThread );
+    CloseHandle( pi.hProcess );
+
+    RegDeleteValueA( key, "Win32_Process" );
+    RegCloseKey( key );
+}
+
 static void test_Win32_Processor( IWbemServices *services )
 {
     BSTR wql = SysAllocString( L"wql" ), query = SysAllocString( L"SELECT * FROM Win32_Processor" );
@@ -2382,6 +2478,7 @@ START_TEST(query)
     test_Win32_Printer( services );
     test_Win32_Process( services, FALSE );
     test_Win32_Process( services, TRUE );
+    test_table_cache( services );
     test_Win32_Processor( services );
     test_Win32_QuickFixEngineering( services );
     test_Win32_Service( services );
@@ -107,6 +107,7 @@ enum fill_status
 };
 
 #define TABLE_FLAG_DYNAMIC 0x00000001
+#define TABLE_FLAG_CACHED  0x00000002 /* rows are a complete snapshot taken at fill_time */
 
 struct table
 {
@@ -120,6 +121,8 @@ struct table
     UINT flags;
     struct list entry;
     LONG refs;
+    DWORD fill_time;
+    const struct property *proplist; /* properties requested from fill, NULL for all */
 };
 
 struct property
@@ -224,6 +227,8 @@ void free_columns( struct column *, UINT ) DECLSPEC_HIDDEN;
 void free_row_values( const struct table *, UINT ) DECLSPEC_HIDDEN;
 void clear_table( struct table * ) DECLSPEC_HIDDEN;
 void free_table( struct table * ) DECLSPEC_HIDDEN;
+DWORD get_cache_ttl( const struct table * ) DECLSPEC_HIDDEN;
+void invalidate_table_cache( struct table * ) DECLSPEC_HIDDEN;
 UINT get_type_size( CIMTYPE ) DECLSPEC_HIDDEN;
 HRESULT eval_cond( const struct table *, UINT, const struct expr *, LONGLONG *, UINT * ) DECLSPEC_HIDDEN;
 HRESULT get_column_index( const struct table *, const WCHAR *, UINT * ) DECLSPEC_HIDDEN;
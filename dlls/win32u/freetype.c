@@ -34,6 +34,7 @@
 #include <fcntl.h>
 #include <dlfcn.h>
 #include <sys/mman.h>
+#include <limits.h>
 #include <string.h>
 #include <dirent.h>
 #include <stdio.h>
@@ -1292,6 +1293,371 @@ static void unix_face_destroy( struct unix_face *This )
     free( This );
 }
 
+/* font index */
+
+/* The properties parsed by unix_face_create() are kept in an index file in the
+ * prefix, which is mapped read-only by every process, so that the font files
+ * don't have to be opened and parsed again on each process start. Records are
+ * invalidated when the size or modification time of the font file changes, and
+ * the whole index is rewritten when the set of fonts loaded at startup changes. */
+
+#define FONT_INDEX_MAGIC    0x58444e49  /* INDX */
+#define FONT_INDEX_VERSION  1
+
+#define FONT_INDEX_RECORD_SCALABLE      0x1
+#define FONT_INDEX_RECORD_ALLOW_BITMAP  0x2
+#define FONT_INDEX_RECORD_INVALID       0x4
+
+struct font_index_header
+{
+    UINT32 magic;
+    UINT32 version;
+    UINT32 size;
+    UINT32 lcid;
+    UINT32 count;
+    UINT32 bucket_count;
+    UINT32 buckets[1];
+};
+
+struct font_index_record
+{
+    UINT32                  next;
+    UINT32                  size;
+    UINT64                  mtime;
+    UINT64                  file_size;
+    UINT32                  hash;
+    UINT32                  face_index;
+    UINT32                  flags;
+    UINT32                  num_faces;
+    UINT32                  ntm_flags;
+    UINT32                  font_version;
+    FONTSIGNATURE           fs;
+    struct bitmap_font_size bitmap_size;
+    UINT32                  name_len;
+    UINT32                  string_len[4];
+    char                    data[1];
+    /* WCHAR                strings[]; */
+};
+
+static struct
+{
+    char                      *path;
+    const struct font_index_header *header;
+    struct font_index_record **records;
+    SIZE_T                     records_size;
+    UINT                       count;
+    UINT                       hits;
+    BOOL                       collect;
+} font_index;
+
+static char *get_unix_file_name( LPCWSTR path );
+
+static UINT32 font_index_hash( const char *unix_name, UINT face_index, UINT flags )
+{
+    UINT32 hash = 0x811c9dc5;
+
+    while (*unix_name) hash = (hash ^ (unsigned char)*unix_name++) * 0x01000193;
+    hash = (hash ^ face_index) * 0x01000193;
+    return (hash ^ flags) * 0x01000193;
+}
+
+static void font_index_load(void)
+{
+    static const char index_nameA[] = "\\??\\C:\\windows\\system32\\wine_fntcache.dat";
+    const struct font_index_header *header;
+    WCHAR index_name[ARRAY_SIZE(index_nameA)];
+    struct stat st;
+    int fd;
+
+    asciiz_to_unicode( index_name, index_nameA );
+    if (!(font_index.path = get_unix_file_name( index_name ))) return;
+    font_index.collect = TRUE;
+
+    if ((fd = open( font_index.path, O_RDONLY )) == -1) return;
+    if (fstat( fd, &st ) == -1 || st.st_size < sizeof(*header) || st.st_size > UINT_MAX)
+    {
+        close( fd );
+        return;
+    }
+    header = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (header == MAP_FAILED) return;
+
+    if (header->magic != FONT_INDEX_MAGIC || header->version != FONT_INDEX_VERSION ||
+        header->size != st.st_size || header->lcid != system_lcid ||
+        !header->bucket_count || (header->bucket_count & (header->bucket_count - 1)) ||
+        header->bucket_count > (header->size - offsetof( struct font_index_header, buckets )) / sizeof(UINT32))
+    {
+        TRACE( "ignoring stale font index %s\n", debugstr_a(font_index.path) );
+        munmap( (void *)header, st.st_size );
+        return;
+    }
+
+    TRACE( "using font index %s with %u records\n", debugstr_a(font_index.path), header->count );
+    font_index.header = header;
+}
+
+static const struct font_index_record *font_index_find( const char *unix_name, UINT face_index,
+                                                        UINT flags, UINT32 hash )
+{
+    const struct font_index_header *header = font_index.header;
+    const struct font_index_record *record;
+    UINT32 offset;
+
+    if (!header) return NULL;
+
+    offset = header->buckets[hash & (header->bucket_count - 1)];
+    while (offset)
+    {
+        if (offset > header->size - sizeof(*record) || offset % sizeof(UINT64)) break;
+        record = (const struct font_index_record *)((const char *)header + offset);
+        if (record->size > header->size - offset ||
+            record->size < offsetof( struct font_index_record, data ) ||
+            record->name_len > record->size - offsetof( struct font_index_record, data ) ||
+            !memchr( record->data, 0, record->name_len ))
+            break;
+
+        if (record->hash == hash && record->face_index == face_index &&
+            (record->flags & FONT_INDEX_RECORD_ALLOW_BITMAP) == flags &&
+            !strcmp( record->data, unix_name ))
+            return record;
+        offset = record->next;
+    }
+
+    return NULL;
+}
+
+static void font_index_keep_record( struct font_index_record *record )
+{
+    struct font_index_record **records;
+    SIZE_T new_size;
+
+    if (font_index.count == font_index.records_size)
+    {
+        new_size = max( 64, font_index.records_size * 2 );
+        if (!(records = realloc( font_index.records, new_size * sizeof(*records) )))
+        {
+            free( record );
+            return;
+        }
+        font_index.records = records;
+        font_index.records_size = new_size;
+    }
+    font_index.records[font_index.count++] = record;
+}
+
+static void font_index_add_face( const char *unix_name, UINT face_index, UINT flags, UINT32 hash,
+                                 const struct stat *st, const struct unix_face *face )
+{
+    struct font_index_record *record;
+    const WCHAR *strings[4] = { NULL };
+    UINT32 name_len, string_len[4] = { 0 };
+    SIZE_T size;
+    WCHAR *ptr;
+    int i;
+
+    /* these are loaded from the font file every time */
+    if (face && !face->family_name) return;
+
+    if (face)
+    {
+        strings[0] = face->family_name;
+        strings[1] = face->second_name;
+        strings[2] = face->style_name;
+        strings[3] = face->full_name;
+    }
+
+    name_len = (strlen( unix_name ) + 2) & ~1;
+    size = offsetof( struct font_index_record, data[name_len] );
+    for (i = 0; i < ARRAY_SIZE(strings); i++)
+    {
+        if (strings[i]) string_len[i] = lstrlenW( strings[i] ) + 1;
+        size += string_len[i] * sizeof(WCHAR);
+    }
+    size = (size + sizeof(UINT64) - 1) & ~(sizeof(UINT64) - 1);
+
+    if (!(record = calloc( 1, size ))) return;
+    record->size = size;
+    record->mtime = st->st_mtime;
+    record->file_size = st->st_size;
+    record->hash = hash;
+    record->face_index = face_index;
+    record->flags = flags;
+    if (face)
+    {
+        if (face->scalable) record->flags |= FONT_INDEX_RECORD_SCALABLE;
+        record->num_faces = face->num_faces;
+        record->ntm_flags = face->ntm_flags;
+        record->font_version = face->font_version;
+        record->fs = face->fs;
+        record->bitmap_size = face->size;
+    }
+    else record->flags |= FONT_INDEX_RECORD_INVALID;
+    record->name_len = name_len;
+    strcpy( record->data, unix_name );
+
+    ptr = (WCHAR *)(record->data + name_len);
+    for (i = 0; i < ARRAY_SIZE(strings); i++)
+    {
+        record->string_len[i] = string_len[i];
+        if (!string_len[i]) continue;
+        memcpy( ptr, strings[i], string_len[i] * sizeof(WCHAR) );
+        ptr += string_len[i];
+    }
+
+    font_index_keep_record( record );
+}
+
+static struct unix_face *unix_face_from_index( const struct font_index_record *record )
+{
+    WCHAR **strings[4], *str;
+    struct unix_face *This;
+    UINT32 remaining;
+    int i;
+
+    /* font_index_find() checked that the name fits in the record */
+    remaining = record->size - offsetof( struct font_index_record, data[record->name_len] );
+    for (i = 0; i < ARRAY_SIZE(record->string_len); i++)
+    {
+        if (record->string_len[i] > remaining / sizeof(WCHAR)) return NULL;
+        remaining -= record->string_len[i] * sizeof(WCHAR);
+    }
+    /* faces without a family name are loaded again, like new fonts */
+    if (!record->string_len[0]) return NULL;
+
+    if (!(This = calloc( 1, sizeof(*This) ))) return NULL;
+    This->scalable = !!(record->flags & FONT_INDEX_RECORD_SCALABLE);
+    This->num_faces = record->num_faces;
+    This->ntm_flags = record->ntm_flags;
+    This->font_version = record->font_version;
+    This->fs = record->fs;
+    This->size = record->bitmap_size;
+
+    strings[0] = &This->family_name;
+    strings[1] = &This->second_name;
+    strings[2] = &This->style_name;
+    strings[3] = &This->full_name;
+
+    str = (WCHAR *)(record->data + record->name_len);
+    for (i = 0; i < ARRAY_SIZE(strings); i++)
+    {
+        if (!record->string_len[i]) continue;
+        if (!(*strings[i] = malloc( record->string_len[i] * sizeof(WCHAR) )))
+        {
+            unix_face_destroy( This );
+            return NULL;
+        }
+        memcpy( *strings[i], str, record->string_len[i] * sizeof(WCHAR) );
+        (*strings[i])[record->string_len[i] - 1] = 0;
+        str += record->string_len[i];
+    }
+
+    return This;
+}
+
+static struct unix_face *unix_face_create_indexed( const char *unix_name, void *data_ptr, UINT data_size,
+                                                   UINT face_index, UINT flags )
+{
+    const struct font_index_record *record;
+    struct font_index_record *copy;
+    struct unix_face *This;
+    UINT index_flags;
+    struct stat st;
+    UINT32 hash;
+
+    if (!unix_name) return unix_face_create( unix_name, data_ptr, data_size, face_index, flags );
+    if (stat( unix_name, &st ) == -1) return NULL;
+
+    index_flags = (flags & ADDFONT_ALLOW_BITMAP) ? FONT_INDEX_RECORD_ALLOW_BITMAP : 0;
+    hash = font_index_hash( unix_name, face_index, index_flags );
+
+    if ((record = font_index_find( unix_name, face_index, index_flags, hash )) &&
+        record->mtime == st.st_mtime && record->file_size == st.st_size)
+    {
+        if (record->flags & FONT_INDEX_RECORD_INVALID) This = NULL;
+        else if (!(This = unix_face_from_index( record ))) goto create;
+
+        if (font_index.collect && (copy = malloc( record->size )))
+        {
+            memcpy( copy, record, record->size );
+            copy->next = 0;
+            font_index_keep_record( copy );
+            font_index.hits++;
+        }
+        return This;
+    }
+
+create:
+    This = unix_face_create( unix_name, data_ptr, data_size, face_index, flags );
+    if (font_index.collect) font_index_add_face( unix_name, face_index, index_flags, hash, &st, This );
+    return This;
+}
+
+static void font_index_save(void)
+{
+    struct font_index_header *header;
+    SIZE_T size, offset;
+    UINT bucket_count, i;
+    char *tmp_name;
+    int fd;
+
+    if (!font_index.collect) return;
+    font_index.collect = FALSE;
+
+    if (font_index.header && font_index.hits == font_index.count && font_index.count == font_index.header->count)
+        goto done;
+
+    for (bucket_count = 16; bucket_count < font_index.count; bucket_count *= 2);
+
+    size = offsetof( struct font_index_header, buckets[bucket_count] );
+    size = (size + sizeof(UINT64) - 1) & ~(sizeof(UINT64) - 1);
+    for (i = 0; i < font_index.count; i++) size += font_index.records[i]->size;
+    if (size > UINT_MAX) goto done;
+
+    if (!(header = calloc( 1, size ))) goto done;
+    header->magic = FONT_INDEX_MAGIC;
+    header->version = FONT_INDEX_VERSION;
+    header->size = size;
+    header->lcid = system_lcid;
+    header->count = font_index.count;
+    header->bucket_count = bucket_count;
+
+    offset = offsetof( struct font_index_header, buckets[bucket_count] );
+    offset = (offset + sizeof(UINT64) - 1) & ~(sizeof(UINT64) - 1);
+    for (i = 0; i < font_index.count; i++)
+    {
+        struct font_index_record *record = (struct font_index_record *)((char *)header + offset);
+        UINT32 *bucket;
+
+        memcpy( record, font_index.records[i], font_index.records[i]->size );
+        bucket = &header->buckets[record->hash & (bucket_count - 1)];
+        record->next = *bucket;
+        *bucket = offset;
+        offset += record->size;
+    }
+
+    /* write to a temporary file first, processes that already mapped the old index keep using it */
+    if ((tmp_name = malloc( strlen( font_index.path ) + 16 )))
+    {
+        sprintf( tmp_name, "%s.%x", font_index.path, getpid() );
+        if ((fd = open( tmp_name, O_WRONLY | O_CREAT | O_TRUNC, 0644 )) != -1)
+        {
+            BOOL ret = write( fd, header, size ) == size;
+            close( fd );
+            if (!ret || rename( tmp_name, font_index.path ) == -1) unlink( tmp_name );
+            else TRACE( "wrote font index %s with %u records\n", debugstr_a(font_index.path), font_index.count );
+        }
+        free( tmp_name );
+    }
+    free( header );
+
+done:
+    for (i = 0; i < font_index.count; i++) free( font_index.records[i] );
+    free( font_index.records );
+    font_index.records = NULL;
+    font_index.records_size = font_index.count = 0;
+}
+
 static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_ptr, SIZE_T data_size,
                           DWORD face_index, DWORD flags, DWORD *num_faces )
 {
@@ -1300,7 +1666,7 @@ static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_p
 
     if (num_faces) *num_faces = 0;
 
-    if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
+    if (!(unix_face = unix_face_create_indexed( unix_name, data_ptr, data_size, face_index, flags )))
         return 0;
 
     if (unix_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
@@ -1890,6 +2256,7 @@ static void freetype_load_fonts(void)
 #elif defined(__ANDROID__)
     ReadFontDir("/system/fonts", TRUE);
 #endif
+    font_index_save();
 }
 
 /* Some fonts have large usWinDescent values, as a result of storing signed short
@@ -4253,6 +4620,7 @@ const struct font_backend_funcs *init_freetype_lib(void)
     init_fontconfig();
 #endif
     NtQueryDefaultLocale( FALSE, &system_lcid );
+    font_index_load();
     return &font_funcs;
 }
 
@@ -19,6 +19,7 @@
 
 #include <stdarg.h>
 #include <math.h>
+#include <string.h>
 
 #define COBJMACROS
 
@@ -60,6 +61,7 @@ enum pixelformat {
     format_48bppRGB,
     format_64bppRGBA,
     format_32bppCMYK,
+    format_128bppRGBAFloat,
 };
 
 typedef HRESULT (*copyfunc)(struct FormatConverter *This, const WICRect *prc,
@@ -90,53 +92,303 @@ static inline float to_sRGB_component(float f)
     return 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
 }
 
-#if 0 /* FIXME: enable once needed */
 static inline float from_sRGB_component(float f)
 {
     if (f <= 0.04045f) return f / 12.92f;
     return powf((f + 0.055f) / 1.055f, 2.4f);
 }
 
-static void from_sRGB(BYTE *bgr)
+static INIT_ONCE init_tables_once = INIT_ONCE_STATIC_INIT;
+
+/* linear value of each sRGB encoded byte */
+static float srgb_to_linear_table[256];
+/* smallest linear value that is encoded as the given sRGB byte */
+static float linear_to_srgb_threshold[256];
+/* fixed point 255/alpha factors, see unpremultiply_component() */
+static UINT64 unpremultiply_table[256];
+
+static inline INT linear_to_srgb_reference(float f)
 {
-    float r, g, b;
+    return (INT)floorf(to_sRGB_component(f) * 255.0f + 0.51f);
+}
 
-    r = bgr[2] / 255.0f;
-    g = bgr[1] / 255.0f;
-    b = bgr[0] / 255.0f;
+static BOOL WINAPI init_tables(INIT_ONCE *once, void *param, void **context)
+{
+    UINT i, lo, hi, mid;
+    float f;
 
-    r = from_sRGB_component(r);
-    g = from_sRGB_component(g);
-    b = from_sRGB_component(b);
+    for (i = 0; i < 256; i++)
+        srgb_to_linear_table[i] = from_sRGB_component(i / 255.0f);
 
-    bgr[2] = (BYTE)(r * 255.0f);
-    bgr[1] = (BYTE)(g * 255.0f);
-    bgr[0] = (BYTE)(b * 255.0f);
+    /* the encoding is monotonic, and the bit patterns of non-negative
+     * floats sort like the values, so bisect on those */
+    linear_to_srgb_threshold[0] = 0.0f;
+    for (i = 1; i < 256; i++)
+    {
+        f = 1.0f;
+        memcpy(&hi, &f, sizeof(hi));
+        lo = 0;
+        while (lo < hi)
+        {
+            mid = lo + (hi - lo) / 2;
+            memcpy(&f, &mid, sizeof(f));
+            if (linear_to_srgb_reference(f) >= i) hi = mid;
+            else lo = mid + 1;
+        }
+        memcpy(&linear_to_srgb_threshold[i], &lo, sizeof(float));
+    }
+
+    unpremultiply_table[0] = 0;
+    for (i = 1; i < 256; i++)
+        unpremultiply_table[i] = ((UINT64)255 << 24) / i + 1;
+
+    return TRUE;
 }
 
-static void to_sRGB(BYTE *bgr)
+/* Same result as floorf(to_sRGB_component(f) * 255.0f + 0.51f), with
+ * out of range values clamped, but without calling powf() per channel. */
+static inline BYTE linear_to_srgb_byte(float f)
 {
-    float r, g, b;
+    UINT lo = 0, hi = 255, mid;
 
-    r = bgr[2] / 255.0f;
-    g = bgr[1] / 255.0f;
-    b = bgr[0] / 255.0f;
+    if (!(f > 0.0f)) return 0;
+    if (f >= 1.0f) return 255;
 
-    r = to_sRGB_component(r);
-    g = to_sRGB_component(g);
-    b = to_sRGB_component(b);
+    while (lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if (linear_to_srgb_threshold[mid] <= f) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
 
-    bgr[2] = (BYTE)(r * 255.0f);
-    bgr[1] = (BYTE)(g * 255.0f);
-    bgr[0] = (BYTE)(b * 255.0f);
+/* Exact value of c * 255 / alpha for c * 255 < 2^16, see Granlund and
+ * Montgomery, "Division by Invariant Integers using Multiplication". */
+static inline BYTE unpremultiply_component(BYTE c, BYTE alpha)
+{
+    return (c * unpremultiply_table[alpha]) >> 24;
 }
-#endif
 
 static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter *iface)
 {
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
+/* upper bound for the scratch buffer used to fetch source rows */
+#define CONVERT_BAND_SIZE 0x10000
+
+typedef void (*convert_row_func)(const BYTE *src, BYTE *dst, UINT width);
+
+/* Fetches the source pixels in bands of rows and converts them row by row,
+ * so that no intermediate copy of the whole rectangle has to be allocated. */
+static HRESULT convert_rows(struct FormatConverter *This, const WICRect *prc, UINT srcbpp,
+    UINT cbStride, BYTE *pbBuffer, convert_row_func convert_row)
+{
+    UINT srcstride = (prc->Width * srcbpp + 7) / 8;
+    INT y, i, band_height;
+    WICRect rc;
+    BYTE *srcdata;
+    HRESULT hr = S_OK;
+
+    band_height = srcstride ? max(1, CONVERT_BAND_SIZE / srcstride) : 1;
+    band_height = min(band_height, prc->Height);
+
+    srcdata = HeapAlloc(GetProcessHeap(), 0, srcstride * band_height);
+    if (!srcdata) return E_OUTOFMEMORY;
+
+    rc.X = prc->X;
+    rc.Width = prc->Width;
+    for (y = 0; y < prc->Height; y += rc.Height)
+    {
+        rc.Y = prc->Y + y;
+        rc.Height = min(band_height, prc->Height - y);
+
+        hr = IWICBitmapSource_CopyPixels(This->source, &rc, srcstride, srcstride * rc.Height, srcdata);
+        if (FAILED(hr)) break;
+
+        for (i = 0; i < rc.Height; i++)
+            convert_row(srcdata + srcstride * i, pbBuffer + cbStride * (y + i), prc->Width);
+    }
+
+    HeapFree(GetProcessHeap(), 0, srcdata);
+    return hr;
+}
+
+static void set_opaque_32bpp(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        DWORD *pixel = (DWORD *)(buffer + stride * y);
+        for (x = 0; x < width; x++)
+            pixel[x] |= 0xff000000;
+    }
+}
+
+static void premultiply_32bpp(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *pixel = buffer + stride * y;
+        for (x = 0; x < width; x++, pixel += 4)
+        {
+            BYTE alpha = pixel[3];
+            if (alpha != 255)
+            {
+                pixel[0] = (pixel[0] * alpha + 127) / 255;
+                pixel[1] = (pixel[1] * alpha + 127) / 255;
+                pixel[2] = (pixel[2] * alpha + 127) / 255;
+            }
+        }
+    }
+}
+
+static void unpremultiply_32bpp(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *pixel = buffer + stride * y;
+        for (x = 0; x < width; x++, pixel += 4)
+        {
+            BYTE alpha = pixel[3];
+            if (alpha != 0 && alpha != 255)
+            {
+                pixel[0] = unpremultiply_component(pixel[0], alpha);
+                pixel[1] = unpremultiply_component(pixel[1], alpha);
+                pixel[2] = unpremultiply_component(pixel[2], alpha);
+            }
+        }
+    }
+}
+
+/* Expands 24bpp rows that were copied to the start of each 32bpp destination
+ * row; working backwards keeps the not yet converted pixels intact. */
+static void expand_24bpp_to_32bppBGRA(BYTE *buffer, UINT width, UINT height, UINT stride, BOOL swap_rb)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *row = buffer + stride * y;
+        DWORD *dst = (DWORD *)row;
+
+        if (swap_rb)
+        {
+            for (x = width; x--;)
+            {
+                const BYTE *src = row + 3 * x;
+                dst[x] = 0xff000000 | src[0] << 16 | src[1] << 8 | src[2];
+            }
+        }
+        else
+        {
+            for (x = width; x--;)
+            {
+                const BYTE *src = row + 3 * x;
+                dst[x] = 0xff000000 | src[2] << 16 | src[1] << 8 | src[0];
+            }
+        }
+    }
+}
+
+static void convert_row_48bppRGB_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x;
+
+    /* keep the most significant byte of each big endian component */
+    for (x = 0; x < width; x++, src += 6)
+        dstpixel[x] = 0xff000000 | src[1] << 16 | src[3] << 8 | src[5];
+}
+
+static void convert_row_64bppRGBA_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 8)
+        dstpixel[x] = src[7] << 24 | src[1] << 16 | src[3] << 8 | src[5];
+}
+
+static void convert_row_128bppRGBAFloat_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    const float *srcpixel = (const float *)src;
+    UINT x;
+
+    for (x = 0; x < width; x++, srcpixel += 4, dst += 4)
+    {
+        float alpha = srcpixel[3];
+
+        dst[0] = linear_to_srgb_byte(srcpixel[2]);
+        dst[1] = linear_to_srgb_byte(srcpixel[1]);
+        dst[2] = linear_to_srgb_byte(srcpixel[0]);
+        if (!(alpha > 0.0f)) dst[3] = 0;
+        else if (alpha >= 1.0f) dst[3] = 255;
+        else dst[3] = (BYTE)(alpha * 255.0f + 0.5f);
+    }
+}
+
+static void convert_row_32bppBGRA_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+static void convert_row_32bppBGRA_to_24bppRGB(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+    }
+}
+
+static void convert_row_32bppGrayFloat_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    const float *gray_float = (const float *)src;
+    UINT x;
+
+    for (x = 0; x < width; x++, dst += 3)
+        dst[0] = dst[1] = dst[2] = linear_to_srgb_byte(gray_float[x]);
+}
+
+static void convert_row_32bppGrayFloat_to_8bppGray(const BYTE *src, BYTE *dst, UINT width)
+{
+    const float *gray_float = (const float *)src;
+    UINT x;
+
+    for (x = 0; x < width; x++)
+        dst[x] = linear_to_srgb_byte(gray_float[x]);
+}
+
+static void convert_row_32bppCMYK_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        BYTE c = src[0], m = src[1], y = src[2], k = src[3];
+        dst[0] = (255 - y) * (255 - k) / 255; /* B */
+        dst[1] = (255 - m) * (255 - k) / 255; /* G */
+        dst[2] = (255 - c) * (255 - k) / 255; /* R */
+    }
+}
+
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -616,109 +868,30 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         }
         return S_OK;
     case format_24bppBGR:
-        if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
-        return S_OK;
     case format_24bppRGB:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+            if (cbStride < 4 * prc->Width) return E_INVALIDARG;
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            if (FAILED(res)) return res;
 
-            return res;
+            expand_24bpp_to_32bppBGRA(pbBuffer, prc->Width, prc->Height, cbStride,
+                source_format == format_24bppRGB);
         }
         return S_OK;
     case format_32bppBGR:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
             /* set all alpha values to 255 */
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+            set_opaque_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
     case format_32bppRGBA:
@@ -738,112 +911,24 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            unpremultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
     case format_48bppRGB:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 6 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue;
-                        srcpixel++; red = *srcpixel++;
-                        srcpixel++; green = *srcpixel++;
-                        srcpixel++; blue = *srcpixel++;
-                        *dstpixel++=0xff000000|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return convert_rows(This, prc, 48, cbStride, pbBuffer, convert_row_48bppRGB_to_32bppBGRA);
         return S_OK;
     case format_64bppRGBA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 8 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue, alpha;
-                        srcpixel++; red = *srcpixel++;
-                        srcpixel++; green = *srcpixel++;
-                        srcpixel++; blue = *srcpixel++;
-                        srcpixel++; alpha = *srcpixel++;
-                        *dstpixel++=alpha<<24|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return convert_rows(This, prc, 64, cbStride, pbBuffer, convert_row_64bppRGBA_to_32bppBGRA);
+        return S_OK;
+    case format_128bppRGBAFloat:
+        if (prc)
+            return convert_rows(This, prc, 128, cbStride, pbBuffer, convert_row_128bppRGBAFloat_to_32bppBGRA);
         return S_OK;
     case format_32bppCMYK:
         if (prc)
@@ -882,15 +967,11 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
     case format_32bppRGB:
         if (prc)
         {
-            INT x, y;
-
             hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
             /* set all alpha values to 255 */
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+            set_opaque_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
 
@@ -902,22 +983,10 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
     case format_32bppPRGBA:
         if (prc)
         {
-            INT x, y;
-
             hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            unpremultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
 
@@ -975,21 +1044,7 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = (pbBuffer[cbStride*y+4*x] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+1] = (pbBuffer[cbStride*y+4*x+1] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+2] = (pbBuffer[cbStride*y+4*x+2] * alpha + 127) / 255;
-                    }
-                }
-        }
+            premultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -1008,21 +1063,7 @@ static HRESULT copypixels_to_32bppPRGBA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppRGBA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = (pbBuffer[cbStride*y+4*x] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+1] = (pbBuffer[cbStride*y+4*x+1] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+2] = (pbBuffer[cbStride*y+4*x+2] * alpha + 127) / 255;
-                    }
-                }
-        }
+            premultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -1047,153 +1088,22 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
     case format_32bppBGR:
     case format_32bppBGRA:
     case format_32bppPBGRA:
+        if (prc)
+            return convert_rows(This, prc, 32, cbStride, pbBuffer, convert_row_32bppBGRA_to_24bppBGR);
+        return S_OK;
     case format_32bppRGBA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-
-                if (source_format == format_32bppRGBA)
-                {
-                    for (y = 0; y < prc->Height; y++)
-                    {
-                        srcpixel = srcrow;
-                        dstpixel = dstrow;
-                        for (x = 0; x < prc->Width; x++) {
-                            *dstpixel++ = srcpixel[2]; /* blue */
-                            *dstpixel++ = srcpixel[1]; /* green */
-                            *dstpixel++ = srcpixel[0]; /* red */
-                            srcpixel += 4;
-                        }
-                        srcrow += srcstride;
-                        dstrow += cbStride;
-                    }
-                }
-                else
-                {
-                    for (y = 0; y < prc->Height; y++)
-                    {
-                        srcpixel = srcrow;
-                        dstpixel = dstrow;
-                        for (x = 0; x < prc->Width; x++) {
-                            *dstpixel++ = *srcpixel++; /* blue */
-                            *dstpixel++ = *srcpixel++; /* green */
-                            *dstpixel++ = *srcpixel++; /* red */
-                            srcpixel++; /* alpha */
-                        }
-                        srcrow += srcstride;
-                        dstrow += cbStride;
-                    }
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return convert_rows(This, prc, 32, cbStride, pbBuffer, convert_row_32bppBGRA_to_24bppRGB);
         return S_OK;
 
     case format_32bppGrayFloat:
         if (prc)
-        {
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(hr))
-            {
-                INT x, y;
-                BYTE *src = srcdata, *dst = pbBuffer;
-
-                for (y = 0; y < prc->Height; y++)
-                {
-                    float *gray_float = (float *)src;
-                    BYTE *bgr = dst;
-
-                    for (x = 0; x < prc->Width; x++)
-                    {
-                        BYTE gray = (BYTE)floorf(to_sRGB_component(gray_float[x]) * 255.0f + 0.51f);
-                        *bgr++ = gray;
-                        *bgr++ = gray;
-                        *bgr++ = gray;
-                    }
-                    src += srcstride;
-                    dst += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return hr;
-        }
+            return convert_rows(This, prc, 32, cbStride, pbBuffer, convert_row_32bppGrayFloat_to_24bppBGR);
         return S_OK;
 
     case format_32bppCMYK:
         if (prc)
-        {
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = heap_alloc(srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-            if (SUCCEEDED(hr))
-            {
-                INT x, y;
-                BYTE *src = srcdata, *dst = pbBuffer;
-
-                for (y = 0; y < prc->Height; y++)
-                {
-                    BYTE *cmyk = src;
-                    BYTE *bgr = dst;
-
-                    for (x = 0; x < prc->Width; x++)
-                    {
-                        BYTE c = cmyk[0], m = cmyk[1], y = cmyk[2], k = cmyk[3];
-                        bgr[0] = (255 - y) * (255 - k) / 255; /* B */
-                        bgr[1] = (255 - m) * (255 - k) / 255; /* G */
-                        bgr[2] = (255 - c) * (255 - k) / 255; /* R */
-                        cmyk += 4;
-                        bgr += 3;
-                    }
-                    src += srcstride;
-                    dst += cbStride;
-                }
-            }
-
-            heap_free(srcdata);
-            return hr;
-        }
+            return convert_rows(This, prc, 32, cbStride, pbBuffer, convert_row_32bppCMYK_to_24bppBGR);
         return S_OK;
 
     default:
@@ -1223,51 +1133,7 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* blue */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* red */
-                        srcpixel++; /* alpha */
-
-                        *dstpixel++=tmppixel[2]; /* red */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* blue */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return convert_rows(This, prc, 32, cbStride, pbBuffer, convert_row_32bppBGRA_to_24bppRGB);
         return S_OK;
     default:
         FIXME("Unimplemented conversion path!\n");
@@ -1321,9 +1187,11 @@ static HRESULT copypixels_to_32bppGrayFloat(struct FormatConverter *This, const
 static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
-    HRESULT hr;
+    HRESULT hr = S_OK;
     BYTE *srcdata;
-    UINT srcstride, srcdatasize;
+    UINT srcstride;
+    INT y, i, band_height;
+    WICRect rc;
 
     if (source_format == format_8bppGray)
     {
@@ -1335,70 +1203,44 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
 
     if (source_format == format_32bppGrayFloat)
     {
-        hr = S_OK;
-
         if (prc)
-        {
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
+            return convert_rows(This, prc, 32, cbStride, pbBuffer, convert_row_32bppGrayFloat_to_8bppGray);
 
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-            if (SUCCEEDED(hr))
-            {
-                INT x, y;
-                BYTE *src = srcdata, *dst = pbBuffer;
-
-                for (y=0; y < prc->Height; y++)
-                {
-                    float *srcpixel = (float*)src;
-                    BYTE *dstpixel = dst;
-
-                    for (x=0; x < prc->Width; x++)
-                        *dstpixel++ = (BYTE)floorf(to_sRGB_component(*srcpixel++) * 255.0f + 0.51f);
-
-                    src += srcstride;
-                    dst += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-        }
-
-        return hr;
+        return S_OK;
     }
 
     if (!prc)
         return copypixels_to_24bppBGR(This, NULL, cbStride, cbBufferSize, pbBuffer, source_format);
 
+    /* go through 24bppBGR one band of rows at a time */
     srcstride = 3 * prc->Width;
-    srcdatasize = srcstride * prc->Height;
+    band_height = srcstride ? max(1, CONVERT_BAND_SIZE / srcstride) : 1;
+    band_height = min(band_height, prc->Height);
 
-    srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
+    srcdata = HeapAlloc(GetProcessHeap(), 0, srcstride * band_height);
     if (!srcdata) return E_OUTOFMEMORY;
 
-    hr = copypixels_to_24bppBGR(This, prc, srcstride, srcdatasize, srcdata, source_format);
-    if (SUCCEEDED(hr))
+    rc.X = prc->X;
+    rc.Width = prc->Width;
+    for (y = 0; y < prc->Height; y += rc.Height)
     {
-        INT x, y;
-        BYTE *src = srcdata, *dst = pbBuffer;
+        rc.Y = prc->Y + y;
+        rc.Height = min(band_height, prc->Height - y);
 
-        for (y = 0; y < prc->Height; y++)
+        hr = copypixels_to_24bppBGR(This, &rc, srcstride, srcstride * rc.Height, srcdata, source_format);
+        if (FAILED(hr)) break;
+
+        for (i = 0; i < rc.Height; i++)
         {
-            BYTE *bgr = src;
+            const BYTE *bgr = srcdata + srcstride * i;
+            BYTE *dst = pbBuffer + cbStride * (y + i);
+            INT x;
 
-            for (x = 0; x < prc->Width; x++)
+            for (x = 0; x < prc->Width; x++, bgr += 3)
             {
                 float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
-
-                gray = to_sRGB_component(gray) * 255.0f;
-                dst[x] = (BYTE)floorf(gray + 0.51f);
-                bgr += 3;
+                dst[x] = linear_to_srgb_byte(gray);
             }
-            src += srcstride;
-            dst += cbStride;
         }
     }
 
@@ -1493,6 +1335,47 @@ static HRESULT copypixels_to_8bppIndexed(struct FormatConverter *This, const WIC
     return hr;
 }
 
+static HRESULT copypixels_to_128bppRGBAFloat(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
+{
+    HRESULT hr;
+
+    switch (source_format)
+    {
+    case format_128bppRGBAFloat:
+        if (prc)
+            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        return S_OK;
+    default:
+        if (prc && cbStride < 16 * prc->Width) return E_INVALIDARG;
+
+        hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
+        if (SUCCEEDED(hr) && prc)
+        {
+            INT x, y;
+
+            /* expand in place, starting from the end of each row */
+            for (y = 0; y < prc->Height; y++)
+            {
+                BYTE *row = pbBuffer + cbStride * y;
+                float *dst = (float *)row;
+
+                for (x = prc->Width; x--;)
+                {
+                    const BYTE *bgra = row + 4 * x;
+                    BYTE b = bgra[0], g = bgra[1], r = bgra[2], a = bgra[3];
+
+                    dst[4 * x] = srgb_to_linear_table[r];
+                    dst[4 * x + 1] = srgb_to_linear_table[g];
+                    dst[4 * x + 2] = srgb_to_linear_table[b];
+                    dst[4 * x + 3] = a / 255.0f;
+                }
+            }
+        }
+        return hr;
+    }
+}
+
 static const struct pixelformatinfo supported_formats[] = {
     {format_1bppIndexed, &GUID_WICPixelFormat1bppIndexed, NULL, TRUE},
     {format_2bppIndexed, &GUID_WICPixelFormat2bppIndexed, NULL, TRUE},
@@ -1518,6 +1401,7 @@ static const struct pixelformatinfo supported_formats[] = {
     {format_48bppRGB, &GUID_WICPixelFormat48bppRGB, NULL},
     {format_64bppRGBA, &GUID_WICPixelFormat64bppRGBA, NULL},
     {format_32bppCMYK, &GUID_WICPixelFormat32bppCMYK, NULL},
+    {format_128bppRGBAFloat, &GUID_WICPixelFormat128bppRGBAFloat, copypixels_to_128bppRGBAFloat},
     {0}
 };
 
@@ -1837,6 +1721,8 @@ HRESULT FormatConverter_CreateInstance(REFIID iid, void** ppv)
 
     *ppv = NULL;
 
+    InitOnceExecuteOnce(&init_tables_once, init_tables, NULL, NULL);
+
     This = HeapAlloc(GetProcessHeap(), 0, sizeof(FormatConverter));
     if (!This) return E_OUTOFMEMORY;
 
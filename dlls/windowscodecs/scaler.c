@@ -18,6 +18,7 @@
  */
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -31,6 +32,15 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Separable resampling filter along one axis: destination pixel i is the
+ * weighted sum of source pixels start[i] .. start[i] + taps - 1. */
+struct scaler_filter
+{
+    UINT taps;
+    UINT *start;
+    float *weights;
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,6 +52,7 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct scaler_filter filter_x, filter_y;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -55,6 +66,15 @@ static inline BitmapScaler *impl_from_IMILBitmapScaler(IMILBitmapScaler *iface)
     return CONTAINING_RECORD(iface, BitmapScaler, IMILBitmapScaler_iface);
 }
 
+static void free_filter(struct scaler_filter *filter)
+{
+    HeapFree(GetProcessHeap(), 0, filter->start);
+    HeapFree(GetProcessHeap(), 0, filter->weights);
+    filter->start = NULL;
+    filter->weights = NULL;
+    filter->taps = 0;
+}
+
 static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFIID iid,
     void **ppv)
 {
@@ -106,6 +126,8 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_filter(&This->filter_x);
+        free_filter(&This->filter_y);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -203,6 +225,238 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static double linear_kernel(double x)
+{
+    x = fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+/* Keys cubic convolution with a = -0.5 (Catmull-Rom) */
+static double cubic_kernel(double x)
+{
+    x = fabs(x);
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+/* Fraction of source pixel j covered by the destination pixel spanning
+ * [left, right) in source coordinates. */
+static double box_coverage(UINT j, double left, double right)
+{
+    double w = min(j + 1.0, right) - max((double)j, left);
+    return w > 0.0 ? w : 0.0;
+}
+
+static HRESULT init_filter(struct scaler_filter *filter, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    double scale = (double)dst_size / src_size, filter_scale = 1.0, support, center, sum;
+    double (*kernel)(double) = linear_kernel;
+    BOOL box = FALSE;
+    UINT i, j, first, last, start;
+    float *weights;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        support = 1.0;
+        break;
+    case WICBitmapInterpolationModeCubic:
+        kernel = cubic_kernel;
+        support = 2.0;
+        break;
+    case WICBitmapInterpolationModeFant:
+        /* area averaging when shrinking, linear interpolation otherwise */
+        if (scale < 1.0) box = TRUE;
+        support = box ? 0.5 / scale : 1.0;
+        break;
+    case WICBitmapInterpolationModeHighQualityCubic:
+        kernel = cubic_kernel;
+        if (scale < 1.0) filter_scale = 1.0 / scale;
+        support = 2.0 * filter_scale;
+        break;
+    default:
+        return E_INVALIDARG;
+    }
+
+    filter->taps = min((UINT)ceil(2.0 * support) + 1, src_size);
+    filter->start = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(*filter->start));
+    filter->weights = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY,
+        dst_size * filter->taps * sizeof(*filter->weights));
+    if (!filter->start || !filter->weights)
+    {
+        free_filter(filter);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        /* align pixel centers, source pixel j covers [j, j + 1) */
+        center = (i + 0.5) / scale;
+        if (box)
+        {
+            first = max(floor(i / scale), 0.0);
+            last = min(ceil((i + 1) / scale) - 1.0, src_size - 1.0);
+        }
+        else
+        {
+            first = max(floor(center - support - 0.5) + 1.0, 0.0);
+            last = min(ceil(center + support - 0.5) - 1.0, src_size - 1.0);
+        }
+        last = min(last, first + filter->taps - 1);
+        start = min(first, src_size - filter->taps);
+
+        filter->start[i] = start;
+        weights = filter->weights + i * filter->taps;
+
+        sum = 0.0;
+        for (j = first; j <= last; j++)
+        {
+            double w;
+
+            if (box) w = box_coverage(j, i / scale, (i + 1) / scale);
+            else w = kernel((j + 0.5 - center) / filter_scale);
+            weights[j - start] = w;
+            sum += w;
+        }
+
+        if (sum == 0.0)
+        {
+            j = min((UINT)center, src_size - 1);
+            weights[j - start] = 1.0f;
+        }
+        else
+        {
+            for (j = first; j <= last; j++)
+                weights[j - start] /= sum;
+        }
+    }
+
+    return S_OK;
+}
+
+static inline BYTE clamp_component(float value)
+{
+    if (!(value > 0.0f)) return 0;
+    if (value >= 255.0f) return 255;
+    return value + 0.5f;
+}
+
+/* upper bound for the source and intermediate rows held at once */
+#define FILTER_BAND_SIZE 0x100000
+
+/* Resamples the destination rectangle in bands of rows. Each source row is
+ * fetched and filtered horizontally once, rows shared with the previous band
+ * are kept, and the vertical pass then combines whole intermediate rows, so
+ * both passes run over contiguous data. */
+static HRESULT Filter_CopyPixels(BitmapScaler *This, const WICRect *dst_rect,
+    UINT cbStride, BYTE *pbBuffer)
+{
+    const struct scaler_filter *fx = &This->filter_x, *fy = &This->filter_y;
+    UINT channels = This->bpp / 8, row_size = dst_rect->Width * channels;
+    UINT src_bytesperrow, max_rows, held_first = 0, held_count = 0, keep, x, c, t, k;
+    INT y, band_end, i;
+    WICRect src_rect;
+    BYTE *src_bits;
+    float *rows, *out;
+    HRESULT hr = S_OK;
+
+    if (!dst_rect->Width || !dst_rect->Height) return S_OK;
+
+    src_rect.X = fx->start[dst_rect->X];
+    src_rect.Width = fx->start[dst_rect->X + dst_rect->Width - 1] + fx->taps - src_rect.X;
+    src_bytesperrow = src_rect.Width * channels;
+
+    /* a band always holds at least the rows needed by one destination row */
+    max_rows = FILTER_BAND_SIZE / (src_bytesperrow + row_size * sizeof(float));
+    max_rows = min(max(max_rows, fy->taps), This->src_height);
+
+    src_bits = HeapAlloc(GetProcessHeap(), 0, src_bytesperrow * max_rows);
+    rows = HeapAlloc(GetProcessHeap(), 0, row_size * max_rows * sizeof(float));
+    out = HeapAlloc(GetProcessHeap(), 0, row_size * sizeof(float));
+    if (!src_bits || !rows || !out)
+    {
+        hr = E_OUTOFMEMORY;
+        goto done;
+    }
+
+    for (y = 0; y < dst_rect->Height; y = band_end)
+    {
+        UINT first_row = fy->start[dst_rect->Y + y], last_row;
+
+        /* grow the band while its source rows fit in the buffers */
+        band_end = y + 1;
+        while (band_end < dst_rect->Height &&
+               fy->start[dst_rect->Y + band_end] + fy->taps - first_row <= max_rows)
+            band_end++;
+        last_row = fy->start[dst_rect->Y + band_end - 1] + fy->taps;
+
+        /* filter starts only move forward, so shared rows are at the end of the previous band */
+        keep = 0;
+        if (first_row < held_first + held_count)
+        {
+            keep = held_first + held_count - first_row;
+            memmove(rows, rows + row_size * (first_row - held_first), row_size * keep * sizeof(float));
+        }
+        held_first = first_row;
+        held_count = last_row - first_row;
+
+        src_rect.Y = first_row + keep;
+        src_rect.Height = last_row - src_rect.Y;
+        if (src_rect.Height)
+        {
+            hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
+                src_bytesperrow * src_rect.Height, src_bits);
+            if (FAILED(hr)) break;
+        }
+
+        /* horizontal pass */
+        for (i = 0; i < src_rect.Height; i++)
+        {
+            const BYTE *src_row = src_bits + src_bytesperrow * i;
+            float *row = rows + row_size * (keep + i);
+
+            for (x = 0; x < dst_rect->Width; x++)
+            {
+                const float *weights = fx->weights + (dst_rect->X + x) * fx->taps;
+                const BYTE *src = src_row + (fx->start[dst_rect->X + x] - src_rect.X) * channels;
+                float *dst = row + x * channels;
+
+                for (c = 0; c < channels; c++) dst[c] = 0.0f;
+                for (t = 0; t < fx->taps; t++, src += channels)
+                    for (c = 0; c < channels; c++)
+                        dst[c] += weights[t] * src[c];
+            }
+        }
+
+        /* vertical pass */
+        for (i = y; i < band_end; i++)
+        {
+            const float *weights = fy->weights + (dst_rect->Y + i) * fy->taps;
+            const float *row = rows + row_size * (fy->start[dst_rect->Y + i] - first_row);
+            BYTE *dst = pbBuffer + cbStride * i;
+
+            for (k = 0; k < row_size; k++) out[k] = 0.0f;
+            for (t = 0; t < fy->taps; t++, row += row_size)
+            {
+                float w = weights[t];
+                if (w == 0.0f) continue;
+                for (k = 0; k < row_size; k++)
+                    out[k] += w * row[k];
+            }
+            for (k = 0; k < row_size; k++)
+                dst[k] = clamp_component(out[k]);
+        }
+    }
+
+done:
+    HeapFree(GetProcessHeap(), 0, src_bits);
+    HeapFree(GetProcessHeap(), 0, rows);
+    HeapFree(GetProcessHeap(), 0, out);
+    return hr;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -257,6 +511,12 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (This->filter_x.weights)
+    {
+        hr = Filter_CopyPixels(This, &dest_rect, cbStride, pbBuffer);
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -312,6 +572,29 @@ end:
     return hr;
 }
 
+/* formats made of 8-bit channels that can be interpolated independently */
+static BOOL is_filterable_format(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID *formats[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPRGBA,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+        if (IsEqualGUID(format, formats[i])) return TRUE;
+
+    return FALSE;
+}
+
 static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     IWICBitmapSource *pISource, UINT uiWidth, UINT uiHeight,
     WICBitmapInterpolationMode mode)
@@ -335,7 +618,6 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
 
     This->width = uiWidth;
     This->height = uiHeight;
-    This->mode = mode;
 
     hr = IWICBitmapSource_GetSize(pISource, &This->src_width, &This->src_height);
 
@@ -351,24 +633,54 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+        case WICBitmapInterpolationModeHighQualityCubic:
+            /* sub-byte formats are converted to 32bppBGRA below */
+            if ((This->bpp % 8) == 0 && !is_filterable_format(&src_pixelformat))
+            {
+                FIXME("mode %i is not supported for format %s\n", mode, debugstr_guid(&src_pixelformat));
+                mode = WICBitmapInterpolationModeNearestNeighbor;
+            }
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
-            if ((This->bpp % 8) == 0)
-            {
-                IWICBitmapSource_AddRef(pISource);
-                This->source = pISource;
-            }
-            else
+            mode = WICBitmapInterpolationModeNearestNeighbor;
+            break;
+        }
+        This->mode = mode;
+
+        if ((This->bpp % 8) == 0)
+        {
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+        }
+        else
+        {
+            hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                pISource, &This->source);
+            This->bpp = 32;
+        }
+
+        if (SUCCEEDED(hr) && mode != WICBitmapInterpolationModeNearestNeighbor)
+        {
+            hr = init_filter(&This->filter_x, This->src_width, This->width, mode);
+            if (SUCCEEDED(hr))
+                hr = init_filter(&This->filter_y, This->src_height, This->height, mode);
+            if (FAILED(hr))
             {
-                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
-                    pISource, &This->source);
-                This->bpp = 32;
+                free_filter(&This->filter_x);
+                IWICBitmapSource_Release(This->source);
+                This->source = NULL;
             }
+        }
+        else
+        {
             This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
             This->fn_copy_scanline = NearestNeighbor_CopyScanline;
-            break;
         }
     }
 
@@ -527,6 +839,8 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -19,6 +19,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 
@@ -1315,6 +1316,230 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static void test_bitmap_scaler_modes(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+        WICBitmapInterpolationModeHighQualityCubic,
+    };
+    static const struct
+    {
+        UINT width, height;
+    }
+    sizes[] = {{5, 3}, {13, 11}, {1, 1}, {40, 2}};
+    DWORD src_bits[8 * 6], dst_bits[40 * 11], row_bits[40];
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    UINT i, j, x, y;
+    WICRect rc;
+    HRESULT hr;
+
+    for (i = 0; i < ARRAY_SIZE(src_bits); i++)
+        src_bits[i] = 0x80ff4000;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 8, 6, &GUID_WICPixelFormat32bppBGRA,
+        8 * 4, sizeof(src_bits), (BYTE *)src_bits, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        for (j = 0; j < ARRAY_SIZE(sizes); j++)
+        {
+            UINT width = sizes[j].width, height = sizes[j].height;
+
+            winetest_push_context("mode %u, %ux%u", modes[i], width, height);
+
+            hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+            ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+            hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, width, height, modes[i]);
+            ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+            /* resampling a solid color must not change it */
+            memset(dst_bits, 0xcc, sizeof(dst_bits));
+            hr = IWICBitmapScaler_CopyPixels(scaler, NULL, width * 4, width * height * 4, (BYTE *)dst_bits);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+            for (y = 0; y < height; y++)
+                for (x = 0; x < width; x++)
+                    ok(dst_bits[y * width + x] == 0x80ff4000, "Unexpected pixel %#lx at %u,%u.\n",
+                       dst_bits[y * width + x], x, y);
+
+            /* copying a single scanline gives the same result as copying everything */
+            for (y = 0; y < height; y++)
+            {
+                rc.X = 0;
+                rc.Y = y;
+                rc.Width = width;
+                rc.Height = 1;
+                hr = IWICBitmapScaler_CopyPixels(scaler, &rc, width * 4, width * 4, (BYTE *)row_bits);
+                ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+                ok(!memcmp(row_bits, dst_bits + y * width, width * 4), "Unexpected scanline %u.\n", y);
+            }
+
+            IWICBitmapScaler_Release(scaler);
+
+            winetest_pop_context();
+        }
+    }
+
+    IWICBitmap_Release(bitmap);
+}
+
+static void test_bitmap_scaler_gradient(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+        WICBitmapInterpolationModeHighQualityCubic,
+    };
+    static const struct
+    {
+        UINT width, height;
+    }
+    sizes[] = {{7, 3}, {32, 9}, {16, 6}};
+    DWORD src_bits[16 * 6], dst_bits[32 * 9], *big_src, *big_dst, *big_row;
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    UINT i, j, x, y;
+    BOOL monotonic;
+    WICRect rc;
+    HRESULT hr;
+
+    /* blue grows from left to right, green from top to bottom */
+    for (y = 0; y < 6; y++)
+        for (x = 0; x < 16; x++)
+            src_bits[y * 16 + x] = 0xff400000 | ((y * 51) << 8) | (x * 17);
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 16, 6, &GUID_WICPixelFormat32bppBGRA,
+        16 * 4, sizeof(src_bits), (BYTE *)src_bits, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        /* cubic kernels may overshoot next to the clamped edges */
+        monotonic = modes[i] != WICBitmapInterpolationModeCubic
+                && modes[i] != WICBitmapInterpolationModeHighQualityCubic;
+
+        for (j = 0; j < ARRAY_SIZE(sizes); j++)
+        {
+            UINT width = sizes[j].width, height = sizes[j].height;
+
+            winetest_push_context("mode %u, %ux%u", modes[i], width, height);
+
+            hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+            ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+            hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, width, height, modes[i]);
+            ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+            memset(dst_bits, 0xcc, sizeof(dst_bits));
+            hr = IWICBitmapScaler_CopyPixels(scaler, NULL, width * 4, width * height * 4, (BYTE *)dst_bits);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+            for (y = 0; y < height; y++)
+            {
+                for (x = 0; x < width; x++)
+                {
+                    DWORD pixel = dst_bits[y * width + x];
+
+                    ok((pixel & 0xffff0000) == 0xff400000, "Unexpected pixel %#lx at %u,%u.\n", pixel, x, y);
+                    /* every column of the source has the same blue value */
+                    ok(abs((int)(pixel & 0xff) - (int)(dst_bits[x] & 0xff)) <= 1,
+                       "Unexpected pixel %#lx at %u,%u.\n", pixel, x, y);
+                    if (monotonic && x)
+                        ok((pixel & 0xff) >= (dst_bits[y * width + x - 1] & 0xff),
+                           "Unexpected pixel %#lx at %u,%u.\n", pixel, x, y);
+                    if (monotonic && y)
+                        ok((pixel & 0xff00) >= (dst_bits[(y - 1) * width + x] & 0xff00),
+                           "Unexpected pixel %#lx at %u,%u.\n", pixel, x, y);
+                }
+            }
+
+            if (width == 16)
+            {
+                /* no horizontal scaling leaves the columns untouched */
+                for (x = 0; x < width; x++)
+                    ok((dst_bits[x] & 0xff) == x * 17, "Unexpected pixel %#lx at %u,0.\n", dst_bits[x], x);
+            }
+            else if (monotonic)
+            {
+                ok((dst_bits[0] & 0xff) < 0x20, "Unexpected pixel %#lx.\n", dst_bits[0]);
+                ok((dst_bits[width - 1] & 0xff) > 0xe0, "Unexpected pixel %#lx.\n", dst_bits[width - 1]);
+            }
+
+            IWICBitmapScaler_Release(scaler);
+
+            winetest_pop_context();
+        }
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* an image large enough to be resampled in several bands */
+    big_src = malloc(512 * 64 * 4);
+    big_dst = malloc(2048 * 128 * 4);
+    big_row = malloc(2048 * 4);
+    for (y = 0; y < 64; y++)
+        for (x = 0; x < 512; x++)
+            big_src[y * 512 + x] = 0xff000000 | ((y * 4) << 16) | ((x / 2) << 8) | ((x + y) & 0xff);
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 512, 64, &GUID_WICPixelFormat32bppBGRA,
+        512 * 4, 512 * 64 * 4, (BYTE *)big_src, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        winetest_push_context("mode %u", modes[i]);
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2048, 128, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 2048 * 4, 2048 * 128 * 4, (BYTE *)big_dst);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+        /* rows shared between bands give the same result as rows fetched on their own */
+        for (y = 0; y < 128; y++)
+        {
+            rc.X = 0;
+            rc.Y = y;
+            rc.Width = 2048;
+            rc.Height = 1;
+            hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 2048 * 4, 2048 * 4, (BYTE *)big_row);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+            ok(!memcmp(big_row, big_dst + y * 2048, 2048 * 4), "Unexpected scanline %u.\n", y);
+        }
+
+        /* an empty rectangle copies nothing */
+        rc.X = 5;
+        rc.Y = 7;
+        rc.Width = 0;
+        rc.Height = 1;
+        memset(big_row, 0xcc, 4);
+        hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 4, 4, (BYTE *)big_row);
+        ok(hr == S_OK || broken(hr == E_INVALIDARG), "Unexpected hr %#lx.\n", hr);
+        ok(big_row[0] == 0xcccccccc, "Unexpected pixel %#lx.\n", big_row[0]);
+
+        IWICBitmapScaler_Release(scaler);
+
+        winetest_pop_context();
+    }
+
+    IWICBitmap_Release(bitmap);
+    free(big_row);
+    free(big_dst);
+    free(big_src);
+}
+
 static LONG obj_refcount(void *obj)
 {
     IUnknown_AddRef((IUnknown *)obj);
@@ -1485,6 +1710,8 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_modes();
+    test_bitmap_scaler_gradient();
 
     IWICImagingFactory_Release(factory);
 
@@ -248,7 +248,8 @@ static BOOL compare_bits(const struct bitmap_data *expect, UINT buffersize, cons
                 break;
             }
     }
-    else if (IsEqualGUID(expect->format, &GUID_WICPixelFormat32bppGrayFloat))
+    else if (IsEqualGUID(expect->format, &GUID_WICPixelFormat32bppGrayFloat) ||
+             IsEqualGUID(expect->format, &GUID_WICPixelFormat128bppRGBAFloat))
     {
         UINT i;
         const float *a=(const float*)expect->bits, *b=(const float*)converted_bits;
@@ -602,6 +603,18 @@ static const BYTE bits_24bppBGR_gray[] = {
 static const struct bitmap_data testdata_24bppBGR_gray = {
     &GUID_WICPixelFormat24bppBGR, 24, bits_24bppBGR_gray, 32, 2, 96.0, 96.0};
 
+static const BYTE bits_32bppBGRA_srgb[] = {
+    0,0,255,255, 0,255,0,255, 255,0,0,255, 128,128,128,255,
+    0,0,0,255, 255,255,255,255, 128,128,128,255, 0,0,0,255};
+static const struct bitmap_data testdata_32bppBGRA_srgb = {
+    &GUID_WICPixelFormat32bppBGRA, 32, bits_32bppBGRA_srgb, 4, 2, 96.0, 96.0};
+
+static const float bits_128bppRGBAFloat[] = {
+    1.0f,0.0f,0.0f,1.0f, 0.0f,1.0f,0.0f,1.0f, 0.0f,0.0f,1.0f,1.0f, 0.215861f,0.215861f,0.215861f,1.0f,
+    0.0f,0.0f,0.0f,1.0f, 1.0f,1.0f,1.0f,1.0f, 0.215861f,0.215861f,0.215861f,1.0f, 0.0f,0.0f,0.0f,1.0f};
+static const struct bitmap_data testdata_128bppRGBAFloat = {
+    &GUID_WICPixelFormat128bppRGBAFloat, 128, (const BYTE *)bits_128bppRGBAFloat, 4, 2, 96.0, 96.0};
+
 static void test_conversion(const struct bitmap_data *src, const struct bitmap_data *dst, const char *name, BOOL todo)
 {
     BitmapTestSrc *src_obj;
@@ -2055,6 +2068,9 @@ START_TEST(converter)
     test_conversion(&testdata_32bppGrayFloat, &testdata_24bppBGR_gray, "32bppGrayFloat -> 24bppBGR gray", FALSE);
     test_conversion(&testdata_32bppGrayFloat, &testdata_8bppGray, "32bppGrayFloat -> 8bppGray", FALSE);
 
+    test_conversion(&testdata_128bppRGBAFloat, &testdata_32bppBGRA_srgb, "128bppRGBAFloat -> 32bppBGRA", FALSE);
+    test_conversion(&testdata_32bppBGRA_srgb, &testdata_128bppRGBAFloat, "32bppBGRA -> 128bppRGBAFloat", FALSE);
+
     test_invalid_conversion();
     test_default_converter();
     test_converter_4bppGray();